@@ -0,0 +1,197 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "application/cliarg.h"
+#include "application/common.h"
+#include "check.h"
+#include "middleware/m3u.h"
+#include "middleware/uri-probe.h"
+#include "middleware/util.h"
+#include "project.h"
+
+#include <omw/cli.h>
+#include <omw/string.h>
+
+
+using std::cout;
+using std::endl;
+
+namespace {
+
+// a URI referenced by the master playlist
+class Reference
+{
+public:
+    Reference(const std::string& kind_, const std::string& name_, const std::string& uri_)
+        : kind(kind_), name(name_), uri(uri_)
+    {}
+
+    virtual ~Reference() {}
+
+    std::string kind;
+    std::string name;
+    std::string uri;
+};
+
+std::string paramValue(const m3u::Entry& entry, const std::string& key)
+{
+    return (entry.extParam().contains(key) ? entry.extParam().get(key).value().data() : std::string());
+}
+
+std::string joinNonEmpty(const std::string& a, const std::string& b)
+{
+    if (a.empty()) return b;
+    if (b.empty()) return a;
+    return a + ' ' + b;
+}
+
+std::vector<::Reference> references(const m3u::HLS& hls, const util::Uri& m3uFileUri)
+{
+    std::vector<::Reference> r;
+    r.reserve(hls.streams().size() + hls.audioStreams().size() + hls.subtitles().size());
+
+    const auto resolve = [&m3uFileUri](const std::string& uri) { return app::resolveLocal(app::handleUrl(uri, m3uFileUri), m3uFileUri); };
+
+    for (const auto& stream : hls.streams())
+    {
+        const std::string name = ::joinNonEmpty(::paramValue(stream, "RESOLUTION"), ::paramValue(stream, "BANDWIDTH"));
+        r.emplace_back("video", name, resolve(stream.data()));
+    }
+
+    // renditions without URI are contained in the variant streams
+    for (const auto& astream : hls.audioStreams())
+    {
+        if (astream.uri().empty()) continue;
+
+        const std::string name = ::joinNonEmpty(::paramValue(astream, "GROUP-ID"), ::paramValue(astream, "LANGUAGE"));
+        r.emplace_back("audio", name, resolve(astream.uri()));
+    }
+
+    for (const auto& st : hls.subtitles())
+    {
+        if (st.uri().empty()) continue;
+
+        r.emplace_back("subtitles", st.language() + (st.forced() ? " forced" : ""), resolve(st.uri()));
+    }
+
+    return r;
+}
+
+std::string msStr(double seconds)
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(seconds < 0.01 ? 1 : 0) << (seconds * 1000.0) << " ms";
+    return oss.str();
+}
+
+// p in [0, 100], `values` has to be sorted
+double percentile(const std::vector<double>& values, double p)
+{
+    if (values.empty()) return 0;
+    const size_t idx = (size_t)((p / 100.0) * (double)(values.size() - 1) + 0.5);
+    return values[std::min(idx, values.size() - 1)];
+}
+
+} // namespace
+
+
+
+int app::check(const app::Args& args, const app::Flags& flags)
+{
+    IMPLEMENT_FLAGS();
+
+    MessageCounter msgCnt = 0;
+
+    const std::string m3uFileArg = args.raw.at(1);
+    const std::string jobsArg = args.optionValue(argstr::jobs, "32");
+    const bool getArg = args.contains(argstr::get);
+
+    if (!omw::isUInteger(jobsArg) || (jobsArg.length() > 4) || (std::stoi(jobsArg) < 1)) PRINT_ERROR_EXIT("invalid --jobs value", EC_ERROR);
+    const size_t jobs = std::stoul(jobsArg);
+
+    const util::Uri m3uFileUri = util::Uri(m3uFileArg);
+    const m3u::HLS hls = app::getFromUri(msgCnt, flags, m3uFileUri);
+
+    const std::vector<::Reference> refs = ::references(hls, m3uFileUri);
+
+    if (refs.empty()) PRINT_ERROR_EXIT("no variant streams or renditions found", EC_STREAM_EMPTY);
+
+    std::vector<std::string> uris;
+    uris.reserve(refs.size());
+    for (const auto& ref : refs) uris.push_back(ref.uri);
+
+
+    ///////////////////////////////////////////////////////////
+    // probe
+    ///////////////////////////////////////////////////////////
+
+    util::UriProbe probe(app::curl(), jobs);
+    if (getArg) probe.setMethod(util::UriProbe::Method::rangedGet);
+
+    const auto tStart = std::chrono::steady_clock::now();
+    const std::vector<util::UriProbe::Result> results = probe.probe(uris);
+    const double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+
+
+    ///////////////////////////////////////////////////////////
+    // report
+    ///////////////////////////////////////////////////////////
+
+    size_t failed = 0;
+    std::vector<double> latencies;
+    latencies.reserve(results.size());
+
+    for (size_t i = 0; i < refs.size(); ++i)
+    {
+        const auto& ref = refs[i];
+        const auto& res = results[i];
+
+        if (!res.good()) ++failed;
+        else if (res.method != util::UriProbe::Method::none) latencies.push_back(res.latency);
+
+        if (quiet) continue;
+
+        // status, latency, kind and name, URI
+        if (res.good()) cout << omw::fgBrightGreen;
+        else cout << omw::fgBrightRed;
+
+        if (res.method == util::UriProbe::Method::none) cout << std::left << std::setw(5) << (res.good() ? "ok" : "miss");
+        else cout << std::left << std::setw(5) << (res.httpCode > 0 ? std::to_string(res.httpCode) : std::string("err"));
+
+        cout << omw::fgDefault;
+        cout << std::right << std::setw(10) << (res.method == util::UriProbe::Method::none ? std::string() : ::msStr(res.latency));
+        cout << "  " << std::left << std::setw(24) << (ref.kind + ' ' + ref.name);
+        cout << omw::fgBrightWhite << ref.uri << omw::fgDefault << endl;
+
+        if (!res.good() && verbose) cout << "     " << std::setw(10) << "" << "  " << res.error << endl;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    if (!latencies.empty())
+    {
+        PRINT_INFO_V("latency median " + ::msStr(::percentile(latencies, 50)) + ", p95 " + ::msStr(::percentile(latencies, 95)) + ", max " +
+                     ::msStr(latencies.back()));
+    }
+
+    std::ostringstream summary;
+    summary << refs.size() << " URIs checked in " << std::fixed << std::setprecision(2) << duration << " s, " << failed << " failed";
+
+    if (failed > 0) PRINT_ERROR(summary.str())
+    else PRINT_INFO(summary.str());
+
+    return (failed > 0 ? EC_ERROR : EC_OK);
+}
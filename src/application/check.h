@@ -0,0 +1,24 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_APP_CHECK_H
+#define IG_APP_CHECK_H
+
+#include <string>
+#include <vector>
+
+#include "application/cliarg.h"
+#include "application/common.h"
+
+
+namespace app {
+
+int check(const app::Args& args, const app::Flags& flags);
+
+}
+
+
+#endif // IG_APP_CHECK_H
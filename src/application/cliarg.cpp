@@ -68,8 +68,29 @@ void app::OptionList::addOpt(const std::string& opt)
 
 bool app::OptionList::checkOpt(const std::string& opt) const
 {
-    return ((opt == argstr::force) || (opt == argstr::help) || (opt == argstr::help_alt) || (opt == argstr::noColor) || (opt == argstr::quiet) ||
-            (opt == argstr::verbose) || (opt == argstr::version));
+    static const char* const known[] = {
+        // global
+        argstr::force, argstr::help, argstr::help_alt, argstr::noColor, argstr::quiet, argstr::verbose, argstr::version,
+
+        // HTTP
+        argstr::httpStats, argstr::maxConn, argstr::maxHostConn, argstr::rateLimit, argstr::adaptive, argstr::httpRecord, argstr::httpReplay,
+        argstr::replayLatency, argstr::replayRate, argstr::cache, argstr::cacheSize,
+
+        // modules
+        argstr::archive, argstr::audioGroup, argstr::batch, argstr::batchJobs, argstr::checksum, argstr::ckExists, argstr::codecs, argstr::dedup,
+        argstr::download, argstr::dryRun, argstr::get, argstr::hdr, argstr::ioUring, argstr::jobs, argstr::link, argstr::live,
+        argstr::maxBandwidth, argstr::maxFps, argstr::noSubs, argstr::remove, argstr::report, argstr::saveOriginal, argstr::sync,
+    };
+
+    // `--key=value`
+    const std::string name = opt.substr(0, opt.find('='));
+
+    for (const char* const k : known)
+    {
+        if (name == k) return true;
+    }
+
+    return false;
 }
 
 
@@ -96,7 +117,8 @@ void app::Args::parse(const std::vector<std::string>& args)
 
 void app::Args::add(const std::string& arg)
 {
-    if (arg[0] == '-') m_options.add(arg);
+    // a single dash is a file argument, stdin or stdout
+    if ((arg[0] == '-') && (arg != "-")) m_options.add(arg);
 #ifdef OMW_PLAT_WIN
     else if (arg == "/?") m_options.add(argstr::help);
 #endif
@@ -105,6 +127,18 @@ void app::Args::add(const std::string& arg)
     raw.push_back(arg);
 }
 
+std::string app::Args::optionValue(const std::string& key, const std::string& def) const
+{
+    const std::string prefix = key + '=';
+
+    for (const auto& opt : m_options)
+    {
+        if (opt.compare(0, prefix.length(), prefix) == 0) { return opt.substr(prefix.length()); }
+    }
+
+    return def;
+}
+
 std::vector<std::string> app::Args::inDirs() const
 {
     std::vector<std::string> r;
@@ -149,7 +183,7 @@ bool app::Args::isOption(size_t raw_idx) const
 
     const auto& arg = raw.at(raw_idx);
 
-    if (arg.at(0) == '-') r = true;
+    if ((arg.at(0) == '-') && (arg != "-")) r = true;
 #ifdef OMW_PLAT_WIN
     else if (arg == "/?") r = true;
 #endif
@@ -22,11 +22,47 @@ namespace argstr {
 const char* const force = "-f";
 const char* const help = "-h";
 const char* const help_alt = "--help";
+const char* const httpStats = "--http-stats";
+const char* const maxConn = "--max-conn";
+const char* const maxHostConn = "--max-host-conn";
+const char* const rateLimit = "--rate-limit";
+const char* const adaptive = "--adaptive";
+const char* const httpRecord = "--http-record";
+const char* const httpReplay = "--http-replay";
+const char* const replayLatency = "--replay-latency";
+const char* const replayRate = "--replay-rate";
+const char* const cache = "--cache";
+const char* const cacheSize = "--cache-size";
 const char* const noColor = "--no-color";
 const char* const quiet = "-q";
 const char* const verbose = "-v";
 const char* const version = "--version";
 
+// module options
+const char* const archive = "--archive";
+const char* const audioGroup = "--audio-group";
+const char* const batch = "--batch";
+const char* const batchJobs = "--batch-jobs";
+const char* const checksum = "--checksum";
+const char* const ckExists = "--ck-exists";
+const char* const codecs = "--codecs";
+const char* const dedup = "--dedup";
+const char* const download = "--download";
+const char* const dryRun = "--dry-run";
+const char* const get = "--get";
+const char* const hdr = "--hdr";
+const char* const ioUring = "--io-uring";
+const char* const jobs = "--jobs";
+const char* const link = "--link";
+const char* const live = "--live";
+const char* const maxBandwidth = "--max-bandwidth";
+const char* const maxFps = "--max-fps";
+const char* const noSubs = "--no-subs";
+const char* const remove = "--remove";
+const char* const report = "--report";
+const char* const saveOriginal = "--save-original";
+const char* const sync = "--sync";
+
 } // namespace argstr
 
 namespace app {
@@ -84,9 +120,15 @@ public:
     OptionList& options() { return m_options; }
     const OptionList& options() const { return m_options; }
 
+    // the arguments which are not options (module, files, ...) in order, regardless of options in between
+    const FileList& files() const { return m_files; }
+
     // contains function in library base class
     bool contains(const std::string& option) const { return m_options.contains(option); }
 
+    // value of an option in the form `--key=value`, returns `def` if the option is not present
+    std::string optionValue(const std::string& key, const std::string& def = std::string()) const;
+
     // contains functions in user derived cass
     bool containsForce() const { return m_options.contains(argstr::force); }
     bool containsHelp() const { return (m_options.contains(argstr::help) || m_options.contains(argstr::help_alt)); }
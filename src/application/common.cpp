@@ -7,12 +7,15 @@ copyright       GPL-3.0 - Copyright (c) 2024 Oliver Blaser
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <vector>
 
 #include "common.h"
+#include "middleware/content-cache.h"
 #include "middleware/curl-helper.h"
 #include "middleware/encoding-helper.h"
 #include "middleware/util.h"
@@ -31,6 +34,40 @@ namespace {
 
 constexpr int ewiWidth = 10;
 
+struct ArchiveConfig
+{
+    ArchiveConfig()
+        : mode(util::HttpArchive::MODE_OFF), dir(), latency(-1), bandwidth(0)
+    {}
+
+    int mode;
+    fs::path dir;
+    double latency;
+    uint64_t bandwidth;
+};
+
+struct CacheConfig
+{
+    CacheConfig()
+        : enabled(false), dir(), maxSize(0)
+    {}
+
+    bool enabled;
+    fs::path dir;
+    uint64_t maxSize;
+};
+
+constexpr uint64_t defaultCacheSize = 2ull * 1024 * 1024 * 1024;
+
+util::HttpScheduler::Config g_httpConfig;
+ArchiveConfig g_archiveConfig;
+std::unique_ptr<util::Curl> g_curl;
+std::once_flag g_curlOnce;
+
+CacheConfig g_cacheConfig;
+std::unique_ptr<util::ContentCache> g_cache;
+std::once_flag g_cacheOnce;
+
 /*
 bool isUrl(const std::string& uri)
 {
@@ -207,19 +244,155 @@ void app::checkOutFile(app::MessageCounter& msgCnt, const app::Flags& flags, con
     }
 }
 
-m3u::M3U app::getFromUri(app::MessageCounter& msgCnt, const app::Flags& flags, const util::Uri& uri)
+void app::configureHttp(app::MessageCounter& msgCnt, const app::Flags& flags, const app::Args& args)
+{
+    const bool& quiet = flags.quiet;
+
+    util::HttpScheduler::Config cfg;
+    uint64_t value;
+
+    const std::string maxConnArg = args.optionValue(argstr::maxConn);
+    if (!maxConnArg.empty())
+    {
+        if (!omw::isUInteger(maxConnArg) || !util::parseSize(maxConnArg, value)) PRINT_ERROR_EXIT("###invalid @" + std::string(argstr::maxConn) + "@ value", EC_ERROR);
+        cfg.maxConnections = (size_t)value;
+    }
+
+    const std::string maxHostConnArg = args.optionValue(argstr::maxHostConn);
+    if (!maxHostConnArg.empty())
+    {
+        if (!omw::isUInteger(maxHostConnArg) || !util::parseSize(maxHostConnArg, value))
+        {
+            PRINT_ERROR_EXIT("###invalid @" + std::string(argstr::maxHostConn) + "@ value", EC_ERROR);
+        }
+        cfg.maxHostConnections = (size_t)value;
+    }
+
+    const std::string rateLimitArg = args.optionValue(argstr::rateLimit);
+    if (!rateLimitArg.empty())
+    {
+        if (!util::parseSize(rateLimitArg, value)) PRINT_ERROR_EXIT("###invalid @" + std::string(argstr::rateLimit) + "@ value", EC_ERROR);
+        cfg.bandwidth = value;
+    }
+
+    cfg.adaptive = args.contains(argstr::adaptive);
+
+    g_httpConfig = cfg;
+    if (g_curl) g_curl->scheduler().setConfig(cfg);
+
+
+    ArchiveConfig archiveCfg;
+
+    const std::string recordArg = args.optionValue(argstr::httpRecord);
+    const std::string replayArg = args.optionValue(argstr::httpReplay);
+
+    if (!recordArg.empty() && !replayArg.empty())
+    {
+        PRINT_ERROR_EXIT("###@" + std::string(argstr::httpRecord) + "@ and @" + std::string(argstr::httpReplay) + "@ can't be used together", EC_ERROR);
+    }
+
+    if (!recordArg.empty())
+    {
+        archiveCfg.mode = util::HttpArchive::MODE_RECORD;
+        archiveCfg.dir = enc::path(recordArg);
+    }
+    else if (!replayArg.empty())
+    {
+        archiveCfg.mode = util::HttpArchive::MODE_REPLAY;
+        archiveCfg.dir = enc::path(replayArg);
+
+        if (!fs::is_directory(archiveCfg.dir)) PRINT_ERROR_EXIT("###HTTP archive \"" + replayArg + "\" not found", EC_ERROR);
+
+        const std::string latencyArg = args.optionValue(argstr::replayLatency);
+        if (!latencyArg.empty())
+        {
+            if (!omw::isUInteger(latencyArg) || !util::parseSize(latencyArg, value))
+            {
+                PRINT_ERROR_EXIT("###invalid @" + std::string(argstr::replayLatency) + "@ value", EC_ERROR);
+            }
+            archiveCfg.latency = (double)value / 1000.0;
+        }
+
+        const std::string rateArg = args.optionValue(argstr::replayRate);
+        if (!rateArg.empty())
+        {
+            if (!util::parseSize(rateArg, value)) PRINT_ERROR_EXIT("###invalid @" + std::string(argstr::replayRate) + "@ value", EC_ERROR);
+            archiveCfg.bandwidth = value;
+        }
+    }
+
+    g_archiveConfig = archiveCfg;
+
+
+    CacheConfig cacheCfg;
+
+    const std::string cacheDirArg = args.optionValue(argstr::cache);
+    const std::string cacheSizeArg = args.optionValue(argstr::cacheSize);
+
+    if (args.contains(argstr::cache) || !cacheDirArg.empty() || !cacheSizeArg.empty())
+    {
+        cacheCfg.enabled = true;
+        cacheCfg.dir = (cacheDirArg.empty() ? util::ContentCache::defaultDir() : enc::path(cacheDirArg));
+        cacheCfg.maxSize = ::defaultCacheSize;
+
+        if (!cacheSizeArg.empty())
+        {
+            if (!util::parseSize(cacheSizeArg, value) || (value == 0)) PRINT_ERROR_EXIT("###invalid @" + std::string(argstr::cacheSize) + "@ value", EC_ERROR);
+            cacheCfg.maxSize = value;
+        }
+    }
+
+    g_cacheConfig = cacheCfg;
+}
+
+util::Curl& app::curl()
+{
+    std::call_once(g_curlOnce, []() {
+        g_curl = std::make_unique<util::Curl>();
+        g_curl->scheduler().setConfig(g_httpConfig);
+
+        if (g_archiveConfig.mode == util::HttpArchive::MODE_RECORD) g_curl->archive().setRecord(g_archiveConfig.dir);
+        else if (g_archiveConfig.mode == util::HttpArchive::MODE_REPLAY)
+        {
+            g_curl->archive().setReplay(g_archiveConfig.dir, g_archiveConfig.latency, g_archiveConfig.bandwidth);
+        }
+    });
+
+    return *g_curl;
+}
+
+util::ContentCache* app::cache()
+{
+    if (!g_cacheConfig.enabled) return nullptr;
+
+    std::call_once(g_cacheOnce, []() { g_cache = std::make_unique<util::ContentCache>(g_cacheConfig.dir, g_cacheConfig.maxSize); });
+
+    return g_cache.get();
+}
+
+util::HttpGetResponse app::httpGetPlaylist(const std::string& url)
+{
+    const util::HttpRequest request(url, 60, 60);
+    util::ContentCache* const cache = app::cache();
+
+    if (cache) return cache->fetch(app::curl(), request, util::ContentCache::Validation::conditional, 3);
+    return app::curl().httpGETResume(request, 3);
+}
+
+m3u::M3U app::getFromUri(app::MessageCounter& msgCnt, const app::Flags& flags, const util::Uri& uri) { return app::getStringFromUri(msgCnt, flags, uri); }
+
+std::string app::getStringFromUri(app::MessageCounter& msgCnt, const app::Flags& flags, const util::Uri& uri)
 {
     IMPLEMENT_FLAGS();
 
     if (uri.isUrl())
     {
-        util::Curl curl;
-
-        const auto res = curl.httpGET(uri.string(), 60, 60);
+        const auto res = app::httpGetPlaylist(uri.string());
 
         if (!res.good())
         {
             if (verbose) app::printInfo(res.toString());
+            PRINT_INFO_V(res.timing().toString());
 
             PRINT_ERROR("HTTP GET failed");
             PRINT_INFO_V("###M3U file: \"" + uri.string() + "\"");
@@ -243,6 +416,77 @@ m3u::M3U app::getFromUri(app::MessageCounter& msgCnt, const app::Flags& flags, c
     }
 }
 
+std::string app::handleUrl(const std::string& url, const util::Uri& m3uFileUri)
+{
+    std::string r = url;
+
+    auto streamUri = util::Uri(url);
+
+    if (streamUri.scheme().empty() && streamUri.authority().empty() && // is relative path
+        !m3uFileUri.scheme().empty() && !m3uFileUri.authority().empty())
+    {
+        const fs::path basePath = enc::path(m3uFileUri.path()).parent_path();
+        const std::string path = basePath.u8string() + '/' + streamUri.path();
+
+        streamUri.setScheme(m3uFileUri.scheme());
+        streamUri.setAuthority(m3uFileUri.authority());
+        streamUri.setPath(path);
+
+        r = streamUri.string();
+    }
+
+    return r;
+}
+
+std::string app::resolveLocal(const std::string& uri, const util::Uri& playlistUri)
+{
+    if (playlistUri.isUrl() || util::Uri(uri).isUrl()) return uri;
+
+    const fs::path path = enc::path(uri);
+    if (path.is_absolute()) return uri;
+
+    return (enc::path(playlistUri.path()).parent_path() / path).u8string();
+}
+
+void app::httpReport(app::MessageCounter& msgCnt, const app::Flags& flags, const app::Args& args)
+{
+    IMPLEMENT_FLAGS();
+
+    if (!g_curl || g_curl->stats().empty()) return;
+
+    const auto& stats = g_curl->stats();
+
+    if (verbose)
+    {
+        app::printTitle("HTTP timing:");
+        cout << stats.toString() << std::flush;
+    }
+
+    const std::string jsonFileArg = args.optionValue(argstr::httpStats);
+
+    if (!jsonFileArg.empty())
+    {
+        util::writeFile(enc::path(jsonFileArg), stats.toJson());
+        PRINT_INFO_V("created file \"" + fs::weakly_canonical(enc::path(jsonFileArg)).u8string() + "\"");
+    }
+}
+
+void app::closeCache(app::MessageCounter& msgCnt, const app::Flags& flags)
+{
+    IMPLEMENT_FLAGS();
+
+    if (!g_cache) return;
+
+    g_cache->evict();
+
+    if ((g_cache->hits() + g_cache->misses()) > 0)
+    {
+        PRINT_INFO_V("###cache: " + std::to_string(g_cache->hits()) + " hits (" + std::to_string(g_cache->revalidated()) + " revalidated), " +
+                     std::to_string(g_cache->misses()) + " misses, " + std::to_string(g_cache->bytesServed()) + " bytes served from \"" +
+                     g_cache->dir().u8string() + "\"");
+    }
+}
+
 #if defined(PRJ_DEBUG)
 void app::dbg_rm_outDir(const fs::path& outDir)
 {
@@ -13,6 +13,9 @@ copyright       GPL-3.0 - Copyright (c) 2024 Oliver Blaser
 #include <stdexcept>
 #include <string>
 
+#include "application/cliarg.h"
+#include "middleware/content-cache.h"
+#include "middleware/curl-helper.h"
 #include "middleware/m3u.h"
 #include "middleware/util.h"
 #include "project.h"
@@ -152,8 +155,36 @@ static inline void checkCreateOutDir(app::MessageCounter& msgCnt, const app::Fla
 void checkOutFile(app::MessageCounter& msgCnt, const app::Flags& flags, const std::filesystem::path& outFilePath, const std::string& fileDisplayPath,
                   const std::string& fileDisplayTitle);
 
+// reads the HTTP scheduler options (`--max-conn=N`, `--max-host-conn=N`, `--rate-limit=BYTES`, `--adaptive`) and the archive options
+// (`--http-record=DIR`, `--http-replay=DIR`, `--replay-latency=MS`, `--replay-rate=BYTES`), they are applied to app::curl()
+void configureHttp(app::MessageCounter& msgCnt, const app::Flags& flags, const app::Args& args);
+
+// process wide HTTP client, curl is initialised on first use
+util::Curl& curl();
+
+// process wide response cache configured by `--cache[=DIR]` and `--cache-size=BYTES`, nullptr if it's not enabled
+util::ContentCache* cache();
+
+// GET of a playlist, through the cache if it's enabled (a cached playlist is revalidated)
+util::HttpGetResponse httpGetPlaylist(const std::string& url);
+
 m3u::M3U getFromUri(app::MessageCounter& msgCnt, const app::Flags& flags, const util::Uri& uri);
 
+// same as getFromUri() but returns the unparsed file content
+std::string getStringFromUri(app::MessageCounter& msgCnt, const app::Flags& flags, const util::Uri& uri);
+
+// if `url` is a relative path, the scheme, authority and directory of the playlist URL are prepended
+std::string handleUrl(const std::string& url, const util::Uri& m3uFileUri);
+
+// relative paths in a local playlist are relative to the directory of the playlist, other URIs are returned unchanged
+std::string resolveLocal(const std::string& uri, const util::Uri& playlistUri);
+
+// prints the HTTP timing report (verbose) and writes it as JSON to the file passed by `--http-stats=FILE`, does nothing if no request was made
+void httpReport(app::MessageCounter& msgCnt, const app::Flags& flags, const app::Args& args);
+
+// evicts the least recently used objects of the cache and prints its statistics (verbose), does nothing if the cache wasn't used
+void closeCache(app::MessageCounter& msgCnt, const app::Flags& flags);
+
 #ifdef PRJ_DEBUG
 void dbg_rm_outDir(const std::filesystem::path& outDir);
 #endif // PRJ_DEBUG
@@ -6,21 +6,43 @@ copyright       GPL-3.0 - Copyright (c) 2024 Oliver Blaser
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
 #include <filesystem>
 #include <functional>
+#include <memory>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "application/cliarg.h"
 #include "application/common.h"
 #include "export.h"
 #include "middleware/encoding-helper.h"
+#include "middleware/archive-writer.h"
+#include "middleware/checksum-file.h"
+#include "middleware/content-cache.h"
+#include "middleware/device-info.h"
+#include "middleware/export-manifest.h"
+#include "middleware/file-copy.h"
+#include "middleware/file-metadata.h"
+#include "middleware/hash.h"
+#include "middleware/uring-copy.h"
 #include "middleware/util.h"
+#include "middleware/worker-pool.h"
 #include "project.h"
 
 #include <omw/cli.h>
@@ -29,6 +51,11 @@ copyright       GPL-3.0 - Copyright (c) 2024 Oliver Blaser
 #include <omw/vector.h>
 #include <omw/windows/windows.h>
 
+#ifdef OMW_PLAT_WIN
+#include <fcntl.h>
+#include <io.h>
+#endif // OMW_PLAT_WIN
+
 
 using std::cout;
 using std::endl;
@@ -41,51 +68,630 @@ namespace {
 const std::string magentaDebugStr = "\033[95mDEBUG\033[39m";
 #endif
 
+std::string throughputStr(const util::FileCopier::Result& result)
+{
+    if (result.throughput() <= 0) return "-";
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1) << (result.throughput() / 1.0e6) << " MB/s";
+    return oss.str();
 }
 
+std::string megabytesStr(uint64_t bytes)
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1) << ((double)bytes / 1.0e6) << " MB";
+    return oss.str();
+}
 
+enum class ExportMode
+{
+    copy,
+    link,        // hard link, copy if that fails
+    linkSymlink, // hard link, symbolic link if that fails
+};
 
-int app::exprt(const app::Args& args, const app::Flags& flags)
+// how a file was exported
+enum class Output
 {
-    int r = EC_ERROR;
+    none,
+    copy,
+    hardlink,
+    symlink,
+    unchanged, // by the sync
+    renamed,   // by the sync
+    duplicate, // linked to the output file of the first occurrence
+    archived,
+};
+
+class ExportJob
+{
+public:
+    ExportJob(const fs::path& inFile_, const fs::path& outFile_)
+        : inFile(inFile_), outFile(outFile_), input(), copied(false), output(::Output::none), error(), result(), skip(false), record(), primary(SIZE_MAX),
+          linkMethod(util::ContentCache::LinkMethod::copy), hashed(false), hash(0), done(false), exception()
+    {}
+
+    virtual ~ExportJob() {}
+
+    fs::path inFile;
+    fs::path outFile;
+    util::FileMetadata::Info input; // of the metadata pass
+
+    bool copied;
+    ::Output output;
+    std::string error; // printed if not copied
+    util::FileCopier::Result result;
+
+    bool skip;                           // already exported by the sync
+    util::ExportManifest::Record record; // of the sync, empty source if the input file is not a regular file
+
+    size_t primary; // index of the first occurrence of the same file, SIZE_MAX if none
+    util::ContentCache::LinkMethod linkMethod;
+
+    bool hashed;
+    uint64_t hash; // XXH64 of the output file
+
+    bool done;                    // set by the worker
+    std::exception_ptr exception; // thrown by the worker, ends the export
+};
+
+// jobs of one source device
+class DeviceQueue
+{
+public:
+    class Entry
+    {
+    public:
+        Entry(size_t index_, uint64_t inode_, uint64_t physical_)
+            : index(index_), inode(inode_), physical(physical_)
+        {}
+
+        virtual ~Entry() {}
+
+        size_t index; // in the export jobs
+        uint64_t inode;
+        uint64_t physical;
+    };
+
+public:
+    DeviceQueue(uint64_t device_, util::DeviceType type_)
+        : device(device_), type(type_), jobs()
+    {}
+
+    virtual ~DeviceQueue() {}
+
+    uint64_t device;
+    util::DeviceType type;
+    std::vector<Entry> jobs;
+
+    // `input` is from the metadata pass, the file is only opened for the extent on rotational devices
+    void add(size_t index, const util::FileMetadata::Info& input, const fs::path& file)
+    {
+        const bool extent = ((type == util::DeviceType::rotational) && (input.size > 0));
+        jobs.emplace_back(index, input.inode, (extent ? util::firstExtent(file) : UINT64_MAX));
+    }
+
+    // by physical offset, files without a known extent by inode after them, playlist order if equal
+    void sort()
+    {
+        std::sort(jobs.begin(), jobs.end(), [](const Entry& a, const Entry& b) {
+            if (a.physical != b.physical) return (a.physical < b.physical);
+            if (a.inode != b.inode) return (a.inode < b.inode);
+            return (a.index < b.index);
+        });
+    }
+};
+
+const char* toString(util::DeviceType type)
+{
+    const char* r;
+
+    switch (type)
+    {
+    case util::DeviceType::rotational:
+        r = "rotational";
+        break;
+
+    case util::DeviceType::solidState:
+        r = "solid state";
+        break;
+
+    default:
+        r = "unknown";
+        break;
+    }
+
+    return r;
+}
+
+// the hash of the copied data is compared to the hash of the output file read back from the storage device
+void copy(util::FileCopier& copier, ::ExportJob& job, bool checksum)
+{
+    job.result = copier.copy(job.inFile, job.outFile, checksum);
+
+    if (!job.result.good())
+    {
+        job.error = "###" + job.result.error;
+        return;
+    }
+
+    if (checksum)
+    {
+        uint64_t hash;
+        std::string error;
+
+        if (!util::xxh64File(job.outFile, hash, error, true))
+        {
+            job.error = "###" + error;
+            return;
+        }
+
+        if (hash != job.result.hash)
+        {
+            job.error = "###\"" + job.outFile.u8string() + "\": checksum mismatch after the copy";
+            return;
+        }
+
+        job.hashed = true;
+        job.hash = hash;
+    }
+
+    job.copied = true;
+    job.output = ::Output::copy;
+}
+
+// a link has the content of the input file
+void hashInput(::ExportJob& job)
+{
+    std::string error;
+
+    if (util::xxh64File(job.inFile, job.hash, error)) job.hashed = true;
+    else
+    {
+        job.copied = false;
+        job.error = "###" + error;
+    }
+}
+
+// the fallback is chosen per file, e.g. if the playlist references files on different devices
+void link(util::FileCopier& copier, ::ExportJob& job, ::ExportMode mode, bool checksum)
+{
+    std::error_code ec;
+
+    fs::create_hard_link(job.inFile, job.outFile, ec);
+
+    if (!ec)
+    {
+        job.copied = true;
+        job.output = ::Output::hardlink;
+
+        if (checksum) ::hashInput(job);
+    }
+    else if (mode == ::ExportMode::linkSymlink)
+    {
+        fs::create_symlink(fs::absolute(job.inFile), job.outFile, ec);
+
+        if (!ec)
+        {
+            job.copied = true;
+            job.output = ::Output::symlink;
+
+            if (checksum) ::hashInput(job);
+        }
+        else job.error = "###\"" + job.outFile.u8string() + "\": " + ec.message();
+    }
+    else ::copy(copier, job, checksum);
+}
+
+// checks the input file and exports it, file system errors other than a failed copy or link are thrown
+void exportFile(util::FileCopier& copier, ::ExportJob& job, ::ExportMode mode, bool checksum)
+{
+    if (!job.input.exists()) job.error = "###file \"" + job.inFile.u8string() + "\" not found";
+    else if (!job.input.isRegular()) job.error = "###\"" + job.inFile.u8string() + "\" is not a file";
+    else
+    {
+        if (mode == ::ExportMode::copy) ::copy(copier, job, checksum);
+        else ::link(copier, job, mode, checksum);
+    }
+}
+
+// links the output file of the first occurrence, the file is exported normally if that failed
+void exportDuplicate(util::FileCopier& copier, ::ExportJob& job, const ::ExportJob& primary, ::ExportMode mode, bool checksum)
+{
+    std::error_code ec;
+    std::string error;
+
+    // link() would replace an existing file
+    if (primary.copied && !fs::exists(job.outFile, ec) && util::ContentCache::link(primary.outFile, job.outFile, job.linkMethod, error))
+    {
+        job.copied = true;
+        job.output = ::Output::duplicate;
+        job.result.bytes = fs::file_size(job.outFile, ec);
+        job.hashed = primary.hashed;
+        job.hash = primary.hash;
+    }
+    else ::exportFile(copier, job, mode, checksum);
+}
+
+// adds the file to the archive, a duplicate as a link to the first occurrence if the format supports it, write errors are thrown
+void archiveFile(util::ArchiveWriter& writer, ::ExportJob& job, const ::ExportJob* primary)
+{
+    const std::string name = job.outFile.filename().u8string();
+
+    if (!job.input.exists()) job.error = "###file \"" + job.inFile.u8string() + "\" not found";
+    else if (!job.input.isRegular()) job.error = "###\"" + job.inFile.u8string() + "\" is not a file";
+    else if (primary && primary->copied && writer.addLink(name, primary->outFile.filename().u8string()))
+    {
+        job.copied = true;
+        job.output = ::Output::duplicate;
+        job.linkMethod = util::ContentCache::LinkMethod::hardlink;
+        job.result.bytes = job.input.size;
+    }
+    else
+    {
+        writer.addFile(name, job.inFile);
+
+        job.copied = true;
+        job.output = ::Output::archived;
+        job.result.bytes = job.input.size;
+    }
+}
+
+// data of the input file which is transferred, 0 for skipped jobs, duplicates and missing inputs
+uint64_t planBytes(const ::ExportJob& job) { return ((!job.skip && (job.primary == SIZE_MAX) && job.input.isRegular()) ? job.input.size : 0); }
+
+// what the export will do, determined before anything is copied
+class Plan
+{
+public:
+    Plan()
+        : files(0), bytes(0), unchanged(0), duplicates(0), missing(0)
+    {}
+
+    virtual ~Plan() {}
+
+    size_t files;      // to export
+    uint64_t bytes;    // to transfer, see planBytes()
+    size_t unchanged;  // skipped by the sync
+    size_t duplicates; // linked to their first occurrence
+    size_t missing;    // input doesn't exist or isn't a file
+
+    void add(const ::ExportJob& job)
+    {
+        if (job.skip) ++unchanged;
+        else if (job.primary != SIZE_MAX) ++duplicates;
+        else if (!job.input.isRegular()) ++missing;
+        else
+        {
+            ++files;
+            bytes += ::planBytes(job);
+        }
+    }
+};
+
+// the directory itself if it exists, "." for an empty path
+fs::path existingAncestor(const fs::path& dir)
+{
+    std::error_code ec;
+    fs::path p = fs::absolute(dir.empty() ? fs::path(".") : dir, ec);
+
+    while (!fs::is_directory(p, ec) && p.has_relative_path()) p = p.parent_path();
+
+    return p;
+}
+
+std::string durationStr(double seconds)
+{
+    std::ostringstream oss;
+
+    if (seconds < 60) oss << std::fixed << std::setprecision(1) << seconds << " s";
+    else
+    {
+        const uint64_t s = (uint64_t)(seconds + 0.5);
+
+        if (s < 3600) oss << (s / 60) << " min " << std::setw(2) << std::setfill('0') << (s % 60) << " s";
+        else oss << (s / 3600) << " h " << std::setw(2) << std::setfill('0') << ((s / 60) % 60) << " min";
+    }
+
+    return oss.str();
+}
+
+// Reads the beginning of the input files and returns the read throughput in B/s, 0 if nothing could be read. Nothing is written, so the
+// write speed of OUTDIR is not part of the estimate.
+double sampleThroughput(const std::vector<::ExportJob>& jobs, uint64_t& sampled)
+{
+    constexpr uint64_t maxSample = 32 * 1024 * 1024;
+    constexpr size_t maxFiles = 64;
+
+    size_t nFiles = 0;
+
+    sampled = 0;
+    const auto tStart = std::chrono::steady_clock::now();
+
+    for (const auto& job : jobs)
+    {
+        if ((sampled >= maxSample) || (nFiles >= maxFiles)) break;
+        if (::planBytes(job) == 0) continue;
+
+        sampled += util::readSample(job.inFile, maxSample - sampled);
+        ++nFiles;
+    }
+
+    const double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+
+    return (((sampled > 0) && (duration > 0)) ? ((double)sampled / duration) : 0);
+}
+
+// Status line on stderr (files, bytes, throughput and ETA of the exported data), redrawn twice a second by its own thread. Other output
+// has to be printed while the line is suspended.
+class ProgressLine
+{
+public:
+    explicit ProgressLine(const ::Plan& plan)
+        : m_totalFiles(plan.files + plan.duplicates + plan.missing), m_totalBytes(plan.bytes), m_files(0), m_bytes(0), m_width(0),
+          m_tStart(std::chrono::steady_clock::now()), m_stop(false), m_mtx(), m_cv(), m_thread()
+    {
+        m_thread = std::thread(&ProgressLine::m_run, this);
+    }
+
+    virtual ~ProgressLine()
+    {
+        {
+            std::lock_guard<std::mutex> lg(m_mtx);
+            m_stop = true;
+            m_clear();
+        }
+
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    // a job which is not skipped is done
+    void add(const ::ExportJob& job)
+    {
+        std::lock_guard<std::mutex> lg(m_mtx);
+        ++m_files;
+        m_bytes += ::planBytes(job);
+    }
+
+    // clears the line, it's redrawn with the next update after the lock is released
+    std::unique_lock<std::mutex> suspend()
+    {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_clear();
+        return lock;
+    }
+
+private:
+    size_t m_totalFiles;
+    uint64_t m_totalBytes;
+    size_t m_files;
+    uint64_t m_bytes;
+    size_t m_width; // of the line on the terminal
+    std::chrono::steady_clock::time_point m_tStart;
+    bool m_stop;
+    std::mutex m_mtx;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+
+    void m_run()
+    {
+        std::unique_lock<std::mutex> lock(m_mtx);
+
+        while (!m_cv.wait_for(lock, std::chrono::milliseconds(500), [this]() { return m_stop; }))
+        {
+            const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_tStart).count();
+
+            // short exports don't flash a line
+            if (elapsed < 1.0) continue;
+
+            const double rate = (double)m_bytes / elapsed;
+
+            std::ostringstream oss;
+            oss << "[" << m_files << "/" << m_totalFiles << "] " << std::fixed << std::setprecision(1) << ((double)m_bytes / 1.0e6) << "/"
+                << ((double)m_totalBytes / 1.0e6) << " MB, " << (rate / 1.0e6) << " MB/s, ETA ";
+
+            if ((m_bytes > 0) && (m_bytes <= m_totalBytes)) oss << ::durationStr((double)(m_totalBytes - m_bytes) / rate);
+            else oss << "-";
+
+            const std::string line = oss.str();
+            std::cerr << '\r' << line << std::string((m_width > line.length() ? m_width - line.length() : 0), ' ') << std::flush;
+            m_width = line.length();
+        }
+    }
 
+    void m_clear()
+    {
+        if (m_width == 0) return;
+
+        std::cerr << '\r' << std::string(m_width, ' ') << '\r' << std::flush;
+        m_width = 0;
+    }
+
+    ProgressLine(const ProgressLine& other) = delete;
+    ProgressLine& operator=(const ProgressLine&);
+};
+
+
+class ExportOptions
+{
+public:
+    ExportOptions()
+        : m3uFileArg(), outDirArg(), m3uFilePath(), outDirPath(), outDirCanonical(), jobs(1), mode(::ExportMode::copy), sync(false), syncHash(false),
+          checksum(false), dedup(false), dedupHash(false), archive(false), archiveFormat(util::ArchiveWriter::Format::tar), archiveToStdout(false),
+          ioUring(false), ioUringDepth(0), dryRun(false)
+    {}
+
+    virtual ~ExportOptions() {}
+
+    std::string m3uFileArg;
+    std::string outDirArg;
+    fs::path m3uFilePath;
+    fs::path outDirPath;
+    fs::path outDirCanonical; // set after the out dir is created
+
+    size_t jobs;
+    ::ExportMode mode;
+    bool sync;
+    bool syncHash;
+    bool checksum;
+    bool dedup;
+    bool dedupHash;
+
+    bool archive; // OUTDIR is the archive file then, "-" for stdout
+    util::ArchiveWriter::Format archiveFormat;
+    bool archiveToStdout;
+
+    bool ioUring;
+    size_t ioUringDepth; // files in flight
+
+    bool dryRun;
+};
+
+// of the export, printed in the summary
+class ExportCounts
+{
+public:
+    ExportCounts()
+        : hardlinks(0), symlinks(0), copies(0), unchanged(0), renamed(0), removed(0), duplicates(0), bytesSaved(0)
+    {}
+
+    virtual ~ExportCounts() {}
+
+    size_t hardlinks;
+    size_t symlinks;
+    size_t copies;
+
+    size_t unchanged; // by the sync
+    size_t renamed;   // by the sync
+    size_t removed;   // by the sync
+
+    size_t duplicates;
+    uint64_t bytesSaved; // by the deduplication
+};
+
+::ExportOptions parseOptions(app::MessageCounter& msgCnt, const app::Flags& flags, const app::Args& args)
+{
     IMPLEMENT_FLAGS();
 
-    MessageCounter msgCnt = 0;
-    util::CopyFileCounter fileCnt;
-    util::ResultCounter rcnt = 0;
+    ::ExportOptions opt;
 
     // TODO make nicer
-    const std::string m3uFileArg = args.raw.at(1);
-    const std::string outDirArg = args.raw.at(2);
+    opt.m3uFileArg = args.files().at(1);
+    opt.outDirArg = args.files().at(2);
+    const std::string jobsArg = args.optionValue(argstr::jobs, "1");
+    const std::string linkArg = args.optionValue(argstr::link, (args.contains(argstr::link) ? "copy" : ""));
+    const std::string syncArg = args.optionValue(argstr::sync, (args.contains(argstr::sync) ? "stat" : ""));
+    const std::string dedupArg = args.optionValue(argstr::dedup, (args.contains(argstr::dedup) ? "inode" : ""));
+    const std::string archiveArg = args.optionValue(argstr::archive, (args.contains(argstr::archive) ? "tar" : ""));
+    const bool ioUringArg = args.contains(argstr::ioUring);
+    opt.checksum = args.contains(argstr::checksum);
+    opt.dryRun = args.contains(argstr::dryRun);
 
-    const fs::path m3uFilePath = enc::path(m3uFileArg);
-    const fs::path outDirPath = enc::path(outDirArg);
+    opt.m3uFilePath = enc::path(opt.m3uFileArg);
+    opt.outDirPath = enc::path(opt.outDirArg);
 
-#if defined(PRJ_DEBUG) && 1
-    app::dbg_rm_outDir(outDirPath);
-#endif
+    if (!omw::isUInteger(jobsArg) || (jobsArg.length() > 4) || (std::stoi(jobsArg) < 1)) PRINT_ERROR_EXIT("invalid --jobs value", EC_ERROR);
+    opt.jobs = std::stoul(jobsArg);
 
+    if (linkArg == "copy") opt.mode = ::ExportMode::link;
+    else if (linkArg == "symlink") opt.mode = ::ExportMode::linkSymlink;
+    else if (!linkArg.empty()) PRINT_ERROR_EXIT("invalid --link value", EC_ERROR);
 
-    ///////////////////////////////////////////////////////////
-    // check and read in file
-    ///////////////////////////////////////////////////////////
+    if (!syncArg.empty() && (syncArg != "stat") && (syncArg != "hash")) PRINT_ERROR_EXIT("invalid --sync value", EC_ERROR);
+    opt.sync = !syncArg.empty();
+    opt.syncHash = (syncArg == "hash");
 
-    const m3u::M3U m3u = app::getFromUri(msgCnt, flags, util::Uri(m3uFileArg));
+    if (!dedupArg.empty() && (dedupArg != "inode") && (dedupArg != "hash")) PRINT_ERROR_EXIT("invalid --dedup value", EC_ERROR);
 
+    opt.archive = !archiveArg.empty();
+    opt.archiveFormat = (archiveArg == "zip" ? util::ArchiveWriter::Format::zip : util::ArchiveWriter::Format::tar);
+    opt.archiveToStdout = (opt.outDirArg == "-");
 
-    ///////////////////////////////////////////////////////////
-    // check/create out dir
-    ///////////////////////////////////////////////////////////
+    if (opt.archive && (archiveArg != "tar") && (archiveArg != "zip")) PRINT_ERROR_EXIT("invalid --archive value", EC_ERROR);
+    if (opt.archive && ((opt.mode != ::ExportMode::copy) || opt.sync || opt.checksum))
+    {
+        PRINT_ERROR_EXIT("--archive can't be combined with --link, --sync or --checksum", EC_ERROR);
+    }
 
-    app::checkCreateOutDir(msgCnt, flags, outDirPath, outDirArg);
+    // zip has no links
+    const bool dedupPossible = ((opt.mode == ::ExportMode::copy) && (!opt.archive || (opt.archiveFormat != util::ArchiveWriter::Format::zip)));
+    if (!dedupArg.empty() && !dedupPossible) PRINT_WARNING_V("--dedup has no effect with --link or a zip archive");
+    opt.dedup = (!dedupArg.empty() && dedupPossible);
+    opt.dedupHash = (dedupArg == "hash");
 
+    // verified copies are hashed by the copier, links and archives have no copies
+    const bool ioUringPossible = ((opt.mode == ::ExportMode::copy) && !opt.archive && !opt.checksum);
+    if (ioUringArg && !ioUringPossible) PRINT_WARNING_V("--io-uring has no effect with --link, --archive or --checksum");
 
-    ///////////////////////////////////////////////////////////
-    // process
-    ///////////////////////////////////////////////////////////
+    // detected at runtime, the kernel may be older or io_uring disabled
+    opt.ioUring = (ioUringArg && ioUringPossible);
+    if (opt.ioUring && !util::UringCopier::available())
+    {
+        PRINT_WARNING_V("io_uring is not available, the files are copied with --jobs workers");
+        opt.ioUring = false;
+    }
+
+    opt.ioUringDepth = (!args.optionValue(argstr::jobs, "").empty() ? opt.jobs : 64);
+
+    return opt;
+}
+
+// Creates the out dir or opens the archive, returns the archive writer (null if not exporting to an archive).
+std::unique_ptr<util::ArchiveWriter> prepareOutput(app::MessageCounter& msgCnt, const app::Flags& flags, const ::ExportOptions& opt,
+                                                   const util::ExportManifest& manifest, std::FILE*& archiveStream)
+{
+    const bool& quiet = flags.quiet;
+
+    std::unique_ptr<util::ArchiveWriter> archiveWriter;
+    archiveStream = nullptr;
+
+    // a dry run doesn't write anything
+    if (opt.dryRun)
+    {
+        std::error_code ec;
+        if (!opt.archive && !opt.sync && fs::is_directory(opt.outDirPath, ec) && !fs::is_empty(opt.outDirPath, ec))
+        {
+            PRINT_WARNING("###OUTDIR \"" + opt.outDirArg + "\" is not empty");
+        }
+    }
+    else if (opt.archive)
+    {
+        if (opt.archiveToStdout)
+        {
+            archiveStream = stdout;
+#ifdef OMW_PLAT_WIN
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        }
+        else
+        {
+            app::checkOutFile(msgCnt, flags, opt.outDirPath, opt.outDirArg, "archive");
+
+#ifdef OMW_PLAT_WIN
+            archiveStream = _wfopen(opt.outDirPath.c_str(), L"wb");
+#else
+            archiveStream = std::fopen(opt.outDirPath.c_str(), "wb");
+#endif
+            if (!archiveStream) PRINT_ERROR_EXIT("failed to create the archive", EC_ERROR);
+        }
+
+        archiveWriter = std::make_unique<util::ArchiveWriter>(opt.archiveFormat, archiveStream);
+    }
+
+    // the directory of a previous sync is not empty
+    else if (!opt.sync || !fs::exists(manifest.file())) app::checkCreateOutDir(msgCnt, flags, opt.outDirPath, opt.outDirArg);
+
+    return archiveWriter;
+}
+
+// the output files are numbered in playlist order, independent of the order in which they are copied
+std::vector<::ExportJob> createJobs(util::CopyFileCounter& fileCnt, const m3u::M3U& m3u, const ::ExportOptions& opt)
+{
+    const fs::path basePath = opt.m3uFilePath.parent_path();
 
-    const fs::path basePath = m3uFilePath.parent_path();
+    std::vector<::ExportJob> exportJobs;
 
     for (size_t i = 0; i < m3u.entries().size(); ++i)
     {
@@ -101,59 +707,808 @@ int app::exprt(const app::Args& args, const app::Flags& flags)
         std::stringstream filename;
         filename << std::setw(4) << std::setfill('0') << fileCnt.total();
         filename << '_' << inFilePath.filename().u8string();
-        const fs::path outFilePath = outDirPath / enc::path(filename.str());
 
-        if (verbose) app::printFormattedLine("###copying \"" + inFilePath.u8string() + "\" to \"" + fs::weakly_canonical(outFilePath).u8string() + "\"");
+        exportJobs.emplace_back(inFilePath, opt.outDirPath / enc::path(filename.str()));
+    }
+
+    return exportJobs;
+}
+
+// every input file is looked up once, the later phases use the results
+void queryMetadata(std::vector<::ExportJob>& exportJobs)
+{
+    std::vector<fs::path> inFiles;
+    inFiles.reserve(exportJobs.size());
+    for (const auto& job : exportJobs) inFiles.push_back(job.inFile);
+
+    util::FileMetadata metadata;
+    metadata.query(inFiles);
+
+    for (auto& job : exportJobs) job.input = metadata.get(job.inFile);
+}
+
+// Marks the unchanged files of a previous sync as skipped, renames the moved ones and removes the outdated ones. The records of missing
+// input files are added to `retained`, their output files are kept.
+void syncOutDir(const app::Flags& flags, util::ResultCounter& rcnt, const ::ExportOptions& opt, util::ExportManifest& manifest, util::ChecksumFile& checksums,
+                std::vector<::ExportJob>& exportJobs, std::vector<util::ExportManifest::Record>& retained, ::ExportCounts& counts)
+{
+    IMPLEMENT_FLAGS();
+
+    manifest.load();
+
+    // of the unchanged files
+    std::unordered_map<std::string, uint64_t> oldChecksums;
+
+    if (opt.checksum && checksums.load())
+    {
+        for (const auto& entry : checksums.entries()) oldChecksums[entry.name] = entry.hash;
+    }
+
+    const std::vector<util::ExportManifest::Record>& records = manifest.records();
+    std::vector<bool> used(records.size(), false);
+
+    std::unordered_map<std::string, std::vector<size_t>> bySource;
+    for (size_t i = 0; i < records.size(); ++i) bySource[records[i].source].push_back(i);
+
+    std::vector<size_t> toRemove;
+    std::vector<std::pair<size_t, ::ExportJob*>> toRename;
+    std::unordered_set<std::string> targets;
+
+    // the file is exported instead
+    const auto resetJob = [](::ExportJob& job) {
+        const util::ExportManifest::Record record = job.record;
+        const util::FileMetadata::Info input = job.input;
+        job = ::ExportJob(job.inFile, job.outFile);
+        job.input = input;
+        job.record = record;
+    };
+
+    for (auto& job : exportJobs)
+    {
+        const std::string target = job.outFile.filename().u8string();
+
+        // a record of the same source, preferably with the same target (the source may be in the playlist more than once)
+        size_t recIdx = records.size();
+        const auto it = bySource.find(util::ExportManifest::sourceKey(job.inFile));
 
-        if (fs::exists(inFilePath))
+        if (it != bySource.end())
         {
-            if (fs::is_regular_file(inFilePath))
+            for (const size_t idx : it->second)
             {
-                try
-                {
-                    fs::copy_file(inFilePath, outFilePath);
-                    fileCnt.addCopied();
-                }
-                catch (const fs::filesystem_error& ex)
-                {
-                    ERROR_PRINT(std::string("###") + ex.what());
-                }
-                // other exceptions will be catched by the main try-catch in this function
+                if (used[idx]) continue;
+                if ((recIdx == records.size()) || (records[idx].target == target)) recIdx = idx;
             }
-            else ERROR_PRINT("###\"" + inFilePath.u8string() + "\" is not a file");
         }
-        else ERROR_PRINT("###file \"" + inFilePath.u8string() + "\" not found");
-    }
 
+        if (recIdx < records.size()) used[recIdx] = true;
 
-    ///////////////////////////////////////////////////////////
-    // end
-    ///////////////////////////////////////////////////////////
+        std::error_code ec;
 
-    if (!quiet)
-    {
-        cout << "========";
+        // reported by the export
+        if (!job.input.isRegular())
+        {
+            if (recIdx < records.size()) retained.push_back(records[recIdx]);
+            continue;
+        }
 
-        cout << "  " << omw::fgBrightWhite;
-        cout << fileCnt.copied() << "/" << fileCnt.total();
-        cout << omw::normal << " exported";
+        job.record = util::ExportManifest::sourceRecord(job.inFile, opt.syncHash);
+        job.record.target = target;
+        targets.insert(target);
 
-        cout << ", ";
-        if (rcnt.errors() != 0) cout << omw::fgBrightRed;
-        cout << rcnt.errors();
-        if (rcnt.errors() != 0) cout << omw::normal;
-        cout << " error";
-        if (rcnt.errors() != 1) cout << "s";
+        if (recIdx == records.size()) continue;
 
-        cout << ", ";
-        if (rcnt.warnings() != 0) cout << omw::fgBrightYellow;
-        cout << rcnt.warnings();
-        if (rcnt.warnings() != 0) cout << omw::normal;
-        cout << " warning";
-        if (rcnt.warnings() != 1) cout << "s";
+        const auto& rec = records[recIdx];
+        const uint64_t targetSize = fs::file_size(opt.outDirPath / enc::path(rec.target), ec);
 
-        cout << "  ========" << endl;
-    }
+        if (rec.sameSource(job.record) && !ec && (targetSize == rec.size))
+        {
+            if (job.record.hash.empty()) job.record.hash = rec.hash;
+
+            job.skip = true;
+            job.copied = true;
+
+            const auto oldChecksum = oldChecksums.find(rec.target);
+
+            if (oldChecksum != oldChecksums.end())
+            {
+                job.hashed = true;
+                job.hash = oldChecksum->second;
+            }
+
+            if (rec.target == target) job.output = ::Output::unchanged;
+            else
+            {
+                job.output = ::Output::renamed;
+                toRename.emplace_back(recIdx, &job);
+            }
+        }
+        else toRemove.push_back(recIdx);
+    }
+
+    // files which left the playlist
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        if (!used[i])
+        {
+            toRemove.push_back(i);
+            ++counts.removed;
+        }
+    }
+
+    // the changes below are not applied by a dry run
+    if (opt.dryRun)
+    {
+        toRemove.clear();
+        toRename.clear();
+    }
+
+    // the names of kept files of missing inputs may be used by other files now
+    for (size_t i = 0; (i < retained.size()) && !opt.dryRun;)
+    {
+        if (targets.count(retained[i].target) != 0)
+        {
+            std::error_code ec;
+            fs::remove(opt.outDirPath / enc::path(retained[i].target), ec);
+            retained.erase(retained.begin() + i);
+        }
+        else ++i;
+    }
+
+    for (const size_t idx : toRemove)
+    {
+        const fs::path file = opt.outDirPath / enc::path(records[idx].target);
+
+        if (verbose) app::printFormattedLine("###removing \"" + (opt.outDirCanonical / file.filename()).u8string() + "\"");
+
+        std::error_code ec;
+        fs::remove(file, ec);
+        if (ec) ERROR_PRINT("###\"" + file.u8string() + "\": " + ec.message());
+    }
+
+    // in two steps, the new name may be the old name of another file
+    for (const auto& rename : toRename)
+    {
+        std::error_code ec;
+        fs::rename(opt.outDirPath / enc::path(records[rename.first].target), opt.outDirPath / enc::path(records[rename.first].target + ".sync.tmp"), ec);
+
+        if (ec) resetJob(*rename.second);
+    }
+
+    for (const auto& rename : toRename)
+    {
+        ::ExportJob& job = *rename.second;
+        if (!job.skip) continue;
+
+        const fs::path tmpFile = opt.outDirPath / enc::path(records[rename.first].target + ".sync.tmp");
+        std::error_code ec;
+
+        if (fs::exists(job.outFile, ec)) ec = std::make_error_code(std::errc::file_exists);
+        else fs::rename(tmpFile, job.outFile, ec);
+
+        if (ec)
+        {
+            fs::remove(tmpFile, ec);
+            resetJob(job);
+        }
+        else if (verbose)
+        {
+            app::printFormattedLine("###renamed \"" + records[rename.first].target + "\" to \"" + (opt.outDirCanonical / job.outFile.filename()).u8string() +
+                                    "\"");
+        }
+    }
+}
+
+// sets the primary of duplicates, see ExportJob::primary
+void findDuplicates(std::vector<::ExportJob>& exportJobs, bool byHash)
+{
+    // by device and inode (the same file, also through other paths or hard links), the first occurrence is exported. Where the inode is
+    // unknown (not Linux) by canonical path.
+    std::unordered_map<std::string, size_t> byFile;
+    std::unordered_map<uint64_t, std::vector<size_t>> bySize;
+
+    for (size_t i = 0; i < exportJobs.size(); ++i)
+    {
+        auto& job = exportJobs[i];
+        if (job.skip) continue;
+
+        if (!job.input.isRegular()) continue;
+
+        std::string key;
+        if (job.input.hasFileId()) key = std::to_string(job.input.device) + ':' + std::to_string(job.input.inode);
+        else
+        {
+            std::error_code ec;
+            key = fs::weakly_canonical(job.inFile, ec).u8string();
+            if (ec) key = job.inFile.u8string();
+        }
+
+        const auto res = byFile.emplace(key, i);
+
+        if (!res.second) job.primary = res.first->second;
+        else if (byHash) bySize[job.input.size].push_back(i);
+    }
+
+    // different files with the same content, only files of the same size have to be hashed
+    for (const auto& group : bySize)
+    {
+        if (group.second.size() < 2) continue;
+
+        std::unordered_map<std::string, size_t> byContent;
+
+        for (const size_t idx : group.second)
+        {
+            auto& job = exportJobs[idx];
+            std::string hash = job.record.hash;
+
+            try
+            {
+                if (hash.empty()) hash = util::ExportManifest::sourceRecord(job.inFile, true).hash;
+            }
+            catch (...)
+            {
+                continue;
+            }
+
+            const auto res = byContent.emplace(hash, idx);
+            if (!res.second) job.primary = res.first->second;
+        }
+    }
+
+    // duplicates of duplicates by path
+    for (auto& job : exportJobs)
+    {
+        while ((job.primary != SIZE_MAX) && (exportJobs[job.primary].primary != SIZE_MAX)) job.primary = exportJobs[job.primary].primary;
+    }
+}
+
+// Prints what an export would do, the required and available space and the estimated duration. Returns EC_ERROR if there is not enough
+// space.
+int printPlan(app::MessageCounter& msgCnt, const app::Flags& flags, const ::ExportOptions& opt, const std::vector<::ExportJob>& exportJobs, const ::Plan& plan)
+{
+    const bool& quiet = flags.quiet;
+
+    // hard links need no space, except for the files which are on another device and copied instead
+    uint64_t required = plan.bytes;
+    const fs::path outDirAncestor = (opt.archiveToStdout ? fs::path() : ::existingAncestor(opt.archive ? opt.outDirPath.parent_path() : opt.outDirPath));
+
+    if (opt.mode != ::ExportMode::copy)
+    {
+        const uint64_t outDevice = util::FileMetadata::lookup(outDirAncestor).device;
+        required = 0;
+
+        for (const auto& job : exportJobs)
+        {
+            if ((opt.mode == ::ExportMode::link) && (job.input.device != outDevice)) required += ::planBytes(job);
+        }
+    }
+
+    // a tar header and the padding per file
+    if (opt.archive) required += (uint64_t)(plan.files + plan.duplicates) * 1024;
+
+    std::vector<std::string> details;
+    if (plan.unchanged != 0) details.push_back(std::to_string(plan.unchanged) + " unchanged");
+    if (plan.duplicates != 0) details.push_back(std::to_string(plan.duplicates) + " duplicate" + (plan.duplicates != 1 ? "s" : ""));
+    if (plan.missing != 0) details.push_back(std::to_string(plan.missing) + " missing");
+
+    std::string detailsStr;
+    for (size_t i = 0; i < details.size(); ++i) detailsStr += (i == 0 ? " (" : ", ") + details[i];
+    if (!details.empty()) detailsStr += ")";
+
+    PRINT_INFO(std::to_string(plan.files) + " of " + std::to_string(exportJobs.size()) + " files to export" + detailsStr + ", " + ::megabytesStr(plan.bytes) +
+               ", " + ::megabytesStr(required) + " required");
+
+    bool enoughSpace = true;
+
+    if (!outDirAncestor.empty())
+    {
+        std::error_code ec;
+        const fs::space_info space = fs::space(outDirAncestor, ec);
+
+        if (ec) PRINT_WARNING("###failed to get the free space of \"" + outDirAncestor.u8string() + "\": " + ec.message())
+        else
+        {
+            enoughSpace = (space.available >= required);
+
+            if (enoughSpace) PRINT_INFO("###" + ::megabytesStr(space.available) + " available on \"" + outDirAncestor.u8string() + "\"")
+            else PRINT_ERROR("###" + ::megabytesStr(space.available) + " available on \"" + outDirAncestor.u8string() + "\", not enough space");
+        }
+    }
+
+    if ((required > 0) || (opt.mode == ::ExportMode::copy))
+    {
+        uint64_t sampled = 0;
+        const double throughput = ::sampleThroughput(exportJobs, sampled);
+
+        if (throughput > 0)
+        {
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(1) << (throughput / 1.0e6) << " MB/s read";
+
+            // only the transferred data takes time, links are negligible
+            const uint64_t transferred = (opt.mode == ::ExportMode::copy ? plan.bytes : required);
+
+            PRINT_INFO("estimated duration " + ::durationStr((double)transferred / throughput) + " (" + oss.str() + ", sampled " + ::megabytesStr(sampled) +
+                       ")");
+        }
+    }
+
+    return (enoughSpace ? EC_OK : EC_ERROR);
+}
+
+// called in playlist order for every job when it's done
+void reportJob(const app::Flags& flags, util::ResultCounter& rcnt, util::CopyFileCounter& fileCnt, ::ExportCounts& counts, ::ProgressLine* progress,
+               const ::ExportOptions& opt, const std::vector<::ExportJob>& exportJobs, const ::ExportJob& job)
+{
+    IMPLEMENT_FLAGS();
+
+    std::unique_lock<std::mutex> progressLock;
+    if (progress) progressLock = progress->suspend();
+
+    if (verbose && !job.skip)
+    {
+        std::string details;
+
+        if (job.output == ::Output::hardlink) details = " (hard link)";
+        else if (job.output == ::Output::symlink) details = " (symbolic link)";
+        else if (job.output == ::Output::archived) details = " (" + std::to_string(job.result.bytes) + " bytes)";
+        else if (job.output == ::Output::duplicate)
+        {
+            details = " (" + std::string(util::ContentCache::toString(job.linkMethod)) + " of \"" + exportJobs[job.primary].outFile.filename().u8string() +
+                      "\")";
+        }
+        else if (job.copied)
+        {
+            details = " (" + std::to_string(job.result.bytes) + " bytes, " + util::FileCopier::toString(job.result.method) + ", " +
+                      ::throughputStr(job.result) + (job.hashed ? ", verified" : "") + ")";
+        }
+
+        const bool linked = ((job.output == ::Output::hardlink) || (job.output == ::Output::symlink) || (job.output == ::Output::duplicate));
+
+        if (opt.archive) app::printFormattedLine("###adding \"" + job.inFile.u8string() + "\" as \"" + job.outFile.filename().u8string() + "\"" + details);
+        else
+        {
+            app::printFormattedLine(std::string(linked ? "###linking" : "###copying") + " \"" + job.inFile.u8string() + "\" to \"" +
+                                    (opt.outDirCanonical / job.outFile.filename()).u8string() + "\"" + details);
+        }
+    }
+
+    if (job.output == ::Output::hardlink) ++counts.hardlinks;
+    else if (job.output == ::Output::symlink) ++counts.symlinks;
+    else if (job.output == ::Output::copy) ++counts.copies;
+    else if (job.output == ::Output::unchanged) ++counts.unchanged;
+    else if (job.output == ::Output::renamed) ++counts.renamed;
+    else if (job.output == ::Output::duplicate)
+    {
+        ++counts.duplicates;
+        if (job.linkMethod != util::ContentCache::LinkMethod::copy) counts.bytesSaved += job.result.bytes;
+    }
+
+    if (job.copied) fileCnt.addCopied();
+    else ERROR_PRINT(job.error);
+
+    if (progressLock) progressLock.unlock();
+    if (progress && !job.skip) progress->add(job);
+}
+
+// the stream is written sequentially
+void exportToArchive(const ::ExportOptions& opt, util::ArchiveWriter& archiveWriter, std::FILE* archiveStream, std::vector<::ExportJob>& exportJobs,
+                     const std::function<void(const ::ExportJob&)>& report)
+{
+    for (auto& job : exportJobs)
+    {
+        ::archiveFile(archiveWriter, job, (job.primary != SIZE_MAX ? &exportJobs[job.primary] : nullptr));
+        report(job);
+    }
+
+    archiveWriter.finish();
+
+    if (!opt.archiveToStdout && (std::fclose(archiveStream) != 0)) throw std::runtime_error("failed to write the archive");
+}
+
+// The copies are done by the ring, everything else (errors, duplicates, the sync) is done on this thread when the reporting in playlist
+// order reaches it.
+void exportIoUring(const app::Flags& flags, const ::ExportOptions& opt, util::FileCopier& copier, std::vector<::ExportJob>& exportJobs,
+                   const std::function<void(const ::ExportJob&)>& report)
+{
+    IMPLEMENT_FLAGS();
+
+    std::vector<util::UringCopier::File> files;
+    std::vector<size_t> fileJobs; // index of the job of each file
+    std::vector<bool> byRing(exportJobs.size(), false);
+
+    for (size_t i = 0; i < exportJobs.size(); ++i)
+    {
+        const auto& job = exportJobs[i];
+
+        if (!job.skip && (job.primary == SIZE_MAX) && job.input.isRegular())
+        {
+            files.emplace_back(job.inFile, job.outFile);
+            fileJobs.push_back(i);
+            byRing[i] = true;
+        }
+    }
+
+    size_t nextReport = 0;
+
+    const auto advance = [&]() {
+        while (nextReport < exportJobs.size())
+        {
+            auto& job = exportJobs[nextReport];
+
+            if (byRing[nextReport])
+            {
+                if (!job.done) break;
+            }
+            else if (job.primary != SIZE_MAX) ::exportDuplicate(copier, job, exportJobs[job.primary], opt.mode, opt.checksum);
+            else if (!job.skip) ::exportFile(copier, job, opt.mode, opt.checksum);
+
+            report(job);
+            ++nextReport;
+        }
+    };
+
+    util::UringCopier ring(std::max<size_t>(1, std::min(opt.ioUringDepth, files.size())));
+
+    if (verbose)
+    {
+        app::printFormattedLine("###io_uring: " + std::to_string(ring.depth()) + " file" + (ring.depth() != 1 ? "s" : "") + " in flight, " +
+                                (ring.fixedBuffers() ? "registered" : "unregistered") + " buffers");
+    }
+
+    advance();
+
+    ring.copy(files, [&](size_t index, const util::FileCopier::Result& result) {
+        auto& job = exportJobs[fileJobs[index]];
+
+        job.result = result;
+        job.done = true;
+
+        if (result.good())
+        {
+            job.copied = true;
+            job.output = ::Output::copy;
+        }
+        else job.error = "###" + result.error;
+
+        advance();
+    });
+
+    advance();
+}
+
+void exportSequential(const ::ExportOptions& opt, util::FileCopier& copier, std::vector<::ExportJob>& exportJobs,
+                      const std::function<void(const ::ExportJob&)>& report)
+{
+    for (auto& job : exportJobs)
+    {
+        if (job.primary != SIZE_MAX) ::exportDuplicate(copier, job, exportJobs[job.primary], opt.mode, opt.checksum);
+        else if (!job.skip) ::exportFile(copier, job, opt.mode, opt.checksum);
+
+        report(job);
+    }
+}
+
+// Each source device gets its own queue, rotational disks are read by one worker in the order of the data on the disk to avoid seeks, the
+// others by `jobs` workers in inode order. The results are reported in playlist order while the workers continue.
+void exportDevicePools(const app::Flags& flags, const ::ExportOptions& opt, util::FileCopier& copier, std::vector<::ExportJob>& exportJobs,
+                       const std::function<void(const ::ExportJob&)>& report)
+{
+    IMPLEMENT_FLAGS();
+
+    const ::ExportMode mode = opt.mode;
+    const bool checksum = opt.checksum;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::atomic<bool> abort(false);
+
+    const auto task = [&copier, mode, checksum, &mtx, &cv, &abort](::ExportJob& job, const ::ExportJob* primary) {
+        std::exception_ptr ex;
+
+        try
+        {
+            if (primary)
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [primary]() { return primary->done; });
+            }
+
+            if (!abort)
+            {
+                if (primary) ::exportDuplicate(copier, job, *primary, mode, checksum);
+                else ::exportFile(copier, job, mode, checksum);
+            }
+        }
+        catch (...)
+        {
+            ex = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lg(mtx);
+            job.exception = ex;
+            job.done = true;
+        }
+
+        cv.notify_all();
+    };
+
+    std::vector<::DeviceQueue> devices;
+    std::vector<size_t> otherJobs; // duplicates and inputs which don't exist
+
+    for (size_t i = 0; i < exportJobs.size(); ++i)
+    {
+        auto& job = exportJobs[i];
+
+        if (job.skip)
+        {
+            job.done = true;
+            continue;
+        }
+
+        if ((job.primary != SIZE_MAX) || !job.input.exists())
+        {
+            otherJobs.push_back(i);
+            continue;
+        }
+
+        const uint64_t device = job.input.device;
+
+        auto it = std::find_if(devices.begin(), devices.end(), [device](const ::DeviceQueue& dq) { return (dq.device == device); });
+        if (it == devices.end())
+        {
+            devices.emplace_back(device, util::deviceType(device));
+            it = devices.end() - 1;
+        }
+
+        it->add(i, job.input, job.inFile);
+    }
+
+    std::vector<std::unique_ptr<util::WorkerPool>> pools;
+
+    for (auto& dq : devices)
+    {
+        dq.sort();
+
+        const size_t nThreads = (dq.type == util::DeviceType::rotational ? 1 : std::min(opt.jobs, dq.jobs.size()));
+
+        if (verbose)
+        {
+            app::printFormattedLine("###device " + util::deviceStr(dq.device) + " (" + ::toString(dq.type) + "): " + std::to_string(dq.jobs.size()) + " file" +
+                                    (dq.jobs.size() != 1 ? "s" : "") + ", " + std::to_string(nThreads) + " worker" + (nThreads != 1 ? "s" : ""));
+        }
+
+        pools.emplace_back(new util::WorkerPool(nThreads));
+
+        for (const auto& entry : dq.jobs)
+        {
+            auto& job = exportJobs[entry.index];
+            pools.back()->submit([&task, &job]() { task(job, nullptr); });
+        }
+    }
+
+    // Duplicates wait for their first occurrence, they have their own workers so that they don't block the device queues.
+    if (!otherJobs.empty())
+    {
+        pools.emplace_back(new util::WorkerPool(std::min(opt.jobs, otherJobs.size())));
+
+        for (const size_t idx : otherJobs)
+        {
+            auto& job = exportJobs[idx];
+            const ::ExportJob* primary = (job.primary != SIZE_MAX ? &exportJobs[job.primary] : nullptr);
+            pools.back()->submit([&task, &job, primary]() { task(job, primary); });
+        }
+    }
+
+    for (const auto& job : exportJobs)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&job]() { return job.done; });
+        }
+
+        // same as an exception in sequential mode, the remaining jobs are skipped
+        if (job.exception)
+        {
+            abort = true;
+            std::rethrow_exception(job.exception);
+        }
+
+        report(job);
+    }
+
+    for (auto& pool : pools) pool->wait();
+}
+
+void writeManifest(const app::Flags& flags, util::ResultCounter& rcnt, util::ExportManifest& manifest, const std::vector<::ExportJob>& exportJobs,
+                   const std::vector<util::ExportManifest::Record>& retained)
+{
+    const bool& quiet = flags.quiet;
+
+    manifest.clear();
+
+    for (const auto& job : exportJobs)
+    {
+        if (job.copied && !job.record.source.empty()) manifest.add(job.record);
+    }
+
+    for (const auto& record : retained) manifest.add(record);
+
+    try
+    {
+        manifest.save();
+    }
+    catch (const std::exception& ex)
+    {
+        ERROR_PRINT("###failed to write \"" + manifest.file().u8string() + "\": " + ex.what());
+    }
+}
+
+void writeChecksums(const app::Flags& flags, util::ResultCounter& rcnt, util::ChecksumFile& checksums, std::vector<::ExportJob>& exportJobs)
+{
+    const bool& quiet = flags.quiet;
+
+    checksums.clear();
+
+    for (auto& job : exportJobs)
+    {
+        if (!job.copied) continue;
+
+        // files of a previous sync without a recorded checksum
+        std::string error;
+        if (!job.hashed) job.hashed = util::xxh64File(job.outFile, job.hash, error);
+
+        if (job.hashed) checksums.add(job.outFile.filename().u8string(), job.hash);
+        else ERROR_PRINT("###" + error);
+    }
+
+    try
+    {
+        checksums.save();
+    }
+    catch (const std::exception& ex)
+    {
+        ERROR_PRINT("###failed to write \"" + checksums.file().u8string() + "\": " + ex.what());
+    }
+}
+
+void printSummary(const util::CopyFileCounter& fileCnt, const util::ResultCounter& rcnt, const ::ExportOptions& opt, const ::ExportCounts& counts,
+                  const util::ArchiveWriter* archiveWriter)
+{
+    cout << "========";
+
+    cout << "  " << omw::fgBrightWhite;
+    cout << fileCnt.copied() << "/" << fileCnt.total();
+    cout << omw::normal << " exported";
+
+    // fallbacks of the link mode and the actions of the sync
+    std::vector<std::string> details;
+
+    if (opt.mode != ::ExportMode::copy) details.push_back(std::to_string(counts.hardlinks) + " hard link" + (counts.hardlinks != 1 ? "s" : ""));
+    if (counts.symlinks != 0) details.push_back(std::to_string(counts.symlinks) + " symbolic link" + (counts.symlinks != 1 ? "s" : ""));
+    if ((counts.copies != 0) || (opt.sync && (opt.mode == ::ExportMode::copy)))
+    {
+        details.push_back(std::to_string(counts.copies) + " cop" + (counts.copies != 1 ? "ies" : "y"));
+    }
+
+    if (archiveWriter) details.push_back(::megabytesStr(archiveWriter->bytes()) + " archive");
+    if (opt.dedup) details.push_back(std::to_string(counts.duplicates) + " deduplicated, " + ::megabytesStr(counts.bytesSaved) + " saved");
+
+    if (opt.sync)
+    {
+        details.push_back(std::to_string(counts.unchanged) + " unchanged");
+        details.push_back(std::to_string(counts.renamed) + " renamed");
+        details.push_back(std::to_string(counts.removed) + " removed");
+    }
+
+    for (size_t i = 0; i < details.size(); ++i) cout << (i == 0 ? " (" : ", ") << details[i];
+    if (!details.empty()) cout << ")";
+
+    cout << ", ";
+    if (rcnt.errors() != 0) cout << omw::fgBrightRed;
+    cout << rcnt.errors();
+    if (rcnt.errors() != 0) cout << omw::normal;
+    cout << " error";
+    if (rcnt.errors() != 1) cout << "s";
+
+    cout << ", ";
+    if (rcnt.warnings() != 0) cout << omw::fgBrightYellow;
+    cout << rcnt.warnings();
+    if (rcnt.warnings() != 0) cout << omw::normal;
+    cout << " warning";
+    if (rcnt.warnings() != 1) cout << "s";
+
+    cout << "  ========" << endl;
+}
+
+} // namespace
+
+
+
+int app::exprt(const app::Args& args, const app::Flags& flags)
+{
+    int r = EC_ERROR;
+
+    const bool& quiet = flags.quiet;
+
+    MessageCounter msgCnt = 0;
+    util::CopyFileCounter fileCnt;
+    util::ResultCounter rcnt = 0;
+
+    ::ExportOptions opt = ::parseOptions(msgCnt, flags, args);
+
+    util::ExportManifest manifest(opt.outDirPath / util::ExportManifest::fileName);
+    util::ChecksumFile checksums(opt.outDirPath / util::ChecksumFile::defaultName);
+
+#if defined(PRJ_DEBUG) && 1
+    if (!opt.sync && !opt.archive) app::dbg_rm_outDir(opt.outDirPath);
+#endif
+
+
+    ///////////////////////////////////////////////////////////
+    // check and read in file
+    ///////////////////////////////////////////////////////////
+
+    const m3u::M3U m3u = app::getFromUri(msgCnt, flags, util::Uri(opt.m3uFileArg));
+
+
+    ///////////////////////////////////////////////////////////
+    // check/create out dir
+    ///////////////////////////////////////////////////////////
+
+    std::FILE* archiveStream = nullptr;
+    const std::unique_ptr<util::ArchiveWriter> archiveWriter = ::prepareOutput(msgCnt, flags, opt, manifest, archiveStream);
+
+    opt.outDirCanonical = fs::weakly_canonical(opt.outDirPath);
+
+
+    ///////////////////////////////////////////////////////////
+    // process
+    ///////////////////////////////////////////////////////////
+
+    std::vector<::ExportJob> exportJobs = ::createJobs(fileCnt, m3u, opt);
+    ::queryMetadata(exportJobs);
+
+    ::ExportCounts counts;
+    std::vector<util::ExportManifest::Record> retained; // of input files which are missing, their output files are kept
+
+    if (opt.sync) ::syncOutDir(flags, rcnt, opt, manifest, checksums, exportJobs, retained, counts);
+    if (opt.dedup) ::findDuplicates(exportJobs, opt.dedupHash);
+
+    ::Plan plan;
+    for (const auto& job : exportJobs) plan.add(job);
+
+    if (opt.dryRun) return ::printPlan(msgCnt, flags, opt, exportJobs, plan);
+
+
+    ///////////////////////////////////////////////////////////
+    // export
+    ///////////////////////////////////////////////////////////
+
+    // live progress on a terminal
+    std::unique_ptr<::ProgressLine> progress;
+    if (!quiet && (plan.files > 0) && util::stderrIsTerminal()) progress = std::make_unique<::ProgressLine>(plan);
+
+    const auto report = [&](const ::ExportJob& job) { ::reportJob(flags, rcnt, fileCnt, counts, progress.get(), opt, exportJobs, job); };
+
+    util::FileCopier copier;
+
+    if (opt.archive) ::exportToArchive(opt, *archiveWriter, archiveStream, exportJobs, report);
+    else if (opt.ioUring) ::exportIoUring(flags, opt, copier, exportJobs, report);
+    else if ((opt.jobs == 1) || (exportJobs.size() < 2)) ::exportSequential(opt, copier, exportJobs, report);
+    else ::exportDevicePools(flags, opt, copier, exportJobs, report);
+
+    progress.reset();
+
+    if (opt.sync) ::writeManifest(flags, rcnt, manifest, exportJobs, retained);
+    if (opt.checksum) ::writeChecksums(flags, rcnt, checksums, exportJobs);
+
+
+    ///////////////////////////////////////////////////////////
+    // end
+    ///////////////////////////////////////////////////////////
+
+    if (!quiet) ::printSummary(fileCnt, rcnt, opt, counts, archiveWriter.get());
 
     if (((fileCnt.copied() == fileCnt.total()) && (rcnt.errors() != 0)) || ((fileCnt.copied() != fileCnt.total()) && (rcnt.errors() == 0)))
     {
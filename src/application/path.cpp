@@ -11,6 +11,7 @@ copyright       GPL-3.0 - Copyright (c) 2024 Oliver Blaser
 
 #include "application/common.h"
 #include "middleware/encoding-helper.h"
+#include "middleware/file-metadata.h"
 #include "middleware/util.h"
 #include "path.h"
 #include "project.h"
@@ -23,7 +24,31 @@ using std::endl;
 
 namespace fs = std::filesystem;
 
-namespace {}
+namespace {
+
+// the path of a resource in the output playlist, false if `uriStr` doesn't start with `inBase`
+bool rebase(std::string uriStr, const std::string& inBase, const std::string& outBase, bool remove, fs::path& path)
+{
+    if (uriStr.substr(0, inBase.length()) != inBase) return false;
+
+    uriStr.erase(0, inBase.length());
+
+    omw::replaceAll(uriStr, '\\', '/');
+
+    if (remove)
+    {
+        if (inBase.empty()) path = enc::path(uriStr).filename();
+        else if (uriStr.at(0) == '/') path = enc::path(uriStr.erase(0, 1));
+        else path = enc::path(uriStr);
+    }
+    else path = enc::path(outBase + '/' + uriStr);
+
+    path = path.lexically_normal();
+
+    return true;
+}
+
+} // namespace
 
 
 
@@ -40,8 +65,8 @@ int app::path(const app::Args& args, const app::Flags& flags)
     const std::string inBaseArg = ((args.raw.size() > 3) && !args.isOption(3) ? args.raw.at(3) : "");
     const std::string outBaseArg = ((args.raw.size() > 4) && !args.isOption(4) ? args.raw.at(4) : "");
 
-    const bool rmArg = args.contains("--remove");
-    const bool checkExistArg = args.contains("--ck-exists");
+    const bool rmArg = args.contains(argstr::remove);
+    const bool checkExistArg = args.contains(argstr::ckExists);
 
     const fs::path outFilePath = enc::path(outFileArg);
 
@@ -105,34 +130,48 @@ int app::path(const app::Args& args, const app::Flags& flags)
         entryIndex = 2;
     }
 
-    for (size_t i = entryIndex; i < m3u.entries().size(); ++i)
+    // The files are looked up in a batch before the entries are processed, relative to OUTFILE only those which are not found relative to
+    // the working directory.
+    util::FileMetadata metadata;
+
+    if (checkExistArg)
     {
-        const auto& e = m3u.entries()[i];
+        std::vector<fs::path> files;
 
-        if (e.isResource())
+        for (size_t i = entryIndex; i < m3u.entries().size(); ++i)
         {
-            m3u::Entry newEntry = e;
+            const auto& e = m3u.entries()[i];
+            fs::path path;
 
-            std::string uriStr = e.data();
+            if (!e.isResource()) continue;
 
-            if (uriStr.substr(0, inBaseArg.length()) == inBaseArg)
-            {
-                uriStr.erase(0, inBaseArg.length());
+            if (::rebase(e.data(), inBaseArg, outBaseArg, rmArg, path)) files.push_back(enc::path(path.u8string()));
+            else files.push_back(enc::path(e.data()));
+        }
 
-                omw::replaceAll(uriStr, '\\', '/');
+        metadata.query(files);
 
-                fs::path path;
+        std::vector<fs::path> relToOutFile;
+
+        for (const auto& file : files)
+        {
+            if (!metadata.get(file).exists()) relToOutFile.push_back(outFilePath.parent_path() / file);
+        }
 
-                if (rmArg)
-                {
-                    if (inBaseArg.empty()) path = enc::path(uriStr).filename();
-                    else if (uriStr.at(0) == '/') path = enc::path(uriStr.erase(0, 1));
-                    else path = enc::path(uriStr);
-                }
-                else path = enc::path(outBaseArg + '/' + uriStr);
+        metadata.query(relToOutFile);
+    }
 
-                newEntry = m3u::Entry(path.lexically_normal().u8string(), e.ext());
-            }
+    for (size_t i = entryIndex; i < m3u.entries().size(); ++i)
+    {
+        const auto& e = m3u.entries()[i];
+
+        if (e.isResource())
+        {
+            m3u::Entry newEntry = e;
+
+            fs::path path;
+
+            if (::rebase(e.data(), inBaseArg, outBaseArg, rmArg, path)) newEntry = m3u::Entry(path.u8string(), e.ext());
             else
             {
                 PRINT_WARNING("###INBASEPATH not found in entry " + (e.hasExtension() ? (e.ext() + ' ') : std::string()) + '"' + e.data() + '"');
@@ -157,7 +196,7 @@ int app::path(const app::Args& args, const app::Flags& flags)
                 const auto absRelWd = fs::absolute(wd / file);
 #endif // PRJ_DEBUG
 
-                if (fs::exists(file) || fs::exists(fileRelToOutFile)) { fileCnt.addExists(); }
+                if (metadata.get(file).exists() || metadata.get(fileRelToOutFile).exists()) { fileCnt.addExists(); }
                 else PRINT_WARNING_V("###output file \"" + file.u8string() + "\" not found");
             }
 
@@ -16,9 +16,11 @@ copyright       GPL-3.0 - Copyright (c) 2024 Oliver Blaser
 #include <string>
 #include <vector>
 
+#include "application/check.h"
 #include "application/common.h"
 #include "application/export.h"
 #include "application/path.h"
+#include "application/verify.h"
 #include "application/vstreamdl.h"
 #include "middleware/encoding-helper.h"
 #include "middleware/util.h"
@@ -53,6 +55,8 @@ int app::process(const app::Args& args)
 
     IMPLEMENT_FLAGS();
 
+    MessageCounter msgCnt = 0; // dummy
+
     try
     {
 #if defined(OMW_PLAT_WIN) && defined(PRJ_DEBUG) && 0 // tests with UTF-8 path on Windows
@@ -94,10 +98,12 @@ int app::process(const app::Args& args)
         }
 #endif
 
-        MessageCounter msgCnt = 0; // dummy
+        app::configureHttp(msgCnt, flags, args);
 
-        if (args.raw.at(0) == "export") r = app::exprt(args, flags);
+        if (args.raw.at(0) == "check") r = app::check(args, flags);
+        else if (args.raw.at(0) == "export") r = app::exprt(args, flags);
         else if (args.raw.at(0) == "path") r = app::path(args, flags);
+        else if (args.raw.at(0) == "verify") r = app::verify(args, flags);
         else if (args.raw.at(0) == "vstreamdl") r = app::vstreamdl(args, flags);
         else if (args.raw.at(0) == "parse")
         {
@@ -180,6 +186,17 @@ int app::process(const app::Args& args)
         if (!quiet) app::printError("unspecified fatal error");
     }
 
+    app::closeCache(msgCnt, flags);
+
+    try
+    {
+        app::httpReport(msgCnt, flags, args);
+    }
+    catch (const std::exception& ex)
+    {
+        if (!quiet) app::printError(std::string("failed to write HTTP report: ") + enc::acptou8(ex.what()));
+    }
+
     // if (r == EC_USER_ABORT) r = EC_OK;
 
     return r;
@@ -0,0 +1,157 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "application/cliarg.h"
+#include "application/common.h"
+#include "middleware/checksum-file.h"
+#include "middleware/encoding-helper.h"
+#include "middleware/util.h"
+#include "middleware/worker-pool.h"
+#include "project.h"
+#include "verify.h"
+
+#include <omw/cli.h>
+#include <omw/string.h>
+
+
+using std::cout;
+using std::endl;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+class Verification
+{
+public:
+    Verification()
+        : good(false), bytes(0), error()
+    {}
+
+    virtual ~Verification() {}
+
+    bool good;
+    uint64_t bytes;
+    std::string error;
+};
+
+::Verification verifyFile(const fs::path& file, uint64_t expected)
+{
+    ::Verification r;
+    uint64_t hash;
+
+    if (!util::xxh64File(file, hash, r.error)) return r;
+
+    std::error_code ec;
+    r.bytes = fs::file_size(file, ec);
+
+    if (hash == expected) r.good = true;
+    else r.error = "checksum mismatch";
+
+    return r;
+}
+
+} // namespace
+
+
+
+int app::verify(const app::Args& args, const app::Flags& flags)
+{
+    IMPLEMENT_FLAGS();
+
+    MessageCounter msgCnt = 0;
+
+    const std::string fileArg = args.raw.at(1);
+    const std::string jobsArg = args.optionValue(argstr::jobs, "4");
+
+    if (!omw::isUInteger(jobsArg) || (jobsArg.length() > 4) || (std::stoi(jobsArg) < 1)) PRINT_ERROR_EXIT("invalid --jobs value", EC_ERROR);
+    const size_t jobs = std::stoul(jobsArg);
+
+    // the list or the export directory containing it
+    fs::path listFile = enc::path(fileArg);
+    if (fs::is_directory(listFile)) listFile /= util::ChecksumFile::defaultName;
+
+    util::ChecksumFile checksums(listFile);
+
+    if (!checksums.load()) PRINT_ERROR_EXIT("###failed to read \"" + listFile.u8string() + "\"", EC_ERROR);
+    if (checksums.invalidLines() != 0) PRINT_WARNING(std::to_string(checksums.invalidLines()) + " lines are not XXH64 checksums");
+    if (checksums.entries().empty()) PRINT_ERROR_EXIT("no checksums found", EC_ERROR);
+
+    const fs::path baseDir = listFile.parent_path();
+    const auto& entries = checksums.entries();
+
+
+    ///////////////////////////////////////////////////////////
+    // verify
+    ///////////////////////////////////////////////////////////
+
+    std::vector<::Verification> results(entries.size());
+
+    const auto tStart = std::chrono::steady_clock::now();
+
+    if ((jobs == 1) || (entries.size() < 2))
+    {
+        for (size_t i = 0; i < entries.size(); ++i) results[i] = ::verifyFile(baseDir / enc::path(entries[i].name), entries[i].hash);
+    }
+    else
+    {
+        util::WorkerPool pool(std::min(jobs, entries.size()));
+
+        // every task writes to its own element
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            pool.submit([&results, &entries, &baseDir, i]() { results[i] = ::verifyFile(baseDir / enc::path(entries[i].name), entries[i].hash); });
+        }
+
+        pool.wait();
+    }
+
+    const double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+
+
+    ///////////////////////////////////////////////////////////
+    // report
+    ///////////////////////////////////////////////////////////
+
+    size_t failed = 0;
+    uint64_t bytes = 0;
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const auto& res = results[i];
+
+        bytes += res.bytes;
+
+        if (!res.good)
+        {
+            ++failed;
+            PRINT_ERROR("###\"" + entries[i].name + "\": " + res.error);
+        }
+        else if (verbose) cout << omw::fgBrightGreen << "ok   " << omw::fgDefault << entries[i].name << endl;
+    }
+
+    std::ostringstream summary;
+    summary << entries.size() << " files verified in " << std::fixed << std::setprecision(2) << duration << " s";
+    if (duration > 0) summary << " (" << std::setprecision(1) << ((double)bytes / duration / 1.0e6) << " MB/s)";
+    summary << ", " << failed << " failed";
+
+    if (failed > 0) PRINT_ERROR(summary.str())
+    else PRINT_INFO(summary.str());
+
+    return (failed > 0 ? EC_ERROR : EC_OK);
+}
@@ -6,18 +6,31 @@ copyright       GPL-3.0 - Copyright (c) 2024 Oliver Blaser
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
 #include <filesystem>
+#include <fstream>
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "application/common.h"
 #include "middleware/encoding-helper.h"
+#include "middleware/file-merge.h"
+#include "middleware/hls-crypto.h"
+#include "middleware/live-follower.h"
+#include "middleware/m3u-variant.h"
+#include "middleware/m3u-media.h"
+#include "middleware/segment-dl.h"
 #include "middleware/util.h"
+#include "middleware/webvtt.h"
+#include "middleware/worker-pool.h"
 #include "project.h"
 #include "vstreamdl.h"
 
@@ -34,29 +47,997 @@ namespace fs = std::filesystem;
 
 namespace {
 
-// if url is a relative path, prepend url from m3u
-std::string handleUrl(const std::string& url, const util::Uri& m3uFileUri)
+constexpr long segmentConnectTimeout = 30; // [s]
+constexpr long segmentTimeout = 0;         // [s] no limit, segments may be large
+
+util::HttpRequest segmentRequest(const std::string& url, int64_t rangeOffset, int64_t rangeLength)
 {
-    std::string r = url;
+    util::HttpRequest r(url, ::segmentConnectTimeout, ::segmentTimeout);
+    if (rangeOffset >= 0) r.setRange(rangeOffset, (rangeLength > 0 ? (rangeOffset + rangeLength - 1) : -1));
+    return r;
+}
+
+// AES-128 with the identity key format can be decrypted
+bool isSupportedKey(const m3u::MediaPlaylist::Key& key) { return ((key.method == "AES-128") && (key.keyFormat.empty() || (key.keyFormat == "identity"))); }
+
+void checkKeys(app::MessageCounter& msgCnt, const app::Flags& flags, util::ResultCounter& rcnt, const m3u::MediaPlaylist& playlist,
+               const std::string& playlistUrl)
+{
+    const bool& quiet = flags.quiet;
+
+    for (const auto& key : playlist.keys())
+    {
+        if (!key.isNone() && !::isSupportedKey(key))
+        {
+            rcnt.incWarnings();
+            PRINT_WARNING("###\"" + playlistUrl + "\" uses @" + key.method + "@ encryption, these segments are saved as they are");
+            return;
+        }
+    }
+}
 
-    auto streamUri = util::Uri(url);
+// Appends one request per run of contiguous byte ranges, the init section is inserted wherever the active EXT-X-MAP changes. `mapKey`
+// identifies the last inserted init section, it is kept across the reloads of a live playlist. `keys` gets one element per request.
+void appendSegmentRequests(std::vector<util::HttpRequest>& requests, std::vector<util::SegmentKey>& keys, const m3u::MediaPlaylist& playlist,
+                           const util::Uri& playlistUri, std::string& mapKey)
+{
+    requests.reserve(requests.size() + playlist.rangeRuns().size());
+    keys.reserve(keys.size() + playlist.rangeRuns().size());
 
-    if (streamUri.scheme().empty() && streamUri.authority().empty() && // is relative path
-        !m3uFileUri.scheme().empty() && !m3uFileUri.authority().empty())
+    for (const auto& run : playlist.rangeRuns())
     {
-        const fs::path basePath = enc::path(m3uFileUri.path()).parent_path();
-        const std::string path = basePath.u8string() + '/' + streamUri.path();
+        // encrypted segments are never coalesced, a run is one segment
+        const int keyIdx = playlist.keyIndex(run.first);
+        const m3u::MediaPlaylist::Key* const key = (((keyIdx >= 0) && ::isSupportedKey(playlist.keys()[keyIdx])) ? &playlist.keys()[keyIdx] : nullptr);
+
+        const int map = playlist.mapIndex(run.first);
 
-        streamUri.setScheme(m3uFileUri.scheme());
-        streamUri.setAuthority(m3uFileUri.authority());
-        streamUri.setPath(path);
+        if (map >= 0)
+        {
+            const auto& m = playlist.maps()[map];
+            const std::string id = m.uri + ' ' + std::to_string(m.rangeOffset) + ' ' + std::to_string(m.rangeLength);
+
+            if (id != mapKey)
+            {
+                requests.push_back(::segmentRequest(app::handleUrl(m.uri, playlistUri), m.rangeOffset, m.rangeLength));
+
+                // An init section is encrypted with the key which applies to it (the one of the following segment), its IV is then
+                // required (RFC 8216 4.3.2.5). It has no media sequence number to derive an IV from, without IV it's not encrypted.
+                util::aes_block_t iv;
+                if (key && !key->iv.empty() && util::parseIV(key->iv, iv)) keys.push_back(util::SegmentKey(app::handleUrl(key->uri, playlistUri), iv));
+                else keys.push_back(util::SegmentKey());
+            }
+
+            mapKey = id;
+        }
+        else mapKey.clear();
 
-        r = streamUri.string();
+        requests.push_back(::segmentRequest(app::handleUrl(playlist.uri(run.first), playlistUri), run.offset, run.length));
+
+        if (key)
+        {
+            util::aes_block_t iv;
+            if (key->iv.empty() || !util::parseIV(key->iv, iv)) iv = util::sequenceIV(playlist.sequence(run.first));
+
+            keys.push_back(util::SegmentKey(app::handleUrl(key->uri, playlistUri), iv));
+        }
+        else keys.push_back(util::SegmentKey());
     }
+}
+
+std::vector<util::HttpRequest> getSegmentRequests(app::MessageCounter& msgCnt, const app::Flags& flags, util::ResultCounter& rcnt,
+                                                  const std::string& playlistUrl, std::vector<util::SegmentKey>& keys)
+{
+    const util::Uri playlistUri(playlistUrl);
+    const m3u::MediaPlaylist playlist(app::getStringFromUri(msgCnt, flags, playlistUri));
+
+    ::checkKeys(msgCnt, flags, rcnt, playlist, playlistUrl);
+
+    std::vector<util::HttpRequest> r;
+    std::string mapKey;
+
+    ::appendSegmentRequests(r, keys, playlist, playlistUri, mapKey);
 
     return r;
 }
 
+// records the progress of a track download, see util::DownloadJournal
+fs::path journalFile(const fs::path& outDirPath, const std::string& outName) { return outDirPath / enc::path(outName + ".journal"); }
+
+// true if an interrupted download of NAME can be resumed, the journal of the video track (NAME.journal) or of an audio track
+// (NAME.audio.journal, NAME.audio-<lang or n>.journal, see variantTracks()), not of another name with the same prefix
+bool hasJournal(const fs::path& outDirPath, const std::string& outNameArg)
+{
+    if (!fs::is_directory(outDirPath)) return false;
+
+    const std::string journalExt = ".journal";
+    const std::string audioPrefix = outNameArg + ".audio";
+
+    for (const auto& entry : fs::directory_iterator(outDirPath))
+    {
+        const std::string filename = entry.path().filename().u8string();
+
+        if (filename == (outNameArg + journalExt)) return true;
+
+        if ((filename.length() >= (audioPrefix.length() + journalExt.length())) && (filename.compare(0, audioPrefix.length(), audioPrefix) == 0) &&
+            (filename.compare(filename.length() - journalExt.length(), journalExt.length(), journalExt) == 0))
+        {
+            const std::string suffix = filename.substr(audioPrefix.length(), filename.length() - audioPrefix.length() - journalExt.length());
+            if (suffix.empty() || (suffix[0] == '-')) return true;
+        }
+    }
+
+    return false;
+}
+
+// file extension of the merged segments
+std::string segmentFileExt(const std::string& segmentUrl)
+{
+    std::string ext = omw_::toLower(enc::path(util::Uri(segmentUrl).path()).extension().u8string());
+
+    if ((ext == ".m4s") || (ext == ".cmfv") || (ext == ".cmfa")) ext = ".mp4";
+    else if (ext.empty() || (ext.length() > 5)) ext = ".ts";
+
+    return ext;
+}
+
+// Merges the segment files of a local playlist, the files are copied concurrently to their offsets in the output file.
+void mergeTrack(app::MessageCounter& msgCnt, const app::Flags& flags, util::ResultCounter& rcnt, const std::string& playlistPath,
+                const fs::path& outDirPath, const std::string& outName, size_t jobs)
+{
+    IMPLEMENT_FLAGS();
+
+    const util::Uri playlistUri(playlistPath);
+    const m3u::MediaPlaylist playlist(app::getStringFromUri(msgCnt, flags, playlistUri));
+
+    if (playlist.isEncrypted())
+    {
+        rcnt.incWarnings();
+        PRINT_WARNING("###\"" + playlistPath + "\" is encrypted, the segments are merged as they are");
+    }
+
+    std::vector<util::HttpRequest> requests;
+    std::vector<util::SegmentKey> keys;
+    std::string mapKey;
+    ::appendSegmentRequests(requests, keys, playlist, playlistUri, mapKey);
+
+    if (requests.empty())
+    {
+        rcnt.incWarnings();
+        PRINT_WARNING("###no segments in \"" + playlistPath + "\"");
+        return;
+    }
+
+    std::vector<util::MergeSource> sources;
+    sources.reserve(requests.size());
+
+    for (const auto& req : requests)
+    {
+        const int64_t length = ((req.hasRange() && (req.rangeEnd >= 0)) ? (req.rangeEnd - req.rangeBegin + 1) : -1);
+        sources.emplace_back(enc::path(app::resolveLocal(req.url, playlistUri)), (req.hasRange() ? req.rangeBegin : 0), length);
+    }
+
+    const std::string outFileName = outName + ::segmentFileExt(requests.back().url);
+    const fs::path outFilePath = outDirPath / enc::path(outFileName);
+
+    app::checkOutFile(msgCnt, flags, outFilePath, outFileName, "output file");
+
+    PRINT_INFO_V("###merging " + std::to_string(sources.size()) + " segment files to \"" + outFileName + "\"");
+
+    util::FileMerger merger(jobs);
+    const auto res = merger.merge(sources, outFilePath);
+
+    if (res.good())
+    {
+        PRINT_INFO_V("created file \"" + fs::weakly_canonical(outFilePath).u8string() + "\" (" + std::to_string(res.bytes) + " bytes, " +
+                     util::FileMerger::toString(res.method) + ")");
+    }
+    else
+    {
+        rcnt.incErrors();
+        PRINT_ERROR("###merging \"" + outFileName + "\" failed");
+        PRINT_INFO_V("###" + res.error);
+    }
+}
+
+void downloadTrack(app::MessageCounter& msgCnt, const app::Flags& flags, util::ResultCounter& rcnt, const std::string& playlistUrl,
+                   const fs::path& outDirPath, const std::string& outName, size_t jobs)
+{
+    IMPLEMENT_FLAGS();
+
+    if (!util::Uri(playlistUrl).isUrl())
+    {
+        ::mergeTrack(msgCnt, flags, rcnt, playlistUrl, outDirPath, outName, jobs);
+        return;
+    }
+
+    std::vector<util::SegmentKey> keys;
+    const auto requests = ::getSegmentRequests(msgCnt, flags, rcnt, playlistUrl, keys);
+
+    if (requests.empty())
+    {
+        rcnt.incWarnings();
+        PRINT_WARNING("###no segments in \"" + playlistUrl + "\"");
+        return;
+    }
+
+    const std::string outFileName = outName + ::segmentFileExt(requests.back().url);
+    const fs::path outFilePath = outDirPath / enc::path(outFileName);
+    const fs::path journalFilePath = ::journalFile(outDirPath, outName);
+
+    if (!fs::exists(journalFilePath)) app::checkOutFile(msgCnt, flags, outFilePath, outFileName, "output file");
+
+    PRINT_INFO_V("###downloading " + std::to_string(requests.size()) + " requests to \"" + outFileName + "\"");
+
+    util::SegmentDownloader downloader(app::curl(), jobs, jobs * 4);
+    downloader.setJournal(journalFilePath);
+    downloader.setCache(app::cache());
+    const auto res = downloader.run(requests, keys, outFilePath);
+
+    if (res.resumed > 0) { PRINT_INFO_V("###" + std::to_string(res.resumed) + " requests were already complete"); }
+    if (!res.linked.empty()) { PRINT_INFO_V("###all requests are cached, the file is created by " + res.linked); }
+    else if (res.cached > 0) { PRINT_INFO_V("###" + std::to_string(res.cached) + " requests were served from the cache"); }
+    if (downloader.keyCache().fetched() > 0) { PRINT_INFO_V("###decrypted AES-128 segments, " + std::to_string(downloader.keyCache().fetched()) + " key(s)"); }
+
+    if (res.good()) { PRINT_INFO_V("created file \"" + fs::weakly_canonical(outFilePath).u8string() + "\" (" + std::to_string(res.bytes) + " bytes)"); }
+    else
+    {
+        rcnt.incErrors();
+        PRINT_ERROR("###download of \"" + outFileName + "\" failed");
+        PRINT_INFO_V("###" + res.error);
+    }
+}
+
+class Track
+{
+public:
+    Track(const std::string& playlistUrl_, const std::string& outName_)
+        : playlistUrl(playlistUrl_), outName(outName_)
+    {}
+
+    virtual ~Track() {}
+
+    std::string playlistUrl;
+    std::string outName;
+};
+
+// playlist with all audio renditions and the selected variant, `vstream` has the URI made absolute already
+std::string variantPlaylist(const m3u::HLS& hls, const m3u::HLS::Stream& vstream, const util::Uri& m3uFileUri)
+{
+    std::string txt = "";
+
+#if 0
+    for (size_t i = 0; i < hls.otherEntries().size(); ++i)
+    {
+        txt += hls.otherEntries()[i].serialise();
+        txt += m3u::serialiseEndOfLine;
+    }
+#else
+    txt += m3u::extm3u_str;
+    txt += m3u::serialiseEndOfLine;
+#endif
+
+    txt += m3u::serialiseEndOfLine;
+
+    for (size_t i = 0; i < hls.audioStreams().size(); ++i)
+    {
+        auto astream = hls.audioStreams()[i];
+
+        astream.setUri(app::handleUrl(astream.uri(), m3uFileUri));
+
+        txt += astream.serialise();
+        txt += m3u::serialiseEndOfLine;
+    }
+
+    txt += m3u::serialiseEndOfLine;
+
+    txt += vstream.serialise();
+    txt += m3u::serialiseEndOfLine;
+
+    return txt;
+}
+
+// the selected variant and its audio renditions, all if the variant references no (known) group
+std::vector<::Track> variantTracks(const m3u::HLS& hls, const m3u::HLS::Stream& vstream, const util::Uri& m3uFileUri, const std::string& outName)
+{
+    std::vector<::Track> tracks;
+
+    if (!hls.streams().empty()) tracks.emplace_back(app::resolveLocal(vstream.data(), m3uFileUri), outName);
+
+    std::string audioGroup = (vstream.extParam().contains("AUDIO") ? vstream.extParam().get("AUDIO").value().data() : "");
+    bool groupFound = false;
+    for (const auto& astream : hls.audioStreams())
+    {
+        if (astream.extParam().contains("GROUP-ID") && (astream.extParam().get("GROUP-ID").value() == audioGroup)) groupFound = true;
+    }
+    if (!groupFound) audioGroup.clear();
+
+    std::vector<std::string> audioNames;
+
+    for (const auto& astream : hls.audioStreams())
+    {
+        if (astream.uri().empty()) continue;
+        if (!audioGroup.empty() && (!astream.extParam().contains("GROUP-ID") || (astream.extParam().get("GROUP-ID").value() != audioGroup)))
+        {
+            continue;
+        }
+
+        std::string name = outName + ".audio";
+        if (astream.extParam().contains("LANGUAGE")) name += "-" + astream.extParam().get("LANGUAGE").value().data();
+        if (std::find(audioNames.begin(), audioNames.end(), name) != audioNames.end()) name += "-" + std::to_string(audioNames.size());
+        audioNames.push_back(name);
+
+        tracks.emplace_back(app::resolveLocal(app::handleUrl(astream.uri(), m3uFileUri), m3uFileUri), name);
+    }
+
+    return tracks;
+}
+
+class LiveTrack
+{
+public:
+    LiveTrack(const ::Track& track)
+        : follower(app::curl(), track.playlistUrl),
+          outName(track.outName),
+          outFileName(),
+          outFilePath(),
+          mapKey(),
+          active(true),
+          failures(0),
+          missed(0),
+          segments(0),
+          bytes(0),
+          nextPoll(std::chrono::steady_clock::now())
+    {}
+
+    virtual ~LiveTrack() {}
+
+    util::LiveFollower follower;
+    std::string outName;
+    std::string outFileName; // empty until the first segments are known
+    fs::path outFilePath;
+    std::string mapKey;
+    bool active;
+    size_t failures;
+    int64_t missed;
+    size_t segments;
+    uint64_t bytes;
+    std::chrono::steady_clock::time_point nextPoll;
+};
+
+constexpr size_t liveMaxFailures = 5;
+
+// Follows the live playlists until all have ended (EXT-X-ENDLIST), the new segments of each reload are appended to the track's file.
+void followTracks(app::MessageCounter& msgCnt, const app::Flags& flags, util::ResultCounter& rcnt, const std::vector<::Track>& tracks,
+                  const fs::path& outDirPath, size_t jobs)
+{
+    IMPLEMENT_FLAGS();
+
+    std::vector<::LiveTrack> liveTracks;
+    liveTracks.reserve(tracks.size());
+    for (const auto& track : tracks) liveTracks.emplace_back(track);
+
+    // a blocking reload holds the request until the next segment is available, which would delay the other tracks
+    if (liveTracks.size() > 1)
+    {
+        for (auto& lt : liveTracks) lt.follower.setBlocking(false);
+    }
+
+    util::SegmentDownloader downloader(app::curl(), jobs, jobs * 4);
+
+    while (true)
+    {
+        ::LiveTrack* lt = nullptr;
+
+        for (auto& t : liveTracks)
+        {
+            if (t.active && (!lt || (t.nextPoll < lt->nextPoll))) lt = &t;
+        }
+
+        if (!lt) break;
+
+        std::this_thread::sleep_until(lt->nextPoll);
+
+        if (!lt->follower.poll())
+        {
+            ++(lt->failures);
+
+            if (lt->failures >= ::liveMaxFailures)
+            {
+                rcnt.incErrors();
+                PRINT_ERROR("###reloading \"" + lt->follower.url() + "\" failed");
+                if (verbose) app::printInfo(lt->follower.response().toString());
+                lt->active = false;
+            }
+            else lt->nextPoll = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+
+            continue;
+        }
+
+        lt->failures = 0;
+
+        if (lt->follower.missedSegments() > lt->missed)
+        {
+            rcnt.incWarnings();
+            PRINT_WARNING("###" + std::to_string(lt->follower.missedSegments() - lt->missed) + " segments of \"" + lt->outName +
+                          "\" left the playlist before they were seen");
+            lt->missed = lt->follower.missedSegments();
+        }
+
+        const auto& newSegments = lt->follower.newSegments();
+
+        if (lt->follower.polls() == 1) ::checkKeys(msgCnt, flags, rcnt, newSegments, lt->follower.url());
+
+        std::vector<util::HttpRequest> requests;
+        std::vector<util::SegmentKey> keys;
+        ::appendSegmentRequests(requests, keys, newSegments, util::Uri(lt->follower.url()), lt->mapKey);
+
+        if (!requests.empty())
+        {
+            const bool append = !lt->outFileName.empty();
+
+            if (!append)
+            {
+                lt->outFileName = lt->outName + ::segmentFileExt(requests.back().url);
+                lt->outFilePath = outDirPath / enc::path(lt->outFileName);
+
+                app::checkOutFile(msgCnt, flags, lt->outFilePath, lt->outFileName, "output file");
+                PRINT_INFO_V("###following live playlist to \"" + lt->outFileName + "\"");
+            }
+
+            const auto res = downloader.run(requests, keys, lt->outFilePath, append);
+
+            lt->segments += newSegments.size();
+            lt->bytes += res.bytes;
+
+            if (res.good())
+            {
+                PRINT_INFO_V("###" + lt->outFileName + ": +" + std::to_string(newSegments.size()) + " segments (sequence " +
+                             std::to_string(lt->follower.nextSequence() - 1) + ")");
+            }
+            else
+            {
+                rcnt.incErrors();
+                PRINT_ERROR("###download of \"" + lt->outFileName + "\" failed");
+                PRINT_INFO_V("###" + res.error);
+                lt->active = false;
+                continue;
+            }
+        }
+
+        if (lt->follower.ended())
+        {
+            lt->active = false;
+
+            if (lt->outFileName.empty())
+            {
+                rcnt.incWarnings();
+                PRINT_WARNING("###no segments in \"" + lt->follower.url() + "\"");
+            }
+            else
+            {
+                PRINT_INFO_V("created file \"" + fs::weakly_canonical(lt->outFilePath).u8string() + "\" (" + std::to_string(lt->segments) +
+                             " segments, " + std::to_string(lt->bytes) + " bytes)");
+            }
+        }
+        else
+        {
+            const auto delay = std::chrono::duration<double>(lt->follower.reloadDelay());
+            lt->nextPoll = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay);
+        }
+    }
+}
+
+class SubtitleTrack
+{
+public:
+    SubtitleTrack(const std::string& playlistUrl_, const std::string& outFileName_, const fs::path& outFilePath_)
+        : playlistUrl(playlistUrl_), outFileName(outFileName_), outFilePath(outFilePath_), segments(0), cues(0), error()
+    {}
+
+    virtual ~SubtitleTrack() {}
+
+    std::string playlistUrl;
+    std::string outFileName;
+    fs::path outFilePath;
+
+    size_t segments;
+    size_t cues;
+    std::string error; // empty on success
+};
+
+// Downloads the WebVTT segments of a subtitle playlist and converts them to SRT while they arrive. Runs on a worker thread, the result
+// is reported through `track`.
+void downloadSubtitleTrack(util::Curl& curl, ::SubtitleTrack& track, size_t workers)
+{
+    const util::HttpGetResponse res = app::httpGetPlaylist(track.playlistUrl);
+
+    if (!res.good())
+    {
+        track.error = "\"" + track.playlistUrl + "\": curl " + std::to_string(res.curlCode()) + ", HTTP " + std::to_string(res.httpCode());
+        return;
+    }
+
+    std::ofstream ofs;
+    ofs.exceptions(std::ios::badbit | std::ios::failbit | std::ios::eofbit);
+    ofs.open(track.outFilePath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    util::WebVttToSrt converter(ofs);
+
+    // the URI of a rendition may also reference the WebVTT file itself
+    if (res.data().compare(0, std::string(m3u::extm3u_str).length(), m3u::extm3u_str) != 0)
+    {
+        converter.write(res.data());
+        converter.endSegment();
+        track.segments = 1;
+    }
+    else
+    {
+        const m3u::MediaPlaylist playlist(res.data());
+
+        std::vector<util::HttpRequest> requests;
+        std::vector<util::SegmentKey> keys;
+        std::string mapKey;
+        ::appendSegmentRequests(requests, keys, playlist, util::Uri(track.playlistUrl), mapKey);
+
+        util::SegmentDownloader downloader(curl, workers, workers * 4);
+        downloader.setCache(app::cache());
+        const auto r = downloader.run(requests, keys, [&converter](const std::string& data) {
+            converter.write(data);
+            converter.endSegment();
+        });
+
+        track.segments = r.written;
+        if (!r.good()) track.error = r.error;
+    }
+
+    ofs.close();
+
+    track.cues = converter.cues();
+}
+
+// one file per subtitle rendition, NAME-LANG[-forced].srt
+std::vector<::SubtitleTrack> subtitleTracks(const m3u::HLS& hls, const util::Uri& m3uFileUri, const fs::path& subsDirPath, const std::string& outName)
+{
+    std::vector<::SubtitleTrack> tracks;
+
+    for (const auto& st : hls.subtitles())
+    {
+        if (st.uri().empty()) continue;
+
+        const std::string name = outName + "-" + st.language() + (st.forced() ? "-forced" : "");
+        std::string filename = name + ".srt";
+
+        for (size_t i = 1; std::any_of(tracks.begin(), tracks.end(), [&filename](const ::SubtitleTrack& t) { return (t.outFileName == filename); }); ++i)
+        {
+            filename = name + "-" + std::to_string(i) + ".srt";
+        }
+
+        tracks.emplace_back(app::handleUrl(st.uri(), m3uFileUri), filename, subsDirPath / enc::path(filename));
+    }
+
+    return tracks;
+}
+
+// Downloads all subtitle renditions concurrently to OUTDIR/subs/NAME-LANG[-forced].srt, the `jobs` concurrent transfers are shared by
+// the renditions.
+void downloadSubtitles(app::MessageCounter& msgCnt, const app::Flags& flags, util::ResultCounter& rcnt, const m3u::HLS& hls,
+                       const util::Uri& m3uFileUri, const fs::path& outDirPath, const std::string& outNameArg, size_t jobs, bool resume)
+{
+    IMPLEMENT_FLAGS();
+
+    const fs::path subsDirPath = outDirPath / "subs";
+    fs::create_directories(subsDirPath);
+
+    std::vector<::SubtitleTrack> tracks = ::subtitleTracks(hls, m3uFileUri, subsDirPath, outNameArg);
+
+    // the subtitles of an interrupted download are downloaded again
+    if (!resume)
+    {
+        for (const auto& track : tracks) checkOutFile(msgCnt, flags, track.outFilePath, track.outFileName, "output file");
+    }
+
+    if (tracks.empty()) return;
+
+    PRINT_INFO_V("###downloading " + std::to_string(tracks.size()) + " subtitle tracks");
+
+    util::Curl& curl = app::curl();
+
+    const size_t parallel = std::min(tracks.size(), jobs);
+    const size_t workers = std::max<size_t>(1, jobs / parallel);
+
+    util::WorkerPool pool(parallel);
+
+    for (auto& track : tracks)
+    {
+        ::SubtitleTrack* const t = &track;
+
+        pool.submit([&curl, t, workers]() {
+            try
+            {
+                ::downloadSubtitleTrack(curl, *t, workers);
+            }
+            catch (const std::exception& ex)
+            {
+                t->error = ex.what();
+            }
+        });
+    }
+
+    pool.wait();
+
+    for (const auto& track : tracks)
+    {
+        if (track.error.empty())
+        {
+            PRINT_INFO_V("created file \"" + fs::weakly_canonical(track.outFilePath).u8string() + "\" (" + std::to_string(track.segments) +
+                         " segments, " + std::to_string(track.cues) + " cues)");
+        }
+        else
+        {
+            rcnt.incErrors();
+            PRINT_ERROR("###download of \"subs/" + track.outFileName + "\" failed");
+            PRINT_INFO_V("###" + track.error);
+        }
+    }
+}
+
+class BatchItem
+{
+public:
+    BatchItem(const std::string& url_, const std::string& name_, int maxHeight_)
+        : url(url_), name(name_), maxHeight(maxHeight_), error(), warning(), resolution(), bandwidth(0), tracks(0), segments(0), bytes(0), duration(0)
+    {}
+
+    virtual ~BatchItem() {}
+
+    std::string url;
+    std::string name;
+    int maxHeight;
+
+    std::string error; // empty on success
+    std::string warning;
+    std::string resolution;
+    uint64_t bandwidth;
+    size_t tracks;
+    size_t segments;
+    uint64_t bytes;
+    double duration; // [s]
+};
+
+class BatchOptions
+{
+public:
+    BatchOptions()
+        : outDirPath(), policy(), download(false), subtitles(true), overwrite(false), jobs(1)
+    {}
+
+    virtual ~BatchOptions() {}
+
+    fs::path outDirPath;
+    m3u::VariantIndex::Policy policy;
+    bool download;
+    bool subtitles;
+    bool overwrite;
+    size_t jobs; // concurrent segment downloads per item
+};
+
+// One entry per line: URL NAME [MAX-RES-HEIGHT], empty lines and lines starting with # are ignored.
+bool parseManifest(const std::string& text, int defaultMaxHeight, std::vector<::BatchItem>& items, std::string& error)
+{
+    std::istringstream iss(text);
+    std::string line;
+    size_t lineNo = 0;
+
+    while (std::getline(iss, line))
+    {
+        ++lineNo;
+
+        std::istringstream lineStream(line);
+        std::vector<std::string> tokens;
+        std::string token;
+        while (lineStream >> token) tokens.push_back(token);
+
+        if (tokens.empty() || (tokens[0][0] == '#')) continue;
+
+        const std::string where = "line " + std::to_string(lineNo) + ": ";
+
+        if ((tokens.size() < 2) || (tokens.size() > 3))
+        {
+            error = where + "expected URL NAME [MAX-RES-HEIGHT]";
+            return false;
+        }
+
+        if (!util::Uri(tokens[0]).isUrl())
+        {
+            error = where + "\"" + tokens[0] + "\" is not a URL";
+            return false;
+        }
+
+        if ((tokens.size() == 3) && (!omw::isUInteger(tokens[2]) || (tokens[2].length() > 5)))
+        {
+            error = where + "invalid MAX-RES-HEIGHT";
+            return false;
+        }
+
+        for (const auto& item : items)
+        {
+            if (item.name == tokens[1])
+            {
+                error = where + "duplicate NAME \"" + tokens[1] + "\"";
+                return false;
+            }
+        }
+
+        items.emplace_back(tokens[0], tokens[1], (tokens.size() == 3 ? std::stoi(tokens[2]) : defaultMaxHeight));
+    }
+
+    return true;
+}
+
+// true if the file may be written by a batch item
+bool batchCanWrite(const fs::path& file, const ::BatchOptions& options, bool resume) { return (options.overwrite || resume || !fs::exists(file)); }
+
+// Downloads a track of a batch item, returns an error message or an empty string.
+std::string batchDownloadTrack(util::Curl& curl, const ::Track& track, const ::BatchOptions& options, ::BatchItem& item)
+{
+    const util::HttpGetResponse res = app::httpGetPlaylist(track.playlistUrl);
+    if (!res.good()) return "\"" + track.playlistUrl + "\": curl " + std::to_string(res.curlCode()) + ", HTTP " + std::to_string(res.httpCode());
+
+    const util::Uri playlistUri(track.playlistUrl);
+    const m3u::MediaPlaylist playlist(res.data());
+
+    std::vector<util::HttpRequest> requests;
+    std::vector<util::SegmentKey> keys;
+    std::string mapKey;
+    ::appendSegmentRequests(requests, keys, playlist, playlistUri, mapKey);
+
+    if (requests.empty())
+    {
+        item.warning = "no segments in \"" + track.playlistUrl + "\"";
+        return "";
+    }
+
+    const std::string outFileName = track.outName + ::segmentFileExt(requests.back().url);
+    const fs::path outFilePath = options.outDirPath / enc::path(outFileName);
+    const fs::path journalFilePath = ::journalFile(options.outDirPath, track.outName);
+
+    if (!::batchCanWrite(outFilePath, options, fs::exists(journalFilePath))) return "\"" + outFileName + "\" exists";
+
+    util::SegmentDownloader downloader(curl, options.jobs, options.jobs * 4);
+    downloader.setJournal(journalFilePath);
+    downloader.setCache(app::cache());
+    const auto r = downloader.run(requests, keys, outFilePath);
+
+    ++item.tracks;
+    item.segments += r.written;
+    item.bytes += r.bytes;
+
+    return (r.good() ? "" : ("\"" + outFileName + "\": " + r.error));
+}
+
+// Processes one manifest entry, runs on a worker thread. The result is stored in `item`.
+void processBatchItem(util::Curl& curl, ::BatchItem& item, const ::BatchOptions& options)
+{
+    // the index reuses its storage for all items of the worker
+    thread_local m3u::VariantIndex variants;
+
+    const util::Uri m3uFileUri(item.url);
+
+    const util::HttpGetResponse res = app::httpGetPlaylist(item.url);
+
+    if (!res.good())
+    {
+        item.error = "curl " + std::to_string(res.curlCode()) + ", HTTP " + std::to_string(res.httpCode());
+        return;
+    }
+
+    const m3u::HLS hls(res.data());
+
+    if (hls.streams().empty())
+    {
+        item.error = "no variant streams";
+        return;
+    }
+
+    variants.assign(hls);
+
+    m3u::VariantIndex::Policy policy = options.policy;
+    policy.maxHeight = item.maxHeight;
+
+    int variantIdx = variants.select(policy);
+
+    if (variantIdx < 0)
+    {
+        variantIdx = variants.lowest();
+        item.warning = "no variant matches the selection";
+    }
+
+    auto vstream = hls.streams()[variants.variants()[variantIdx].streamIdx];
+    vstream.setData(app::handleUrl(vstream.data(), m3uFileUri));
+
+    item.resolution = vstream.resolutionExtParam().value().data();
+    item.bandwidth = variants.variants()[variantIdx].bandwidth;
+
+    const fs::path playlistFilePath = options.outDirPath / enc::path(item.name + ".m3u8");
+    const bool resume = ::hasJournal(options.outDirPath, item.name);
+
+    if (!::batchCanWrite(playlistFilePath, options, resume))
+    {
+        item.error = "\"" + item.name + ".m3u8\" exists";
+        return;
+    }
+
+    util::writeFile(playlistFilePath, ::variantPlaylist(hls, vstream, m3uFileUri));
+
+    if (!options.download) return;
+
+    for (const auto& track : ::variantTracks(hls, vstream, m3uFileUri, item.name))
+    {
+        item.error = ::batchDownloadTrack(curl, track, options, item);
+        if (!item.error.empty()) return;
+    }
+
+    if (options.subtitles && !hls.subtitles().empty())
+    {
+        const fs::path subsDirPath = options.outDirPath / "subs";
+        fs::create_directories(subsDirPath);
+
+        for (auto& track : ::subtitleTracks(hls, m3uFileUri, subsDirPath, item.name))
+        {
+            if (!::batchCanWrite(track.outFilePath, options, resume))
+            {
+                item.error = "\"subs/" + track.outFileName + "\" exists";
+                return;
+            }
+
+            ::downloadSubtitleTrack(curl, track, 1);
+
+            if (!track.error.empty())
+            {
+                item.error = "\"subs/" + track.outFileName + "\": " + track.error;
+                return;
+            }
+
+            ++item.tracks;
+            item.segments += track.segments;
+        }
+    }
+}
+
+std::string batchReport(const std::vector<::BatchItem>& items)
+{
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+
+    size_t failed = 0;
+    for (const auto& item : items)
+    {
+        if (!item.error.empty()) ++failed;
+    }
+
+    ss << "{\n  \"items\": " << items.size() << ",\n  \"failed\": " << failed << ",\n  \"results\": [";
+
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        const auto& item = items[i];
+
+        ss << (i == 0 ? "" : ",") << "\n    {";
+        ss << "\n      \"name\": \"" << util::jsonEscape(item.name) << "\",";
+        ss << "\n      \"url\": \"" << util::jsonEscape(item.url) << "\",";
+        ss << "\n      \"ok\": " << (item.error.empty() ? "true" : "false") << ",";
+        ss << "\n      \"error\": \"" << util::jsonEscape(item.error) << "\",";
+        ss << "\n      \"warning\": \"" << util::jsonEscape(item.warning) << "\",";
+        ss << "\n      \"resolution\": \"" << util::jsonEscape(item.resolution) << "\",";
+        ss << "\n      \"bandwidth\": " << item.bandwidth << ",";
+        ss << "\n      \"tracks\": " << item.tracks << ",";
+        ss << "\n      \"segments\": " << item.segments << ",";
+        ss << "\n      \"bytes\": " << item.bytes << ",";
+        ss << "\n      \"duration\": " << item.duration;
+        ss << "\n    }";
+    }
+
+    ss << (items.empty() ? "]" : "\n  ]") << "\n}\n";
+
+    return ss.str();
+}
+
+// Processes the entries of a manifest concurrently with the shared HTTP client. Existing output files are an error of the item unless
+// forced or the item is resumed, there are no prompts.
+int vstreamdlBatch(const app::Args& args, const app::Flags& flags, const m3u::VariantIndex::Policy& policy, size_t jobs)
+{
+    IMPLEMENT_FLAGS();
+
+    app::MessageCounter msgCnt = 0;
+    util::ResultCounter rcnt = 0;
+
+    const std::string manifestArg = args.raw.at(1);
+    const std::string outDirArg = args.raw.at(2);
+    const std::string batchJobsArg = args.optionValue(argstr::batchJobs, "4");
+    const std::string reportArg = args.optionValue(argstr::report, "");
+
+    if (!omw::isUInteger(batchJobsArg) || (batchJobsArg.length() > 4) || (std::stoi(batchJobsArg) < 1)) PRINT_ERROR_EXIT("invalid --batch-jobs value", EC_ERROR);
+
+    ::BatchOptions options;
+    options.outDirPath = enc::path(outDirArg);
+    options.policy = policy;
+    options.download = args.contains(argstr::download);
+    options.subtitles = !args.contains(argstr::noSubs);
+    options.overwrite = flags.force;
+    options.jobs = jobs;
+
+    std::vector<::BatchItem> items;
+    std::string error;
+
+    if (!::parseManifest(app::getStringFromUri(msgCnt, flags, util::Uri(manifestArg)), policy.maxHeight, items, error))
+    {
+        PRINT_ERROR_EXIT("###invalid manifest, " + error, EC_ERROR);
+    }
+
+    fs::create_directories(options.outDirPath);
+
+    PRINT_INFO_V("###processing " + std::to_string(items.size()) + " entries");
+
+    util::Curl& curl = app::curl();
+    std::mutex mtx;
+    size_t completed = 0;
+
+    {
+        util::WorkerPool pool(std::min<size_t>(std::stoul(batchJobsArg), std::max<size_t>(items.size(), 1)));
+
+        for (auto& item : items)
+        {
+            ::BatchItem* const it = &item;
+
+            pool.submit([&, it]() {
+                const auto start = std::chrono::steady_clock::now();
+
+                try
+                {
+                    ::processBatchItem(curl, *it, options);
+                }
+                catch (const std::exception& ex)
+                {
+                    it->error = ex.what();
+                }
+
+                it->duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                std::lock_guard<std::mutex> lg(mtx);
+
+                ++completed;
+                const std::string progress = "[" + std::to_string(completed) + "/" + std::to_string(items.size()) + "] ";
+
+                if (!it->error.empty())
+                {
+                    rcnt.incErrors();
+                    PRINT_ERROR("###" + progress + "@" + it->name + "@: " + it->error);
+                }
+                else
+                {
+                    if (!it->warning.empty())
+                    {
+                        rcnt.incWarnings();
+                        PRINT_WARNING("###" + progress + "@" + it->name + "@: " + it->warning);
+                    }
+
+                    PRINT_INFO_V("###" + progress + "@" + it->name + "@ " + it->resolution + ", " + std::to_string(it->bytes) + " bytes");
+                }
+            });
+        }
+
+        pool.wait();
+    }
+
+    const fs::path reportFilePath = (reportArg.empty() ? (options.outDirPath / "batch-report.json") : enc::path(reportArg));
+    util::writeFile(reportFilePath, ::batchReport(items));
+    PRINT_INFO_V("created file \"" + fs::weakly_canonical(reportFilePath).u8string() + "\"");
+
+    PRINT_INFO("###" + std::to_string(items.size() - rcnt.errors()) + " of " + std::to_string(items.size()) + " entries succeeded");
+
+    return (rcnt.errors() == 0 ? EC_OK : EC_ERROR);
+}
+
 } // namespace
 
 
@@ -70,14 +1051,25 @@ int app::vstreamdl(const app::Args& args, const app::Flags& flags)
     MessageCounter msgCnt = 0;
     util::ResultCounter rcnt = 0;
 
+    const bool batchArg = args.contains(argstr::batch);
+
     // TODO make nicer
     const std::string m3uFileArg = args.raw.at(1);
     const std::string outDirArg = args.raw.at(2);
-    const std::string outNameArg = args.raw.at(3);
-    const std::string maxResHArg = ((args.raw.size() > 4) && !args.isOption(4) ? args.raw.at(4) : "1080");
+    const size_t maxResHIdx = (batchArg ? 3 : 4); // the names of a batch are in the manifest
+    const std::string outNameArg = (batchArg ? "" : args.raw.at(3));
+    const std::string maxResHArg = ((args.raw.size() > maxResHIdx) && !args.isOption(maxResHIdx) ? args.raw.at(maxResHIdx) : "1080");
 
-    const bool noSubsArg = args.contains("--no-subs");
-    const bool saveOrigArg = args.contains("--save-original");
+    const bool noSubsArg = args.contains(argstr::noSubs);
+    const bool saveOrigArg = args.contains(argstr::saveOriginal);
+    const bool downloadArg = args.contains(argstr::download);
+    const bool liveArg = args.contains(argstr::live);
+    const std::string jobsArg = args.optionValue(argstr::jobs, "8");
+    const std::string maxBandwidthArg = args.optionValue(argstr::maxBandwidth, "0");
+    const std::string maxFpsArg = args.optionValue(argstr::maxFps, "0");
+    const std::string codecsArg = args.optionValue(argstr::codecs, "");
+    const std::string audioGroupArg = args.optionValue(argstr::audioGroup, "");
+    const bool hdrArg = args.contains(argstr::hdr);
 
     const util::Uri m3uFileUri = util::Uri(m3uFileArg);
     const fs::path outDirPath = enc::path(outDirArg);
@@ -85,6 +1077,28 @@ int app::vstreamdl(const app::Args& args, const app::Flags& flags)
     if (!omw::isUInteger(maxResHArg)) ERROR_PRINT_EC_THROWLINE("invalid MAX-RES-HEIGHT", EC_ERROR);
     const int maxResHeight = std::stoi(maxResHArg);
 
+    if (!omw::isUInteger(jobsArg) || (jobsArg.length() > 4) || (std::stoi(jobsArg) < 1)) ERROR_PRINT_EC_THROWLINE("invalid --jobs value", EC_ERROR);
+    const size_t jobs = std::stoul(jobsArg);
+
+    m3u::VariantIndex::Policy policy;
+    policy.maxHeight = maxResHeight;
+    policy.preferHdr = hdrArg;
+    policy.audioGroup = audioGroupArg;
+
+    if (!omw::isUInteger(maxBandwidthArg) || (maxBandwidthArg.length() > 15)) ERROR_PRINT_EC_THROWLINE("invalid --max-bandwidth value", EC_ERROR);
+    policy.maxBandwidth = std::stoull(maxBandwidthArg);
+
+    if (!omw::isUInteger(maxFpsArg) || (maxFpsArg.length() > 4)) ERROR_PRINT_EC_THROWLINE("invalid --max-fps value", EC_ERROR);
+    policy.maxFrameRate = std::stod(maxFpsArg);
+
+    if (!codecsArg.empty() && !m3u::VariantIndex::parseCodecs(codecsArg, policy.codecs)) ERROR_PRINT_EC_THROWLINE("invalid --codecs value", EC_ERROR);
+
+    if (batchArg)
+    {
+        if (liveArg) ERROR_PRINT_EC_THROWLINE("--live can't be used with --batch", EC_ERROR);
+        return ::vstreamdlBatch(args, flags, policy, jobs);
+    }
+
 #if defined(PRJ_DEBUG) && 0
     app::dbg_rm_outDir(outDirPath);
 #endif
@@ -101,7 +1115,11 @@ int app::vstreamdl(const app::Args& args, const app::Flags& flags)
     // check/create out dir
     ///////////////////////////////////////////////////////////
 
-    app::checkCreateOutDir(msgCnt, flags, outDirPath, outDirArg);
+    // an interrupted download is resumed in the same OUTDIR
+    const bool resume = (downloadArg && !liveArg && ::hasJournal(outDirPath, outNameArg));
+
+    if (resume) { PRINT_INFO_V("###resuming the interrupted download of \"" + outNameArg + "\""); }
+    else app::checkCreateOutDir(msgCnt, flags, outDirPath, outDirArg);
 
 
     ///////////////////////////////////////////////////////////
@@ -128,70 +1146,55 @@ int app::vstreamdl(const app::Args& args, const app::Flags& flags)
     if (!hasAudio && !hasVideo && !hasSubtitles) ERROR_PRINT_EC_THROWLINE("empty stream", EC_STREAM_EMPTY);
 
     if (!hasAudio && hasVideo) WARNING_PRINT("no audio");
-    if (hasAudio && !hasVideo) WARNING_PRINT("no video");
-    if (hasAudio || hasVideo)
-    {
-        std::string txt = "";
-
-#if 0
-        for (size_t i = 0; i < hls.otherEntries().size(); ++i)
-        {
-            txt += hls.otherEntries()[i].serialise();
-            txt += m3u::serialiseEndOfLine;
-        }
-#else
-        txt += m3u::extm3u_str;
-        txt += m3u::serialiseEndOfLine;
-#endif
-
-        txt += m3u::serialiseEndOfLine;
 
-        for (size_t i = 0; i < hls.audioStreams().size(); ++i)
-        {
-            auto astream = hls.audioStreams()[i];
-
-            astream.setUri(::handleUrl(astream.uri(), m3uFileUri));
-
-            txt += astream.serialise();
-            txt += m3u::serialiseEndOfLine;
-        }
-
-        txt += m3u::serialiseEndOfLine;
+    // the audio renditions are only reachable through a variant stream, there is nothing to select without one
+    if (hasAudio && !hasVideo) { ERROR_PRINT("no video, audio only master playlists are not supported"); }
+    else if (hasVideo)
+    {
+        const m3u::VariantIndex variants(hls);
+        int variantIdx = variants.select(policy);
 
-        size_t streamIdx = 0;
-        for (size_t i = 1; i < hls.streams().size(); ++i)
+        // no variant satisfies the policy, the index is not empty as there are variant streams
+        if (variantIdx < 0)
         {
-            const int h = hls.streams()[i].resolutionHeight();
+            variantIdx = variants.lowest();
 
-            if ((h > hls.streams()[streamIdx].resolutionHeight()) && (h <= maxResHeight)) streamIdx = i;
-        }
-        auto vstream = hls.streams()[streamIdx];
-
-        // no stream found with resolution <= maxResHeight
-        if (vstream.resolutionHeight() > maxResHeight)
-        {
             // TODO improve with force and verbosity flags
-            WARNING_PRINT("stream resolution: " + vstream.resolutionExtParam().value().data());
+            WARNING_PRINT("no variant matches the selection, stream resolution: " +
+                          hls.streams()[variants.variants()[variantIdx].streamIdx].resolutionExtParam().value().data());
         }
 
-        vstream.setData(::handleUrl(vstream.data(), m3uFileUri));
+        auto vstream = hls.streams()[variants.variants()[variantIdx].streamIdx];
 
-        txt += vstream.serialise();
-        txt += m3u::serialiseEndOfLine;
+        vstream.setData(app::handleUrl(vstream.data(), m3uFileUri));
 
         const std::string outFileName = outNameArg + ".m3u8";
         const fs::path outFilePath = outDirPath / enc::path(outFileName);
 
-        checkOutFile(msgCnt, flags, outFilePath, outFileName, "output file");
+        // the playlist of an interrupted download is written again
+        if (!resume) checkOutFile(msgCnt, flags, outFilePath, outFileName, "output file");
 
-        util::writeFile(outFilePath, txt);
+        util::writeFile(outFilePath, ::variantPlaylist(hls, vstream, m3uFileUri));
         PRINT_INFO_V("created file \"" + fs::weakly_canonical(outFilePath).u8string() + "\"");
+
+        if (downloadArg)
+        {
+            const std::vector<::Track> tracks = ::variantTracks(hls, vstream, m3uFileUri, outNameArg);
+
+            if (liveArg) ::followTracks(msgCnt, flags, rcnt, tracks, outDirPath, jobs);
+            else
+            {
+                for (const auto& track : tracks) ::downloadTrack(msgCnt, flags, rcnt, track.playlistUrl, outDirPath, track.outName, jobs);
+            }
+        }
     }
     else WARNING_PRINT("no audio and no video");
 
     if (!noSubsArg)
     {
-        if (hasSubtitles)
+        // a live subtitle playlist is followed by ffmpeg
+        if (hasSubtitles && downloadArg && !liveArg) ::downloadSubtitles(msgCnt, flags, rcnt, hls, m3uFileUri, outDirPath, outNameArg, jobs, resume);
+        else if (hasSubtitles)
         {
             std::string srtScript = "";
             srtScript += "# generated with " + std::string(prj::appName) + " " + std::string(prj::website) + "\n";
@@ -206,7 +1209,7 @@ int app::vstreamdl(const app::Args& args, const app::Flags& flags)
                 {
                     const std::string filename = "./subs/" + outNameArg + "-" + st.language() + (st.forced() ? "-forced" : "") + ".srt";
 
-                    srtScript += "ffmpeg -i \"" + ::handleUrl(st.uri(), m3uFileUri) + "\" -scodec srt -loglevel warning \"" + filename + "\"\n";
+                    srtScript += "ffmpeg -i \"" + app::handleUrl(st.uri(), m3uFileUri) + "\" -scodec srt -loglevel warning \"" + filename + "\"\n";
                     srtScript += "echo $?\n";
                 }
             }
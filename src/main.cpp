@@ -32,22 +32,59 @@ const std::string usageString = std::string(prj::exeName) + " MODULE ...";
 
 void printHelp()
 {
-    constexpr int lw = 18;
+    constexpr int lw = 24;
 
     // clang-format off
     cout << prj::appName << endl;
     cout << endl;
     cout << "Usage:" << endl;
     cout << "  " << usageString << endl;
+    cout << "  " << prj::exeName << " check INFILE [options]" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --get             request the first byte with GET instead of HEAD" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --jobs=N          number of concurrent requests (default 32)" << endl;
     cout << "  " << prj::exeName << " export INFILE OUTDIR [options]" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --jobs=N          number of concurrent copies (default 1)" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --link[=FB]       create hard links instead of copies, FB is the fallback per file" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "                       if a file can't be linked: copy (default) or symlink" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --sync[=CMP]      update a previous export, only new or changed files are copied" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "                       CMP: stat (size and mtime, default) or hash (also the content)" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --dedup[=CMP]     export repeated files once and link the other names to it" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "                       CMP: inode (same device and inode, also hard links of a file, default)" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "                       or hash (also different files with the same content)" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --archive[=FMT]   write OUTDIR as a tar (default) or uncompressed zip archive file" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "                       instead of a directory, - writes to stdout (e.g. | zstd > out.tar.zst)" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --checksum        verify the copies and write their XXH64 to OUTDIR/XXH64SUMS" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --io-uring        copy with io_uring (Linux 5.6 or later), --jobs is the number of" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "                       files in flight (default 64)" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --dry-run         print the files and bytes to export, the free space and a duration" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "                       estimated from a read sample of the inputs, nothing is written" << endl;
     cout << "  " << prj::exeName << " parse INFILE [options]" << endl;
     cout << "  " << prj::exeName << " path INFILE OUTFILE [INBASEPATH [OUTBASEPATH]] [options]" << endl;
+    cout << "  " << prj::exeName << " verify CHECKSUMFILE|OUTDIR [options]" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --jobs=N          number of files verified concurrently (default 4)" << endl;
     cout << "  " << prj::exeName << " vstreamdl INFILE OUTDIR NAME [MAX-RES-HEIGHT] [options]" << endl;
     cout << "  " << std::string(strlen(prj::exeName), ' ') << "     MAX-RES-HEIGHT defaults to 1080" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --download        download the segments of the selected streams" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "                       an interrupted download is resumed by running it again" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "                       and converts the subtitles to SRT (otherwise an ffmpeg script is created)" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "                       the segment files of a local INFILE are merged" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --jobs=N          number of concurrent segment downloads (default 8)" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --live            follow live playlists until they end (with --download)" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --max-bandwidth=N highest variant BANDWIDTH in bit/s" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --max-fps=N       highest variant FRAME-RATE" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --codecs=LIST     allowed video codecs, e.g. avc,hevc,av1" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --hdr             prefer HDR variants (PQ, HLG, Dolby Vision)" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --audio-group=ID  select a variant of the audio GROUP-ID" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --batch           INFILE is a manifest with \"URL NAME [MAX-RES-HEIGHT]\" lines (NAME and" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "                       MAX-RES-HEIGHT are not passed as arguments)" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --batch-jobs=N    number of concurrently processed entries (default 4)" << endl;
+    cout << "  " << std::string(strlen(prj::exeName), ' ') << "     --report=FILE     batch report as JSON (default OUTDIR/batch-report.json)" << endl;
     cout << endl;
     cout << "Modules:" << endl;
+    cout << std::left << setw(lw) << std::string("  ") + "check" << "check that the variant streams and renditions of a master playlist are available" << endl;
     cout << std::left << setw(lw) << std::string("  ") + "export" << "copy and rename the files of the playlist" << endl;
     cout << std::left << setw(lw) << std::string("  ") + "parse" << "display the m3u entries" << endl;
+    cout << std::left << setw(lw) << std::string("  ") + "verify" << "verify exported files with the checksums written by export --checksum" << endl;
     cout << std::left << setw(lw) << std::string("  ") + "vstreamdl" << "" << endl;
     cout << std::left << setw(lw) << std::string("  ") << omw::fgCyan << "tbd..." << omw::fgDefault << endl;
     cout << endl;
@@ -56,6 +93,17 @@ void printHelp()
     cout << std::left << setw(lw) << std::string("  ") + argstr::quiet << "quiet" << endl;
     cout << std::left << setw(lw) << std::string("  ") + argstr::verbose << "verbose" << endl;
     cout << std::left << setw(lw) << std::string("  ") + argstr::noColor << "monochrome console output" << endl;
+    cout << std::left << setw(lw) << std::string("  ") + argstr::httpStats + "=FILE" << "write the HTTP timing report as JSON to FILE" << endl;
+    cout << std::left << setw(lw) << std::string("  ") + argstr::maxConn + "=N" << "max number of concurrent HTTP transfers" << endl;
+    cout << std::left << setw(lw) << std::string("  ") + argstr::maxHostConn + "=N" << "max number of concurrent HTTP transfers per host" << endl;
+    cout << std::left << setw(lw) << std::string("  ") + argstr::rateLimit + "=BYTES" << "download bandwidth limit per second (suffix k, M, G)" << endl;
+    cout << std::left << setw(lw) << std::string("  ") + argstr::adaptive << "adapt the HTTP concurrency to the observed latency, transport and server errors" << endl;
+    cout << std::left << setw(lw) << std::string("  ") + argstr::httpRecord + "=DIR" << "save all HTTP responses to the archive DIR" << endl;
+    cout << std::left << setw(lw) << std::string("  ") + argstr::httpReplay + "=DIR" << "serve all HTTP requests from the archive DIR" << endl;
+    cout << std::left << setw(lw) << std::string("  ") + argstr::replayLatency + "=MS" << "simulated latency on replay, defaults to the recorded one" << endl;
+    cout << std::left << setw(lw) << std::string("  ") + argstr::replayRate + "=BYTES" << "simulated bandwidth per transfer on replay" << endl;
+    cout << std::left << setw(lw) << std::string("  ") + argstr::cache + "[=DIR]" << "cache downloaded segments and playlists in DIR (default ~/.cache/m3u-tool)" << endl;
+    cout << std::left << setw(lw) << std::string("  ") + argstr::cacheSize + "=BYTES" << "size limit of the cache (default 2G), least recently used files are removed" << endl;
     cout << std::left << setw(lw) << std::string("  ") + argstr::help + std::string(", ") + argstr::help_alt << "prints this help text" << endl;
     cout << std::left << setw(lw) << std::string("  ") + argstr::version << "prints version info" << endl;
     cout << std::left << setw(lw) << std::string("  ") << omw::fgCyan << "tbd..." << omw::fgDefault << endl;
@@ -253,6 +301,10 @@ int main(int argc, char** argv)
     bool winOutCodePageRes = omw::windows::consoleSetOutCodePage(65001);
 #endif
 
+    // `export INFILE - --archive` writes the archive to stdout, the messages go to stderr
+    std::streambuf* const coutBuffer = cout.rdbuf();
+    if ((args.files().size() > 2) && (args.files().at(0) == "export") && (args.files().at(2) == "-")) cout.rdbuf(std::cerr.rdbuf());
+
 #ifndef PRJ_DEBUG
     if (prj::version.isPreRelease()) cout << omw::fgBrightMagenta << "pre-release v" << prj::version.toString() << omw::defaultForeColor << endl;
 #endif
@@ -302,6 +354,7 @@ int main(int argc, char** argv)
 #endif
 
     cout << omw::normal << std::flush;
+    cout.rdbuf(coutBuffer);
 
 #ifdef OMW_PLAT_WIN
     winOutCodePageRes = omw::windows::consoleSetOutCodePage(winOutCodePage);
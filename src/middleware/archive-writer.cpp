@@ -0,0 +1,391 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "archive-writer.h"
+#include "hash.h"
+
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t bufferSize = 4 * 1024 * 1024;
+constexpr size_t tarBlockSize = 512;
+constexpr size_t tarRecordSize = 20 * tarBlockSize; // the archive is padded to the default blocking factor of tar
+constexpr uint64_t tarMaxSize = 077777777777ull;    // 11 octal digits
+constexpr uint32_t zipMax32 = 0xFFFFFFFFu;
+constexpr uint16_t zipMax16 = 0xFFFF;
+
+std::string errorStr(const fs::path& file, const std::string& what) { return "\"" + file.u8string() + "\": " + what; }
+
+std::time_t modificationTime(const fs::path& file)
+{
+    const auto ftime = fs::last_write_time(file);
+    const auto offset = std::chrono::duration_cast<std::chrono::system_clock::duration>(ftime - fs::file_time_type::clock::now());
+    return std::chrono::system_clock::to_time_t(std::chrono::system_clock::now() + offset);
+}
+
+// zero padded octal number with a terminating NUL
+void putOctal(char* field, size_t width, uint64_t value)
+{
+    for (size_t i = width - 1; i > 0; --i)
+    {
+        field[i - 1] = (char)('0' + (value & 07));
+        value >>= 3;
+    }
+
+    field[width - 1] = 0;
+}
+
+// "<length> <key>=<value>\n", the length includes itself
+std::string paxRecord(const std::string& key, const std::string& value)
+{
+    const size_t n = key.length() + value.length() + 3;
+    size_t length = n + 1;
+
+    while (std::to_string(length).length() + n != length) ++length;
+
+    return std::to_string(length) + ' ' + key + '=' + value + '\n';
+}
+
+class LittleEndian
+{
+public:
+    LittleEndian()
+        : data()
+    {}
+
+    virtual ~LittleEndian() {}
+
+    void u16(uint16_t value)
+    {
+        for (int i = 0; i < 2; ++i) data.push_back((char)((value >> (8 * i)) & 0xFF));
+    }
+
+    void u32(uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i) data.push_back((char)((value >> (8 * i)) & 0xFF));
+    }
+
+    void u64(uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i) data.push_back((char)((value >> (8 * i)) & 0xFF));
+    }
+
+    void str(const std::string& value) { data += value; }
+
+    std::string data;
+};
+
+void dosDateTime(std::time_t t, uint16_t& dosTime, uint16_t& dosDate)
+{
+    std::tm tm {};
+
+#ifdef _WIN32
+    localtime_s(&tm, &t);
+#else
+    localtime_r(&t, &tm);
+#endif
+
+    // the format starts at 1980
+    if (tm.tm_year < 80)
+    {
+        tm.tm_year = 80;
+        tm.tm_mon = 0;
+        tm.tm_mday = 1;
+        tm.tm_hour = 0;
+        tm.tm_min = 0;
+        tm.tm_sec = 0;
+    }
+
+    dosTime = (uint16_t)((tm.tm_hour << 11) | (tm.tm_min << 5) | (tm.tm_sec / 2));
+    dosDate = (uint16_t)(((tm.tm_year - 80) << 9) | ((tm.tm_mon + 1) << 5) | tm.tm_mday);
+}
+
+} // namespace
+
+
+
+util::ArchiveWriter::ArchiveWriter(util::ArchiveWriter::Format format, std::FILE* stream)
+    : m_format(format), m_stream(stream), m_offset(0), m_buffer(), m_zipEntries()
+{}
+
+void util::ArchiveWriter::addFile(const std::string& name, const std::filesystem::path& file)
+{
+    const uint64_t size = fs::file_size(file);
+    const std::time_t mtime = ::modificationTime(file);
+
+    if (m_format == Format::tar) m_tarFile(name, file, size, mtime);
+    else m_zipFile(name, file, size, mtime);
+}
+
+bool util::ArchiveWriter::addLink(const std::string& name, const std::string& target)
+{
+    if (m_format != Format::tar) return false;
+
+    m_tarHeader(name, '1', 0, std::time(nullptr), target);
+
+    return true;
+}
+
+void util::ArchiveWriter::finish()
+{
+    if (m_format == Format::tar)
+    {
+        // two zero blocks, then up to the end of the record
+        m_pad(2 * ::tarBlockSize);
+        m_pad((::tarRecordSize - (m_offset % ::tarRecordSize)) % ::tarRecordSize);
+    }
+    else
+    {
+        const uint64_t cdOffset = m_offset;
+
+        for (const auto& entry : m_zipEntries)
+        {
+            const bool zip64Size = (entry.size >= ::zipMax32);
+            const bool zip64Offset = (entry.offset >= ::zipMax32);
+
+            ::LittleEndian extra;
+
+            if (zip64Size || zip64Offset)
+            {
+                extra.u16(0x0001);
+                extra.u16((uint16_t)((zip64Size ? 16 : 0) + (zip64Offset ? 8 : 0)));
+
+                if (zip64Size)
+                {
+                    extra.u64(entry.size);
+                    extra.u64(entry.size);
+                }
+
+                if (zip64Offset) extra.u64(entry.offset);
+            }
+
+            // version needed to extract is 4.5 if there is a zip64 extra, also one with only the offset
+            ::LittleEndian h;
+            h.u32(0x02014b50);
+            h.u16((3 << 8) | 45); // made by UNIX, version 4.5
+            h.u16((zip64Size || zip64Offset) ? 45 : 20);
+            h.u16((1 << 3) | (1 << 11)); // data descriptor, UTF-8 name
+            h.u16(0);                    // stored
+            h.u16(entry.dosTime);
+            h.u16(entry.dosDate);
+            h.u32(entry.crc);
+            h.u32(zip64Size ? ::zipMax32 : (uint32_t)entry.size);
+            h.u32(zip64Size ? ::zipMax32 : (uint32_t)entry.size);
+            h.u16((uint16_t)entry.name.length());
+            h.u16((uint16_t)extra.data.length());
+            h.u16(0); // comment
+            h.u16(0); // disk
+            h.u16(0); // internal attributes
+            h.u32(0100644u << 16);
+            h.u32(zip64Offset ? ::zipMax32 : (uint32_t)entry.offset);
+            h.str(entry.name);
+            h.str(extra.data);
+
+            m_write(h.data.data(), h.data.size());
+        }
+
+        const uint64_t cdSize = m_offset - cdOffset;
+        const uint64_t entries = m_zipEntries.size();
+
+        ::LittleEndian end;
+
+        if ((entries >= ::zipMax16) || (cdSize >= ::zipMax32) || (cdOffset >= ::zipMax32))
+        {
+            const uint64_t zip64EndOffset = m_offset;
+
+            end.u32(0x06064b50);
+            end.u64(44); // size of the remaining record
+            end.u16((3 << 8) | 45);
+            end.u16(45);
+            end.u32(0);
+            end.u32(0);
+            end.u64(entries);
+            end.u64(entries);
+            end.u64(cdSize);
+            end.u64(cdOffset);
+
+            end.u32(0x07064b50);
+            end.u32(0);
+            end.u64(zip64EndOffset);
+            end.u32(1);
+        }
+
+        end.u32(0x06054b50);
+        end.u16(0);
+        end.u16(0);
+        end.u16((uint16_t)std::min<uint64_t>(entries, ::zipMax16));
+        end.u16((uint16_t)std::min<uint64_t>(entries, ::zipMax16));
+        end.u32((uint32_t)std::min<uint64_t>(cdSize, ::zipMax32));
+        end.u32((uint32_t)std::min<uint64_t>(cdOffset, ::zipMax32));
+        end.u16(0); // comment
+
+        m_write(end.data.data(), end.data.size());
+    }
+
+    if (std::fflush(m_stream) != 0) throw std::runtime_error("failed to write the archive");
+}
+
+void util::ArchiveWriter::m_write(const void* data, size_t size)
+{
+    if (std::fwrite(data, 1, size, m_stream) != size) throw std::runtime_error("failed to write the archive");
+    m_offset += size;
+}
+
+void util::ArchiveWriter::m_pad(size_t size)
+{
+    static const char zeros[::tarBlockSize] = { 0 };
+
+    while (size > 0)
+    {
+        const size_t n = std::min(size, sizeof(zeros));
+        m_write(zeros, n);
+        size -= n;
+    }
+}
+
+void util::ArchiveWriter::m_tarHeader(const std::string& name, char type, uint64_t size, std::time_t mtime, const std::string& linkName)
+{
+    // the ustar fields are too small, a pax header precedes the entry
+    std::string pax;
+    if (name.length() > 100) pax += ::paxRecord("path", name);
+    if (linkName.length() > 100) pax += ::paxRecord("linkpath", linkName);
+    if (size > ::tarMaxSize) pax += ::paxRecord("size", std::to_string(size));
+
+    if (!pax.empty())
+    {
+        m_tarHeader("PaxHeaders/" + name.substr(0, 89), 'x', pax.length(), mtime, std::string());
+        m_write(pax.data(), pax.length());
+        m_pad((::tarBlockSize - (pax.length() % ::tarBlockSize)) % ::tarBlockSize);
+    }
+
+    char h[::tarBlockSize];
+    std::memset(h, 0, sizeof(h));
+
+    std::memcpy(h + 0, name.data(), std::min<size_t>(name.length(), 100));
+    ::putOctal(h + 100, 8, 0644);
+    ::putOctal(h + 108, 8, 0);
+    ::putOctal(h + 116, 8, 0);
+    ::putOctal(h + 124, 12, std::min(size, ::tarMaxSize));
+    ::putOctal(h + 136, 12, (uint64_t)std::max<std::time_t>(mtime, 0));
+    h[156] = type;
+    std::memcpy(h + 157, linkName.data(), std::min<size_t>(linkName.length(), 100));
+    std::memcpy(h + 257, "ustar", 6);
+    std::memcpy(h + 263, "00", 2);
+
+    // computed with the checksum field filled with spaces
+    std::memset(h + 148, ' ', 8);
+    uint32_t checksum = 0;
+    for (const char c : h) checksum += (uint8_t)c;
+    ::putOctal(h + 148, 7, checksum);
+
+    m_write(h, sizeof(h));
+}
+
+void util::ArchiveWriter::m_tarFile(const std::string& name, const std::filesystem::path& file, uint64_t size, std::time_t mtime)
+{
+    m_tarHeader(name, '0', size, mtime, std::string());
+    m_copy(file, size, false);
+    m_pad((size_t)((::tarBlockSize - (size % ::tarBlockSize)) % ::tarBlockSize));
+}
+
+void util::ArchiveWriter::m_zipFile(const std::string& name, const std::filesystem::path& file, uint64_t size, std::time_t mtime)
+{
+    if (name.length() > ::zipMax16) throw std::runtime_error("the name \"" + name + "\" is too long");
+
+    ZipEntry entry;
+    entry.name = name;
+    entry.size = size;
+    entry.offset = m_offset;
+    ::dosDateTime(mtime, entry.dosTime, entry.dosDate);
+
+    const bool zip64 = (size >= ::zipMax32);
+
+    // CRC and sizes follow in the data descriptor
+    ::LittleEndian h;
+    h.u32(0x04034b50);
+    h.u16(zip64 ? 45 : 20);
+    h.u16((1 << 3) | (1 << 11));
+    h.u16(0);
+    h.u16(entry.dosTime);
+    h.u16(entry.dosDate);
+    h.u32(0);
+    h.u32(zip64 ? ::zipMax32 : 0);
+    h.u32(zip64 ? ::zipMax32 : 0);
+    h.u16((uint16_t)name.length());
+    h.u16(zip64 ? 20 : 0);
+    h.str(name);
+
+    if (zip64)
+    {
+        h.u16(0x0001);
+        h.u16(16);
+        h.u64(0);
+        h.u64(0);
+    }
+
+    m_write(h.data.data(), h.data.size());
+
+    entry.crc = m_copy(file, size, true);
+
+    ::LittleEndian dd;
+    dd.u32(0x08074b50);
+    dd.u32(entry.crc);
+
+    if (zip64)
+    {
+        dd.u64(size);
+        dd.u64(size);
+    }
+    else
+    {
+        dd.u32((uint32_t)size);
+        dd.u32((uint32_t)size);
+    }
+
+    m_write(dd.data.data(), dd.data.size());
+
+    m_zipEntries.push_back(entry);
+}
+
+uint32_t util::ArchiveWriter::m_copy(const std::filesystem::path& file, uint64_t size, bool crc)
+{
+    std::ifstream ifs(file, std::ios::in | std::ios::binary);
+    if (!ifs.good()) throw std::runtime_error(::errorStr(file, "failed to open"));
+
+    if (m_buffer.empty()) m_buffer.resize(::bufferSize);
+
+    uint32_t r = 0;
+
+    while (size > 0)
+    {
+        const size_t n = (size_t)std::min<uint64_t>(size, m_buffer.size());
+
+        // the size is already written to the header
+        if (!ifs.read(m_buffer.data(), (std::streamsize)n)) throw std::runtime_error(::errorStr(file, "file changed while reading"));
+
+        if (crc) r = util::crc32(m_buffer.data(), n, r);
+        m_write(m_buffer.data(), n);
+
+        size -= n;
+    }
+
+    return r;
+}
@@ -0,0 +1,96 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_ARCHIVEWRITER_H
+#define IG_MIDDLEWARE_ARCHIVEWRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace util {
+
+// Writes a tar (POSIX pax) or an uncompressed zip archive sequentially to a stream, which doesn't have to be seekable (e.g. stdout). The
+// files are read once with large sequential reads. Zip entries have a data descriptor after the data, because the CRC is known only
+// after reading the file, Zip64 records are added if needed.
+//
+// Errors are thrown as std::runtime_error, the archive is incomplete then.
+class ArchiveWriter
+{
+public:
+    enum class Format
+    {
+        tar,
+        zip,
+    };
+
+public:
+    ArchiveWriter() = delete;
+    ArchiveWriter(util::ArchiveWriter::Format format, std::FILE* stream); // `stream` has to be opened in binary mode and is not closed
+    virtual ~ArchiveWriter() {}
+
+    util::ArchiveWriter::Format format() const { return m_format; }
+
+    // adds the content of `file` as `name`
+    void addFile(const std::string& name, const std::filesystem::path& file);
+
+    // Adds `name` as a hard link to the previously added `target`, returns false if the format doesn't support links (zip).
+    bool addLink(const std::string& name, const std::string& target);
+
+    // writes the end of the archive and flushes the stream
+    void finish();
+
+    // written to the stream
+    uint64_t bytes() const { return m_offset; }
+
+private:
+    class ZipEntry
+    {
+    public:
+        ZipEntry()
+            : name(), crc(0), size(0), offset(0), dosTime(0), dosDate(0)
+        {}
+
+        virtual ~ZipEntry() {}
+
+        std::string name;
+        uint32_t crc;
+        uint64_t size;
+        uint64_t offset; // of the local header
+        uint16_t dosTime;
+        uint16_t dosDate;
+    };
+
+private:
+    util::ArchiveWriter::Format m_format;
+    std::FILE* m_stream;
+    uint64_t m_offset;
+    std::vector<char> m_buffer;
+    std::vector<util::ArchiveWriter::ZipEntry> m_zipEntries;
+
+    void m_write(const void* data, size_t size);
+    void m_pad(size_t size);
+
+    void m_tarHeader(const std::string& name, char type, uint64_t size, std::time_t mtime, const std::string& linkName);
+    void m_tarFile(const std::string& name, const std::filesystem::path& file, uint64_t size, std::time_t mtime);
+    void m_zipFile(const std::string& name, const std::filesystem::path& file, uint64_t size, std::time_t mtime);
+
+    // copies `size` bytes of `file` to the stream, returns the CRC-32 if `crc` is set
+    uint32_t m_copy(const std::filesystem::path& file, uint64_t size, bool crc);
+
+    ArchiveWriter(const ArchiveWriter& other) = delete;
+    ArchiveWriter& operator=(const ArchiveWriter&);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_ARCHIVEWRITER_H
@@ -0,0 +1,190 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "checksum-file.h"
+#include "hash.h"
+
+#include <omw/defs.h>
+
+#ifdef OMW_PLAT_LINUX
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // OMW_PLAT_LINUX
+
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t bufferSize = 4 * 1024 * 1024;
+
+std::string errorStr(const fs::path& file, const std::string& what) { return "\"" + file.u8string() + "\": " + what; }
+
+bool parseHex(const std::string& str, uint64_t& value)
+{
+    if (str.length() != 16) return false;
+
+    value = 0;
+
+    for (const char c : str)
+    {
+        uint64_t digit;
+
+        if ((c >= '0') && (c <= '9')) digit = (uint64_t)(c - '0');
+        else if ((c >= 'a') && (c <= 'f')) digit = (uint64_t)(c - 'a' + 10);
+        else if ((c >= 'A') && (c <= 'F')) digit = (uint64_t)(c - 'A' + 10);
+        else return false;
+
+        value = (value << 4) | digit;
+    }
+
+    return true;
+}
+
+} // namespace
+
+
+
+util::ChecksumFile::ChecksumFile(const std::filesystem::path& file)
+    : m_file(file), m_entries(), m_invalidLines(0)
+{}
+
+bool util::ChecksumFile::load()
+{
+    m_entries.clear();
+    m_invalidLines = 0;
+
+    std::ifstream ifs(m_file, std::ios::in | std::ios::binary);
+    if (!ifs.good()) return false;
+
+    std::string line;
+
+    while (std::getline(ifs, line))
+    {
+        if (!line.empty() && (line.back() == '\r')) line.pop_back();
+        if (line.empty()) continue;
+
+        // "<hash>  <name>", the second separator is '*' in binary mode of the *sum tools
+        Entry entry;
+
+        if ((line.length() > 18) && (line[16] == ' ') && ((line[17] == ' ') || (line[17] == '*')) && ::parseHex(line.substr(0, 16), entry.hash))
+        {
+            entry.name = line.substr(18);
+            m_entries.push_back(entry);
+        }
+        else ++m_invalidLines;
+    }
+
+    return !ifs.bad();
+}
+
+void util::ChecksumFile::save() const
+{
+    const fs::path tmpFile = m_file.u8string() + ".tmp";
+
+    {
+        std::ofstream ofs;
+        ofs.exceptions(std::ios::badbit | std::ios::failbit | std::ios::eofbit);
+        ofs.open(tmpFile, std::ios::out | std::ios::binary | std::ios::trunc);
+
+        for (const auto& entry : m_entries) ofs << util::toHexStr(entry.hash) << "  " << entry.name << '\n';
+
+        ofs.close();
+    }
+
+    fs::rename(tmpFile, m_file);
+}
+
+#ifdef OMW_PLAT_LINUX
+
+bool util::xxh64File(const std::filesystem::path& file, uint64_t& hash, std::string& error, bool uncached)
+{
+    const int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        error = ::errorStr(file, std::strerror(errno));
+        return false;
+    }
+
+    if (uncached)
+    {
+        // dirty pages are not dropped
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    }
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    std::vector<char> buffer(::bufferSize);
+    util::Xxh64 h;
+    bool ok = true;
+
+    while (true)
+    {
+        const ssize_t n = read(fd, buffer.data(), buffer.size());
+
+        if (n > 0) h.update(buffer.data(), (size_t)n);
+        else if (n == 0) break;
+        else if (errno != EINTR)
+        {
+            error = ::errorStr(file, std::strerror(errno));
+            ok = false;
+            break;
+        }
+    }
+
+    close(fd);
+
+    if (ok) hash = h.digest();
+
+    return ok;
+}
+
+#else // OMW_PLAT_LINUX
+
+bool util::xxh64File(const std::filesystem::path& file, uint64_t& hash, std::string& error, bool uncached)
+{
+    (void)uncached;
+
+    std::ifstream ifs(file, std::ios::in | std::ios::binary);
+
+    if (!ifs.good())
+    {
+        error = ::errorStr(file, "failed to open");
+        return false;
+    }
+
+    std::vector<char> buffer(::bufferSize);
+    util::Xxh64 h;
+
+    while (ifs)
+    {
+        ifs.read(buffer.data(), (std::streamsize)buffer.size());
+        h.update(buffer.data(), (size_t)ifs.gcount());
+    }
+
+    if (ifs.bad())
+    {
+        error = ::errorStr(file, "failed to read");
+        return false;
+    }
+
+    hash = h.digest();
+
+    return true;
+}
+
+#endif // OMW_PLAT_LINUX
@@ -0,0 +1,78 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_CHECKSUMFILE_H
+#define IG_MIDDLEWARE_CHECKSUMFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace util {
+
+// A list of XXH64 checksums in the format of xxhsum ("<16 hex digits>  <file name>" per line), the file names are relative to the directory
+// of the list.
+class ChecksumFile
+{
+public:
+    class Entry
+    {
+    public:
+        Entry()
+            : name(), hash(0)
+        {}
+
+        Entry(const std::string& name_, uint64_t hash_)
+            : name(name_), hash(hash_)
+        {}
+
+        virtual ~Entry() {}
+
+        std::string name;
+        uint64_t hash;
+    };
+
+    static constexpr const char* defaultName = "XXH64SUMS";
+
+public:
+    ChecksumFile() = delete;
+    explicit ChecksumFile(const std::filesystem::path& file);
+    virtual ~ChecksumFile() {}
+
+    const std::filesystem::path& file() const { return m_file; }
+
+    // false if the file can't be read, lines which are not checksums are counted in invalidLines()
+    bool load();
+
+    // writes the list atomically, throws on failure
+    void save() const;
+
+    const std::vector<util::ChecksumFile::Entry>& entries() const { return m_entries; }
+    size_t invalidLines() const { return m_invalidLines; }
+
+    void add(const std::string& name, uint64_t hash) { m_entries.emplace_back(name, hash); }
+    void clear() { m_entries.clear(); }
+
+private:
+    std::filesystem::path m_file;
+    std::vector<util::ChecksumFile::Entry> m_entries;
+    size_t m_invalidLines;
+
+    ChecksumFile(const ChecksumFile& other) = delete;
+    ChecksumFile& operator=(const ChecksumFile&);
+};
+
+// Computes the XXH64 of a file. If `uncached` is set, the file is written to the storage device and dropped from the page cache first, so
+// that the data is read back from the device (Linux only).
+bool xxh64File(const std::filesystem::path& file, uint64_t& hash, std::string& error, bool uncached = false);
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_CHECKSUMFILE_H
@@ -0,0 +1,574 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "content-cache.h"
+#include "encoding-helper.h"
+#include "hash.h"
+#include "util.h"
+
+#include <curl/curl.h>
+#include <omw/defs.h>
+
+#ifdef OMW_PLAT_LINUX
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/file.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif // OMW_PLAT_LINUX
+
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint64_t evictTarget = 90;              // [%] evict() reduces the size to this part of the limit
+constexpr auto tmpMaxAge = std::chrono::hours(1); // older temporary files are left over by crashed processes
+
+void touch(const fs::path& file)
+{
+    std::error_code ec;
+    fs::last_write_time(file, fs::file_time_type::clock::now(), ec);
+}
+
+// calls `fn` with every regular file in `dir` and its subdirectories, files deleted meanwhile by other processes are skipped
+void forEachFile(const fs::path& dir, const std::function<void(const fs::directory_entry&)>& fn)
+{
+    std::error_code ec;
+    auto it = fs::recursive_directory_iterator(dir, ec);
+
+    while (!ec && (it != fs::recursive_directory_iterator()))
+    {
+        std::error_code ecFile;
+        if (it->is_regular_file(ecFile)) fn(*it);
+
+        it.increment(ec);
+    }
+}
+
+bool removeFile(const fs::path& file)
+{
+    std::error_code ec;
+#ifdef OMW_PLAT_WIN
+    fs::permissions(file, fs::perms::owner_write, fs::perm_options::add, ec); // read only files can't be deleted
+#endif
+    return fs::remove(file, ec);
+}
+
+std::string responseHeaders(const std::string& etag, const std::string& lastModified)
+{
+    std::string r;
+    if (!etag.empty()) r += "ETag: " + etag + "\r\n";
+    if (!lastModified.empty()) r += "Last-Modified: " + lastModified + "\r\n";
+    return r;
+}
+
+bool isStorable(const util::HttpGetResponse& response)
+{
+    return (response.good() && (omw_::toLower(response.header("Cache-Control")).find("no-store") == std::string::npos));
+}
+
+#ifdef OMW_PLAT_LINUX
+
+// exclusive advisory lock, released on destruction
+class FileLock
+{
+public:
+    explicit FileLock(const fs::path& file)
+        : m_fd(open(file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)), m_locked(false)
+    {
+        if (m_fd >= 0) m_locked = (flock(m_fd, LOCK_EX | LOCK_NB) == 0);
+    }
+
+    virtual ~FileLock()
+    {
+        if (m_fd >= 0) close(m_fd);
+    }
+
+    bool locked() const { return m_locked; }
+
+private:
+    int m_fd;
+    bool m_locked;
+
+    FileLock(const FileLock& other) = delete;
+    FileLock& operator=(const FileLock&);
+};
+
+bool reflink(const fs::path& src, const fs::path& dst)
+{
+    const int in = open(src.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) return false;
+
+    const int out = open(dst.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (out < 0)
+    {
+        close(in);
+        return false;
+    }
+
+    const bool ok = (ioctl(out, FICLONE, in) == 0);
+
+    close(out);
+    close(in);
+
+    if (!ok) unlink(dst.c_str());
+
+    return ok;
+}
+
+#endif // OMW_PLAT_LINUX
+
+} // namespace
+
+
+
+util::ContentCache::ContentCache(const std::filesystem::path& dir, uint64_t maxSize)
+    : m_dir(dir),
+      m_maxSize(maxSize),
+      m_hits(0),
+      m_revalidated(0),
+      m_misses(0),
+      m_bytesServed(0),
+      m_storedSinceEvict(0),
+      m_tmpCounter(0),
+      m_tmpPrefix(),
+      m_evictMtx()
+{
+    std::random_device rd;
+    m_tmpPrefix = util::toHexStr(((uint64_t)rd() << 32) | (uint64_t)rd());
+
+    std::error_code ec;
+    fs::create_directories(m_dir / "tmp", ec);
+}
+
+util::HttpGetResponse util::ContentCache::fetch(util::Curl& curl, const util::HttpRequest& request, util::ContentCache::Validation validation,
+                                                size_t attempts, bool& cached)
+{
+    const std::string key = m_key(request);
+    const int okCode = (request.hasRange() ? 206 : 200);
+
+    Entry entry;
+    std::string data;
+    const bool found = (m_loadEntry(key, entry) && m_loadObject(entry.object, data));
+
+    cached = found;
+
+    if (found && (validation == Validation::none))
+    {
+        ++m_hits;
+        m_bytesServed += data.size();
+        return util::HttpGetResponse(CURLE_OK, okCode, data, util::HttpTiming(), ::responseHeaders(entry.etag, entry.lastModified));
+    }
+
+    util::HttpGetResponse res;
+    bool done = false;
+
+    if (found && (!entry.etag.empty() || !entry.lastModified.empty()))
+    {
+        util::HttpRequest conditional = request;
+        if (!entry.etag.empty()) conditional.headers.push_back("If-None-Match: " + entry.etag);
+        if (!entry.lastModified.empty()) conditional.headers.push_back("If-Modified-Since: " + entry.lastModified);
+
+        res = curl.httpGET(conditional);
+
+        if ((res.curlCode() == CURLE_OK) && (res.httpCode() == 304))
+        {
+            ++m_hits;
+            ++m_revalidated;
+            m_bytesServed += data.size();
+            return util::HttpGetResponse(CURLE_OK, okCode, data, res.timing(), ::responseHeaders(entry.etag, entry.lastModified));
+        }
+
+        done = res.good();
+        if (attempts > 1) --attempts;
+    }
+
+    if (!done) res = curl.httpGETResume(request, attempts);
+
+    cached = false;
+    ++m_misses;
+
+    if (::isStorable(res)) m_store(key, res);
+
+    return res;
+}
+
+std::vector<std::filesystem::path> util::ContentCache::objectFiles(const std::vector<util::HttpRequest>& requests)
+{
+    std::vector<fs::path> r;
+    r.reserve(requests.size());
+
+    uint64_t bytes = 0;
+
+    for (const auto& request : requests)
+    {
+        Entry entry;
+        if (!m_loadEntry(m_key(request), entry)) return std::vector<fs::path>();
+
+        const fs::path file = m_objectFile(entry.object);
+
+        // the size is part of the object name
+        std::error_code ec;
+        const uint64_t size = fs::file_size(file, ec);
+        if (ec || (std::to_string(size) != entry.object.substr(entry.object.find('-') + 1))) return std::vector<fs::path>();
+
+        r.push_back(file);
+        bytes += size;
+    }
+
+    for (const auto& file : r) ::touch(file);
+
+    m_hits += r.size();
+    m_bytesServed += bytes;
+
+    return r;
+}
+
+bool util::ContentCache::link(const std::filesystem::path& object, const std::filesystem::path& file, util::ContentCache::LinkMethod& method,
+                              std::string& error)
+{
+    std::error_code ec;
+
+    // never write through an existing hard link
+    fs::remove(file, ec);
+
+#ifdef OMW_PLAT_LINUX
+    if (::reflink(object, file))
+    {
+        method = LinkMethod::reflink;
+        return true;
+    }
+#endif
+
+    fs::create_hard_link(object, file, ec);
+
+    if (!ec)
+    {
+        method = LinkMethod::hardlink;
+        return true;
+    }
+
+    fs::copy_file(object, file, fs::copy_options::overwrite_existing, ec);
+
+    if (ec)
+    {
+        error = "\"" + file.u8string() + "\": " + ec.message();
+        return false;
+    }
+
+    fs::permissions(file, fs::perms::owner_write, fs::perm_options::add, ec); // the objects are read only
+
+    method = LinkMethod::copy;
+    return true;
+}
+
+const char* util::ContentCache::toString(util::ContentCache::LinkMethod method)
+{
+    const char* r;
+
+    switch (method)
+    {
+    case LinkMethod::reflink:
+        r = "reflink";
+        break;
+
+    case LinkMethod::hardlink:
+        r = "hard link";
+        break;
+
+    default:
+        r = "copy";
+        break;
+    }
+
+    return r;
+}
+
+void util::ContentCache::evict()
+{
+    std::unique_lock<std::mutex> lock(m_evictMtx, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+
+#ifdef OMW_PLAT_LINUX
+    // concurrent evictions would be harmless, the lock only avoids redundant scans
+    const ::FileLock fileLock(m_dir / "lock");
+    if (!fileLock.locked()) return;
+#endif
+
+    m_storedSinceEvict = 0;
+
+    class Object
+    {
+    public:
+        Object(const fs::file_time_type& time_, uint64_t size_, const fs::path& file_)
+            : time(time_), size(size_), file(file_)
+        {}
+
+        virtual ~Object() {}
+
+        fs::file_time_type time;
+        uint64_t size;
+        fs::path file;
+    };
+
+    std::vector<Object> objects;
+    uint64_t total = 0;
+
+    ::forEachFile(m_dir / "objects", [&](const fs::directory_entry& entry) {
+        std::error_code ec;
+        const auto time = entry.last_write_time(ec);
+        const uint64_t size = entry.file_size(ec);
+
+        if (!ec)
+        {
+            objects.emplace_back(time, size, entry.path());
+            total += size;
+        }
+    });
+
+    size_t removed = 0;
+
+    if (total > m_maxSize)
+    {
+        std::sort(objects.begin(), objects.end(), [](const Object& a, const Object& b) { return (a.time < b.time); });
+
+        const uint64_t target = m_maxSize / 100 * ::evictTarget;
+
+        for (size_t i = 0; (i < objects.size()) && (total > target); ++i)
+        {
+            if (::removeFile(objects[i].file))
+            {
+                total -= objects[i].size;
+                ++removed;
+            }
+        }
+    }
+
+    const auto tmpLimit = fs::file_time_type::clock::now() - ::tmpMaxAge;
+
+    ::forEachFile(m_dir / "tmp", [&](const fs::directory_entry& entry) {
+        std::error_code ec;
+        if (entry.last_write_time(ec) < tmpLimit) ::removeFile(entry.path());
+    });
+
+    // entries of removed objects
+    if (removed > 0)
+    {
+        ::forEachFile(m_dir / "entries", [this](const fs::directory_entry& file) {
+            Entry entry;
+            std::error_code ec;
+
+            std::ifstream ifs(file.path(), std::ios::in | std::ios::binary);
+            std::string line;
+
+            while (std::getline(ifs, line))
+            {
+                if (line.compare(0, 7, "object ") == 0) entry.object = line.substr(7);
+            }
+
+            ifs.close();
+
+            if (entry.object.empty() || !fs::exists(m_objectFile(entry.object), ec)) ::removeFile(file.path());
+        });
+    }
+}
+
+std::string util::ContentCache::normaliseUrl(const std::string& url)
+{
+    util::Uri uri(url);
+    if (!uri.isUrl()) return url;
+
+    const std::string scheme = omw_::toLower(uri.scheme());
+    std::string authority = omw_::toLower(uri.authority());
+
+    const std::string defaultPort = (scheme == "https" ? ":443" : ":80");
+    if ((authority.length() > defaultPort.length()) && (authority.compare(authority.length() - defaultPort.length(), std::string::npos, defaultPort) == 0))
+    {
+        authority.erase(authority.length() - defaultPort.length());
+    }
+
+    const std::string& path = uri.path();
+    std::vector<std::string> segments;
+    size_t pos = 0;
+
+    while (pos <= path.length())
+    {
+        size_t end = path.find('/', pos);
+        if (end == std::string::npos) end = path.length();
+
+        const std::string segment = path.substr(pos, end - pos);
+
+        if (segment == "..")
+        {
+            if (!segments.empty()) segments.pop_back();
+        }
+        else if (!segment.empty() && (segment != ".")) segments.push_back(segment);
+
+        pos = end + 1;
+    }
+
+    std::string normPath;
+    for (const auto& segment : segments) normPath += '/' + segment;
+    if (normPath.empty() || (!path.empty() && (path.back() == '/'))) normPath += '/';
+
+    uri.setScheme(scheme);
+    uri.setAuthority(authority);
+    uri.setPath(normPath);
+    uri.setFragment("");
+
+    return uri.string();
+}
+
+std::filesystem::path util::ContentCache::defaultDir()
+{
+#ifdef OMW_PLAT_WIN
+    const char* const localAppData = std::getenv("LOCALAPPDATA");
+    if (localAppData && (*localAppData != 0)) return enc::path(enc::acptou8(localAppData)) / "m3u-tool";
+#else
+    const char* const xdgCache = std::getenv("XDG_CACHE_HOME");
+    if (xdgCache && (*xdgCache == '/')) return fs::path(xdgCache) / "m3u-tool";
+
+    const char* const home = std::getenv("HOME");
+    if (home && (*home != 0)) return fs::path(home) / ".cache" / "m3u-tool";
+#endif
+
+    return fs::temp_directory_path() / "m3u-tool-cache";
+}
+
+std::string util::ContentCache::m_key(const util::HttpRequest& request)
+{
+    std::string r = normaliseUrl(request.url);
+
+    if (request.hasRange())
+    {
+        r += " range=" + std::to_string(request.rangeBegin) + "-";
+        if (request.rangeEnd >= 0) r += std::to_string(request.rangeEnd);
+    }
+
+    return r;
+}
+
+std::filesystem::path util::ContentCache::m_entryFile(const std::string& key) const
+{
+    const std::string name = util::toHexStr(util::fnv1a64(key));
+    return m_dir / "entries" / name.substr(0, 2) / name;
+}
+
+std::filesystem::path util::ContentCache::m_objectFile(const std::string& object) const { return m_dir / "objects" / object.substr(0, 2) / object; }
+
+std::filesystem::path util::ContentCache::m_tmpFile() { return m_dir / "tmp" / (m_tmpPrefix + '-' + std::to_string(m_tmpCounter++)); }
+
+bool util::ContentCache::m_loadEntry(const std::string& key, util::ContentCache::Entry& entry) const
+{
+    std::ifstream ifs(m_entryFile(key), std::ios::in | std::ios::binary);
+    if (!ifs.good()) return false;
+
+    std::string line;
+
+    while (std::getline(ifs, line))
+    {
+        const size_t space = line.find(' ');
+        if (space == std::string::npos) continue;
+
+        const std::string name = line.substr(0, space);
+        const std::string value = line.substr(space + 1);
+
+        if (name == "key") entry.key = value;
+        else if (name == "object") entry.object = value;
+        else if (name == "etag") entry.etag = value;
+        else if (name == "last-modified") entry.lastModified = value;
+    }
+
+    // the file name is a hash of the key
+    return ((entry.key == key) && (entry.object.find('-') != std::string::npos));
+}
+
+bool util::ContentCache::m_loadObject(const std::string& object, std::string& data) const
+{
+    const fs::path file = m_objectFile(object);
+
+    std::ifstream ifs(file, std::ios::in | std::ios::binary);
+    if (!ifs.good()) return false;
+
+    std::ostringstream oss;
+    oss << ifs.rdbuf();
+    data = oss.str();
+
+    if ((util::toHexStr(util::fnv1a64(data)) + '-' + std::to_string(data.size())) != object) return false;
+
+    ::touch(file);
+
+    return true;
+}
+
+void util::ContentCache::m_store(const std::string& key, const util::HttpGetResponse& response)
+{
+    const std::string& data = response.data();
+    const std::string object = util::toHexStr(util::fnv1a64(data)) + '-' + std::to_string(data.size());
+    const fs::path objectFile = m_objectFile(object);
+
+    std::error_code ec;
+
+    if (fs::exists(objectFile, ec)) ::touch(objectFile);
+    else if (!m_write(objectFile, data, true)) return;
+
+    std::string entry = "key " + key + "\nobject " + object + '\n';
+    if (!response.header("ETag").empty()) entry += "etag " + response.header("ETag") + '\n';
+    if (!response.header("Last-Modified").empty()) entry += "last-modified " + response.header("Last-Modified") + '\n';
+
+    m_write(m_entryFile(key), entry, false);
+
+    m_storedSinceEvict += data.size();
+    if (m_storedSinceEvict > (m_maxSize / 8)) evict();
+}
+
+bool util::ContentCache::m_write(const std::filesystem::path& file, const std::string& data, bool readOnly)
+{
+    const fs::path tmpFile = m_tmpFile();
+    std::error_code ec;
+
+    fs::create_directories(file.parent_path(), ec);
+
+    {
+        std::ofstream ofs(tmpFile, std::ios::out | std::ios::binary | std::ios::trunc);
+        ofs.write(data.data(), (std::streamsize)data.size());
+        ofs.close();
+
+        if (ofs.fail())
+        {
+            ::removeFile(tmpFile);
+            return false;
+        }
+    }
+
+    if (readOnly) fs::permissions(tmpFile, fs::perms::owner_read | fs::perms::group_read | fs::perms::others_read, ec);
+
+    fs::rename(tmpFile, file, ec);
+
+    if (ec)
+    {
+        ::removeFile(tmpFile);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,138 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_CONTENTCACHE_H
+#define IG_MIDDLEWARE_CONTENTCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "middleware/curl-helper.h"
+
+
+namespace util {
+
+// Local cache of HTTP responses, shared by all processes which use the same directory.
+//
+// The bodies are stored once per content in `objects/` (named by hash and size), an entry in `entries/` maps the normalised URL and
+// byte range of a request to an object and holds the validators (ETag, Last-Modified) of the response. Files are written to `tmp/` and
+// renamed into place, so readers never see partial files and concurrent writers of the same resource don't conflict. An object which is
+// used gets a new modification time, evict() removes the least recently used objects until the size limit is met.
+//
+// Objects are read only, hard links to them must not be modified.
+class ContentCache
+{
+public:
+    enum class Validation
+    {
+        none,        // a cached response is used without a request (media segments and keys don't change)
+        conditional, // a cached response is revalidated with If-None-Match / If-Modified-Since (playlists)
+    };
+
+    enum class LinkMethod
+    {
+        reflink,
+        hardlink,
+        copy,
+    };
+
+public:
+    ContentCache() = delete;
+    ContentCache(const std::filesystem::path& dir, uint64_t maxSize);
+    virtual ~ContentCache() {}
+
+    const std::filesystem::path& dir() const { return m_dir; }
+    uint64_t maxSize() const { return m_maxSize; }
+
+    // Returns the cached response or downloads the resource and stores it, `cached` is set if the response is from the cache. Thread safe.
+    util::HttpGetResponse fetch(util::Curl& curl, const util::HttpRequest& request, util::ContentCache::Validation validation, size_t attempts,
+                                bool& cached);
+    util::HttpGetResponse fetch(util::Curl& curl, const util::HttpRequest& request, util::ContentCache::Validation validation, size_t attempts)
+    {
+        bool cached;
+        return fetch(curl, request, validation, attempts, cached);
+    }
+
+    // Object files of cached resources, empty if one of them isn't cached. Counted as hits if all are cached, without validation. The
+    // files may be evicted by another process at any time.
+    std::vector<std::filesystem::path> objectFiles(const std::vector<util::HttpRequest>& requests);
+
+    // Creates `file` with the content of `object`, a reflink or hard link if the file system supports it, a copy otherwise. An existing
+    // `file` is replaced.
+    static bool link(const std::filesystem::path& object, const std::filesystem::path& file, util::ContentCache::LinkMethod& method, std::string& error);
+
+    static const char* toString(util::ContentCache::LinkMethod method);
+
+    // Removes the least recently used objects until the size of the cache is within the limit. Skipped if another process is evicting.
+    void evict();
+
+    size_t hits() const { return m_hits; }
+    size_t revalidated() const { return m_revalidated; } // included in hits
+    size_t misses() const { return m_misses; }
+    uint64_t bytesServed() const { return m_bytesServed; }
+
+    // lower case scheme and host, no default port, no fragment, dot segments and empty path segments removed
+    static std::string normaliseUrl(const std::string& url);
+
+    // $XDG_CACHE_HOME/m3u-tool, ~/.cache/m3u-tool or %LOCALAPPDATA%\m3u-tool
+    static std::filesystem::path defaultDir();
+
+private:
+    class Entry
+    {
+    public:
+        Entry()
+            : key(), object(), etag(), lastModified()
+        {}
+
+        virtual ~Entry() {}
+
+        std::string key;
+        std::string object; // file name in objects/
+        std::string etag;
+        std::string lastModified;
+    };
+
+private:
+    std::filesystem::path m_dir;
+    uint64_t m_maxSize;
+    std::atomic<size_t> m_hits;
+    std::atomic<size_t> m_revalidated;
+    std::atomic<size_t> m_misses;
+    std::atomic<uint64_t> m_bytesServed;
+    std::atomic<uint64_t> m_storedSinceEvict;
+    std::atomic<uint64_t> m_tmpCounter;
+    std::string m_tmpPrefix;
+    std::mutex m_evictMtx;
+
+    static std::string m_key(const util::HttpRequest& request);
+    std::filesystem::path m_entryFile(const std::string& key) const;
+    std::filesystem::path m_objectFile(const std::string& object) const;
+    std::filesystem::path m_tmpFile();
+
+    bool m_loadEntry(const std::string& key, util::ContentCache::Entry& entry) const;
+
+    // reads the object and marks it as used, false if it doesn't exist or is damaged
+    bool m_loadObject(const std::string& object, std::string& data) const;
+
+    void m_store(const std::string& key, const util::HttpGetResponse& response);
+
+    // writes the file atomically
+    bool m_write(const std::filesystem::path& file, const std::string& data, bool readOnly);
+
+    ContentCache(const ContentCache& other) = delete;
+    ContentCache& operator=(const ContentCache&);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_CONTENTCACHE_H
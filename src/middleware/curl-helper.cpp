@@ -4,11 +4,17 @@ date            27.11.2023
 copyright       GPL-3.0 - Copyright (c) 2023 Oliver Blaser
 */
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <ctime>
+#include <random>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 #include "curl-helper.h"
+#include "middleware/util.h"
 
 // VS Properties:
 //      - C/C++ > General > Additional Include Dirs: `$(sdk)/curl-7.81.0/x86/include`
@@ -21,12 +27,30 @@ copyright       GPL-3.0 - Copyright (c) 2023 Oliver Blaser
 
 namespace {
 
+constexpr double retryBaseDelay = 0.5; // [s] before the second attempt, doubled for each further attempt
+constexpr double retryMaxDelay = 30;   // [s]
+constexpr double maxRetryAfter = 120;  // [s] a longer Retry-After is cut to this
+
 using curl_data_t = std::string;
 
+struct WriteData
+{
+    WriteData() = delete;
+    WriteData(curl_data_t* pData, util::HttpScheduler* pScheduler)
+        : data(pData), scheduler(pScheduler)
+    {}
+
+    curl_data_t* const data;
+    util::HttpScheduler* const scheduler;
+};
+
 size_t dataCallback(char* p, size_t size, size_t nmemb, void* pClientData)
 {
+    const WriteData* const wd = (const WriteData*)pClientData;
+
     size_t effSize = size * nmemb;
-    for (size_t i = 0; i < effSize; ++i) ((curl_data_t*)pClientData)->push_back(*(p + i));
+    wd->scheduler->consume(effSize);
+    wd->data->append(p, effSize);
     return effSize;
 }
 
@@ -40,6 +64,13 @@ struct ProgressData
     const util::Curl* const curl;
 };
 
+size_t headerCallback(char* p, size_t size, size_t nitems, void* pClientData)
+{
+    size_t effSize = size * nitems;
+    ((std::string*)pClientData)->append(p, effSize);
+    return effSize;
+}
+
 int progressCallback(void* pClientData, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow)
 {
     // https://curl.se/libcurl/c/progressfunc.html
@@ -55,23 +86,185 @@ int progressCallback(void* pClientData, curl_off_t dltotal, curl_off_t dlnow, cu
     return r;
 }
 
+double getInfoTime(CURL* curl, CURLINFO info)
+{
+    curl_off_t us = 0;
+    if (curl_easy_getinfo(curl, info, &us) != CURLE_OK) us = 0;
+    return ((double)us / 1000000.0);
+}
+
+// only transport errors and an overloaded server are a congestion signal, other client errors are neutral
+util::HttpScheduler::Result schedulerResult(const util::HttpGetResponse& r, bool success)
+{
+    if (success) return util::HttpScheduler::Result::good;
+    if (r.aborted()) return util::HttpScheduler::Result::neutral;
+    if (r.curlCode() != CURLE_OK) return util::HttpScheduler::Result::congested;
+    if ((r.httpCode() == 429) || (r.httpCode() >= 500)) return util::HttpScheduler::Result::congested;
+
+    return util::HttpScheduler::Result::neutral;
+}
+
+// curl transport errors, 5xx and 429 may succeed on a retry, other HTTP errors (e.g. 404) and errors in the request itself won't
+bool isTransient(const util::HttpGetResponse& r)
+{
+    switch (r.curlCode())
+    {
+    case CURLE_OK:
+        return ((r.httpCode() == 429) || (r.httpCode() >= 500));
+
+    case CURLE_UNSUPPORTED_PROTOCOL:
+    case CURLE_URL_MALFORMAT:
+    case CURLE_NOT_BUILT_IN:
+    case CURLE_WRITE_ERROR:
+    case CURLE_OUT_OF_MEMORY:
+    case CURLE_ABORTED_BY_CALLBACK:
+    case CURLE_FILE_COULDNT_READ_FILE: // not in the replayed HTTP archive
+        return false;
+
+    default:
+        return true;
+    }
+}
+
+// Offset of the first byte of the body in the resource, from the raw response. httpGET() reports a 200 to a range request as 206,
+// only the Content-Range header (bytes FIRST-LAST/SIZE) tells if the server sent the requested range. -1 if unknown.
+int64_t bodyOffset(const util::HttpGetResponse& r)
+{
+    const std::string contentRange = r.header("Content-Range");
+
+    if (contentRange.empty()) return (r.httpCode() == 200 ? 0 : -1);
+
+    size_t pos = contentRange.find_first_of("0123456789");
+    if ((pos == std::string::npos) || (contentRange.compare(0, 5, "bytes") != 0)) return -1;
+
+    int64_t offset = 0;
+    for (; (pos < contentRange.length()) && (contentRange[pos] >= '0') && (contentRange[pos] <= '9'); ++pos)
+    {
+        if (offset > (INT64_MAX / 10)) return -1;
+        offset = offset * 10 + (contentRange[pos] - '0');
+    }
+
+    return (((pos < contentRange.length()) && (contentRange[pos] == '-')) ? offset : -1);
+}
+
+// Retry-After of a 429 or 503 in seconds (delay-seconds or HTTP-date), 0 if there is none
+double retryAfter(const util::HttpGetResponse& r)
+{
+    if ((r.httpCode() != 429) && (r.httpCode() != 503)) return 0;
+
+    const std::string value = r.header("Retry-After");
+    double seconds = 0;
+
+    if (value.empty()) return 0;
+    else if (omw::isUInteger(value)) seconds = (value.length() > 6 ? ::maxRetryAfter : std::stod(value));
+    else
+    {
+        const time_t t = curl_getdate(value.c_str(), nullptr);
+        if (t >= 0) seconds = std::difftime(t, std::time(nullptr));
+    }
+
+    return std::min(std::max(seconds, 0.0), ::maxRetryAfter);
+}
+
+// Exponential backoff with jitter before the attempt after `attempt` (0 based), randomised between half and the full delay so that
+// parallel transfers don't retry in lockstep. At least the Retry-After of the response.
+double retryDelay(size_t attempt, const util::HttpGetResponse& r)
+{
+    thread_local std::mt19937 rng(std::random_device{}());
+
+    const double delay = std::min(::retryMaxDelay, ::retryBaseDelay * (double)(1ull << std::min<size_t>(attempt, 16)));
+    std::uniform_real_distribution<double> jitter(delay / 2, delay);
+
+    return std::max(jitter(rng), ::retryAfter(r));
+}
+
+util::HttpTiming getTiming(CURL* curl)
+{
+    util::HttpTiming r;
+
+    r.dns = getInfoTime(curl, CURLINFO_NAMELOOKUP_TIME_T);
+    r.connect = getInfoTime(curl, CURLINFO_CONNECT_TIME_T);
+    r.tls = getInfoTime(curl, CURLINFO_APPCONNECT_TIME_T);
+    r.ttfb = getInfoTime(curl, CURLINFO_STARTTRANSFER_TIME_T);
+    r.total = getInfoTime(curl, CURLINFO_TOTAL_TIME_T);
+
+    curl_off_t tmp = 0;
+    if (curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &tmp) == CURLE_OK) r.bytes = (uint64_t)tmp;
+    tmp = 0;
+    if (curl_easy_getinfo(curl, CURLINFO_SPEED_DOWNLOAD_T, &tmp) == CURLE_OK) r.speed = (double)tmp;
+
+    return r;
+}
+
 } // namespace
 
 
 
 util::HttpGetResponse::HttpGetResponse()
-    : m_curlCode(-1), m_httpCode(-1), m_data()
+    : m_curlCode(-1), m_httpCode(-1), m_data(), m_timing(), m_headers()
 {}
 
 util::HttpGetResponse::HttpGetResponse(const std::string& data)
-    : m_curlCode(-1), m_httpCode(-1), m_data(data)
+    : m_curlCode(-1), m_httpCode(-1), m_data(data), m_timing(), m_headers()
 {}
 
 util::HttpGetResponse::HttpGetResponse(int curlCode, int httpCode, const std::string& data)
-    : m_curlCode(curlCode), m_httpCode(httpCode), m_data(data)
+    : m_curlCode(curlCode), m_httpCode(httpCode), m_data(data), m_timing(), m_headers()
+{}
+
+util::HttpGetResponse::HttpGetResponse(int curlCode, int httpCode, const std::string& data, const util::HttpTiming& timing, const std::string& headers)
+    : m_curlCode(curlCode), m_httpCode(httpCode), m_data(data), m_timing(timing), m_headers(headers)
 {}
 
-bool util::HttpGetResponse::good() const { return ((m_curlCode == CURLE_OK) && (m_httpCode == 200)); }
+std::string util::HttpGetResponse::header(const std::string& name) const
+{
+    std::string r;
+
+    const std::string lname = omw_::toLower(name);
+
+    size_t pos = 0;
+    while (pos < m_headers.length())
+    {
+        size_t end = m_headers.find('\n', pos);
+        if (end == std::string::npos) end = m_headers.length();
+
+        const std::string line = m_headers.substr(pos, end - pos);
+        const size_t colonPos = line.find(':');
+
+        if ((colonPos != std::string::npos) && (omw_::toLower(line.substr(0, colonPos)) == lname))
+        {
+            size_t b = colonPos + 1;
+            size_t e = line.length();
+            while ((b < e) && ((line[b] == ' ') || (line[b] == '\t'))) ++b;
+            while ((e > b) && ((line[e - 1] == '\r') || (line[e - 1] == ' ') || (line[e - 1] == '\t'))) --e;
+
+            r = line.substr(b, e - b);
+        }
+
+        pos = end + 1;
+    }
+
+    return r;
+}
+
+std::string util::HttpRequest::key() const
+{
+    std::string r = url;
+
+    if (hasRange())
+    {
+        r += " range=" + std::to_string(rangeBegin) + "-";
+        if (rangeEnd >= 0) r += std::to_string(rangeEnd);
+    }
+
+    if (head) r += " head";
+
+    return r;
+}
+
+
+
+bool util::HttpGetResponse::good() const { return ((m_curlCode == CURLE_OK) && ((m_httpCode == 200) || (m_httpCode == 206))); }
 
 bool util::HttpGetResponse::aborted() const { return (m_curlCode == CURLE_ABORTED_BY_CALLBACK); }
 
@@ -89,7 +282,7 @@ const char* const util::Curl::defaultUserAgent = "libcurl";
 size_t util::Curl::s_nInstances = 0;
 
 util::Curl::Curl()
-    : m_initDone(false), m_mtx(), m_abortState(false)
+    : m_initDone(false), m_stats(), m_scheduler(), m_archive(), m_mtx(), m_abortState(false)
 {
     if (s_nInstances < 1)
     {
@@ -114,6 +307,19 @@ util::Curl::~Curl()
 
 util::HttpGetResponse util::Curl::httpGET(const std::string& reqStr, long timeoutConn, long timeout, const std::string& userAgent)
 {
+    util::HttpRequest request(reqStr, timeoutConn, timeout);
+    request.userAgent = userAgent;
+
+    return httpGET(request);
+}
+
+util::HttpGetResponse util::Curl::httpGET(const util::HttpRequest& request)
+{
+    if (m_archive.isReplaying()) return m_replay(request);
+
+    const std::string& reqStr = request.url;
+    const std::string userAgent = (request.userAgent.empty() ? std::string(defaultUserAgent) : request.userAgent);
+
     util::HttpGetResponse r(-1, -1, "curl not initialized");
 
     if (m_initDone)
@@ -127,12 +333,31 @@ util::HttpGetResponse util::Curl::httpGET(const std::string& reqStr, long timeou
             curl_easy_setopt(curl, CURLOPT_URL, reqStr.c_str());
             curl_easy_setopt(curl, CURLOPT_USERAGENT, userAgent.c_str());
 
-            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, timeoutConn);
-            curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout);
+            curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, request.timeoutConn);
+            curl_easy_setopt(curl, CURLOPT_TIMEOUT, request.timeout);
+
+            std::string range;
+            if (request.hasRange())
+            {
+                range = std::to_string(request.rangeBegin) + "-";
+                if (request.rangeEnd >= 0) range += std::to_string(request.rangeEnd);
+                curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
+            }
+
+            if (request.head) curl_easy_setopt(curl, CURLOPT_NOBODY, 1l);
+
+            struct curl_slist* headerList = nullptr;
+            for (const auto& header : request.headers) headerList = curl_slist_append(headerList, header.c_str());
+            if (headerList) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList);
 
             ::curl_data_t resBody;
+            const WriteData writeData(&resBody, &m_scheduler);
             curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, dataCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &resBody);
+            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &writeData);
+
+            std::string resHeaders;
+            curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
+            curl_easy_setopt(curl, CURLOPT_HEADERDATA, &resHeaders);
 
             const ProgressData progData(this);
             curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1l); // XFERINFOFUNCTION won't be called, so the request can't be aborted (not needed in this project)
@@ -141,21 +366,100 @@ util::HttpGetResponse util::Curl::httpGET(const std::string& reqStr, long timeou
 
             m_abort(false);
 
+            const std::string host = util::Uri(reqStr).authority();
+            auto slot = m_scheduler.acquire(host);
+
             CURLcode res;
             res = curl_easy_perform(curl);
 
             long resCode;
             curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &resCode);
 
-            r = util::HttpGetResponse(res, resCode, resBody);
+            // the server ignored the range
+            if ((res == CURLE_OK) && (resCode == 200) && request.hasRange())
+            {
+                const size_t begin = std::min((size_t)request.rangeBegin, resBody.size());
+                size_t count = std::string::npos;
+                if (request.rangeEnd >= request.rangeBegin) count = (size_t)(request.rangeEnd - request.rangeBegin + 1);
+
+                resBody = resBody.substr(begin, count);
+                resCode = 206;
+            }
+
+            r = util::HttpGetResponse(res, resCode, resBody, ::getTiming(curl), resHeaders);
+
+            // the response to a conditional request may be 304
+            const bool success = (r.good() || ((res == CURLE_OK) && (resCode == 304)));
+            slot.done(r.timing().ttfb, ::schedulerResult(r, success));
+            m_stats.add(host, r.timing(), success);
 
             curl_easy_cleanup(curl);
+            curl_slist_free_all(headerList);
+
+            if (m_archive.isRecording())
+            {
+                util::HttpArchive::Entry entry;
+                entry.curlCode = r.curlCode();
+                entry.httpCode = r.httpCode();
+                entry.headers = r.headers();
+                entry.body = r.data();
+                entry.timing = r.timing();
+
+                m_archive.record(request.key(), entry);
+            }
         }
     }
 
     return r;
 }
 
+util::HttpGetResponse util::Curl::httpGETResume(const util::HttpRequest& request, size_t attempts)
+{
+    util::HttpRequest req = request;
+    std::string data;
+    util::HttpGetResponse r;
+
+    double delay = 0;
+
+    for (size_t i = 0; i < std::max<size_t>(attempts, 1); ++i)
+    {
+        if (delay > 0) std::this_thread::sleep_for(std::chrono::duration<double>(delay));
+
+        r = httpGET(req);
+
+        if (r.good())
+        {
+            if (data.empty()) return r;
+            return util::HttpGetResponse(r.curlCode(), (request.hasRange() ? 206 : 200), data + r.data(), r.timing(), r.headers());
+        }
+
+        if (!::isTransient(r)) break;
+
+        delay = ::retryDelay(i, r);
+
+        if ((r.curlCode() != CURLE_OK) && ((r.httpCode() == 200) || (r.httpCode() == 206)) && !r.data().empty())
+        {
+            // a server which ignores the range sends the resource from the beginning, the transfer is started over
+            if (::bodyOffset(r) != (req.hasRange() ? req.rangeBegin : 0))
+            {
+                data.clear();
+                req = request;
+                continue;
+            }
+
+            data += r.data();
+
+            const int64_t begin = (request.hasRange() ? request.rangeBegin : 0) + (int64_t)data.size();
+            if ((request.rangeEnd >= 0) && (begin > request.rangeEnd)) return util::HttpGetResponse(CURLE_OK, 206, data, r.timing(), r.headers());
+
+            req.setRange(begin, request.rangeEnd);
+        }
+    }
+
+    if (data.empty()) return r;
+    return util::HttpGetResponse(r.curlCode(), r.httpCode(), data, r.timing(), r.headers());
+}
+
 bool util::Curl::isAborted() const
 {
     std::lock_guard<std::mutex> lg(m_mtx);
@@ -169,3 +473,53 @@ void util::Curl::m_abort(bool state)
     std::lock_guard<std::mutex> lg(m_mtx);
     m_abortState = state;
 }
+
+util::HttpGetResponse util::Curl::m_replay(const util::HttpRequest& request)
+{
+    using clock = std::chrono::steady_clock;
+
+    const std::string host = util::Uri(request.url).authority();
+    auto slot = m_scheduler.acquire(host);
+
+    const auto tStart = clock::now();
+
+    util::HttpArchive::Entry entry;
+
+    if (!m_archive.load(request.key(), entry))
+    {
+        slot.done(0, util::HttpScheduler::Result::neutral);
+        // not a transfer error, a retry would miss as well
+        return util::HttpGetResponse(CURLE_FILE_COULDNT_READ_FILE, 0, "not found in HTTP archive");
+    }
+
+    const double latency = (m_archive.latency() >= 0 ? m_archive.latency() : entry.timing.ttfb);
+    std::this_thread::sleep_until(tStart + std::chrono::duration<double>(latency));
+
+    const auto tFirstByte = clock::now();
+
+    // deliver the body in chunks, as curl would
+    constexpr size_t chunkSize = 16 * 1024;
+    const double bandwidth = (double)m_archive.bandwidth();
+
+    for (size_t pos = 0; pos < entry.body.size(); pos += chunkSize)
+    {
+        const size_t n = std::min(chunkSize, entry.body.size() - pos);
+
+        m_scheduler.consume(n);
+
+        if (bandwidth > 0) std::this_thread::sleep_until(tFirstByte + std::chrono::duration<double>((double)(pos + n) / bandwidth));
+    }
+
+    util::HttpTiming timing;
+    timing.ttfb = std::chrono::duration<double>(tFirstByte - tStart).count();
+    timing.total = std::chrono::duration<double>(clock::now() - tStart).count();
+    timing.bytes = entry.body.size();
+    timing.speed = (timing.total > 0 ? ((double)timing.bytes / timing.total) : 0);
+
+    const util::HttpGetResponse r(entry.curlCode, entry.httpCode, entry.body, timing, entry.headers);
+
+    slot.done(timing.ttfb, ::schedulerResult(r, r.good()));
+    m_stats.add(host, timing, r.good());
+
+    return r;
+}
@@ -10,20 +10,66 @@ copyright       GPL-3.0 - Copyright (c) 2023 Oliver Blaser
 #include <cstdint>
 #include <mutex>
 #include <string>
+#include <vector>
+
+#include "middleware/http-archive.h"
+#include "middleware/http-scheduler.h"
+#include "middleware/http-stats.h"
 
 namespace util {
 
+class HttpRequest
+{
+public:
+    HttpRequest() = delete;
+
+    explicit HttpRequest(const std::string& url_, long timeoutConn_ = 0, long timeout_ = 0)
+        : url(url_), timeoutConn(timeoutConn_), timeout(timeout_), userAgent(), rangeBegin(-1), rangeEnd(-1), head(false), headers()
+    {}
+
+    virtual ~HttpRequest() {}
+
+    std::string url;
+    long timeoutConn; // [s] 0 = curl default
+    long timeout;     // [s] 0 = no limit
+    std::string userAgent;
+
+    // byte range, both positions are inclusive, `rangeEnd` < 0 reads to the end of the resource
+    int64_t rangeBegin; // < 0 = no range
+    int64_t rangeEnd;
+
+    bool head; // HEAD request, the response has no body
+
+    std::vector<std::string> headers; // additional header lines ("Name: value"), not part of the key
+
+    bool hasRange() const { return (rangeBegin >= 0); }
+    void setRange(int64_t begin, int64_t end = -1)
+    {
+        rangeBegin = begin;
+        rangeEnd = end;
+    }
+
+    // identifies the request in the HTTP archive
+    std::string key() const;
+};
+
 class HttpGetResponse
 {
 public:
     HttpGetResponse();
     HttpGetResponse(const std::string& data);
     HttpGetResponse(int curlCode, int httpCode, const std::string& data);
+    HttpGetResponse(int curlCode, int httpCode, const std::string& data, const util::HttpTiming& timing, const std::string& headers = std::string());
     virtual ~HttpGetResponse() {}
 
     int curlCode() const { return m_curlCode; }
     int httpCode() const { return m_httpCode; }
     const std::string& data() const { return m_data; }
+    const util::HttpTiming& timing() const { return m_timing; }
+    const std::string& headers() const { return m_headers; }
+
+    // value of the last header field with a matching name (case insensitive), empty if not found
+    std::string header(const std::string& name) const;
 
     bool good() const;
     bool aborted() const;
@@ -34,6 +80,8 @@ private:
     int m_curlCode;
     int m_httpCode;
     std::string m_data;
+    util::HttpTiming m_timing;
+    std::string m_headers;
 };
 
 class Curl
@@ -48,18 +96,40 @@ public:
     bool isInitDone() const { return m_initDone; }
 
     HttpGetResponse httpGET(const std::string& reqStr, long timeoutConn = 0, long timeout = 0, const std::string& userAgent = defaultUserAgent);
+    HttpGetResponse httpGET(const util::HttpRequest& request);
+
+    // Retries a transient failure (curl transport error, 5xx or 429) up to `attempts` times in total, with exponential backoff and at
+    // least the Retry-After of the server. A transfer which broke off is continued with a range request for the missing part. On failure
+    // the response contains the data received so far.
+    HttpGetResponse httpGETResume(const util::HttpRequest& request, size_t attempts);
 
     bool isAborted() const;
     void abort();
 
+    // timing of all requests done by this instance
+    const util::HttpStats& stats() const { return m_stats; }
+
+    // every request passes the scheduler, configure it before starting parallel transfers
+    util::HttpScheduler& scheduler() { return m_scheduler; }
+    const util::HttpScheduler& scheduler() const { return m_scheduler; }
+
+    // record or replay mode, configure it before the first request
+    util::HttpArchive& archive() { return m_archive; }
+    const util::HttpArchive& archive() const { return m_archive; }
+
 private:
     bool m_initDone;
+    util::HttpStats m_stats;
+    util::HttpScheduler m_scheduler;
+    util::HttpArchive m_archive;
 
     bool m_abortState;
     mutable std::mutex m_mtx;
 
     void m_abort(bool state);
 
+    util::HttpGetResponse m_replay(const util::HttpRequest& request);
+
 private:
     Curl(const Curl& other) = delete;
     Curl& operator=(const Curl&);
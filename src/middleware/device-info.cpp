@@ -0,0 +1,96 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#include "device-info.h"
+
+#include <omw/defs.h>
+
+#ifdef OMW_PLAT_LINUX
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#endif // OMW_PLAT_LINUX
+
+
+namespace fs = std::filesystem;
+
+
+
+#ifdef OMW_PLAT_LINUX
+
+uint64_t util::firstExtent(const std::filesystem::path& file)
+{
+    const int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return UINT64_MAX;
+
+    // the header followed by one extent
+    alignas(struct fiemap) char buffer[sizeof(struct fiemap) + sizeof(struct fiemap_extent)];
+    std::memset(buffer, 0, sizeof(buffer));
+
+    struct fiemap* fm = (struct fiemap*)buffer;
+    fm->fm_start = 0;
+    fm->fm_length = FIEMAP_MAX_OFFSET;
+    fm->fm_extent_count = 1;
+
+    uint64_t r = UINT64_MAX;
+    if ((ioctl(fd, FS_IOC_FIEMAP, fm) == 0) && (fm->fm_mapped_extents > 0)) r = fm->fm_extents[0].fe_physical;
+
+    close(fd);
+
+    return r;
+}
+
+util::DeviceType util::deviceType(uint64_t device)
+{
+    const fs::path dir = fs::path("/sys/dev/block") / util::deviceStr(device);
+    std::error_code ec;
+
+    if (!fs::exists(dir, ec)) return DeviceType::unknown;
+
+    // partitions have no queue, it's in the directory of the disk
+    fs::path file = dir / "queue" / "rotational";
+    if (!fs::exists(file, ec)) file = fs::canonical(dir, ec).parent_path() / "queue" / "rotational";
+
+    std::ifstream ifs(file);
+    int rotational = -1;
+
+    if (!(ifs >> rotational)) return DeviceType::unknown;
+
+    return (rotational == 1 ? DeviceType::rotational : DeviceType::solidState);
+}
+
+std::string util::deviceStr(uint64_t device) { return std::to_string(major((dev_t)device)) + ':' + std::to_string(minor((dev_t)device)); }
+
+#else // OMW_PLAT_LINUX
+
+uint64_t util::firstExtent(const std::filesystem::path& file)
+{
+    (void)file;
+
+    return UINT64_MAX;
+}
+
+util::DeviceType util::deviceType(uint64_t device)
+{
+    (void)device;
+
+    return DeviceType::unknown;
+}
+
+std::string util::deviceStr(uint64_t device) { return std::to_string(device); }
+
+#endif // OMW_PLAT_LINUX
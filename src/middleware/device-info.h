@@ -0,0 +1,38 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_DEVICEINFO_H
+#define IG_MIDDLEWARE_DEVICEINFO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+
+namespace util {
+
+enum class DeviceType
+{
+    unknown, // not a block device (e.g. tmpfs, network file systems) or not Linux
+    rotational,
+    solidState,
+};
+
+// Byte offset of the first extent of the file on the device (FIEMAP), used to order reads so that the disk heads move in one direction.
+// UINT64_MAX if it's unknown (empty file, no FIEMAP support or not Linux).
+uint64_t firstExtent(const std::filesystem::path& file);
+
+// from /sys/dev/block/MAJ:MIN/queue/rotational, of the whole disk for partitions
+util::DeviceType deviceType(uint64_t device);
+
+// "MAJ:MIN"
+std::string deviceStr(uint64_t device);
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_DEVICEINFO_H
@@ -0,0 +1,177 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "download-journal.h"
+#include "hash.h"
+
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* const magicLine = "m3u-tool download journal 1";
+
+// `done` completes segment `idx`, `part` is a piece of it, a segment resumed after an interruption consists of one or more `part`
+// records followed by `done` which covers the rest
+class Record
+{
+public:
+    Record()
+        : type(), idx(0), size(0), hash()
+    {}
+
+    virtual ~Record() {}
+
+    std::string type;
+    size_t idx;
+    uint64_t size;
+    std::string hash;
+};
+
+bool parseRecord(const std::string& line, Record& record)
+{
+    std::istringstream iss(line);
+    iss >> record.type >> record.idx >> record.size >> record.hash;
+    return !iss.fail() && ((record.type == "done") || (record.type == "part")) && (record.hash.length() == 16);
+}
+
+std::string serialiseRecord(const Record& record)
+{
+    return record.type + ' ' + std::to_string(record.idx) + ' ' + std::to_string(record.size) + ' ' + record.hash + '\n';
+}
+
+// hashes the next `size` bytes of the stream
+bool hashStream(std::istream& is, uint64_t size, std::string& hash)
+{
+    constexpr size_t bufferSize = 1024 * 1024;
+    std::vector<char> buffer(bufferSize);
+
+    uint64_t h = util::fnv1a64(nullptr, 0);
+
+    while (size > 0)
+    {
+        const size_t n = (size_t)std::min<uint64_t>(size, bufferSize);
+        if (!is.read(buffer.data(), (std::streamsize)n)) return false;
+
+        h = util::fnv1a64(buffer.data(), n, h);
+        size -= n;
+    }
+
+    hash = util::toHexStr(h);
+
+    return true;
+}
+
+} // namespace
+
+
+
+util::DownloadJournal::DownloadJournal(const std::filesystem::path& file)
+    : m_file(file), m_ofs()
+{}
+
+util::DownloadJournal::State util::DownloadJournal::resume(const std::string& jobId, const std::filesystem::path& outFile)
+{
+    State r;
+    std::vector<::Record> records;
+
+    {
+        std::ifstream ifs(m_file, std::ios::in | std::ios::binary);
+        std::string line;
+
+        if (ifs.good() && std::getline(ifs, line) && (line == ::magicLine) && std::getline(ifs, line) && (line == ("job " + jobId)))
+        {
+            // an interrupted write leaves an incomplete last line, which ends the list
+            ::Record record;
+            while (std::getline(ifs, line) && !ifs.eof() && ::parseRecord(line, record)) records.push_back(record);
+        }
+    }
+
+    // verify the recorded data
+    std::vector<::Record> verified;
+
+    if (!records.empty() && fs::exists(outFile))
+    {
+        std::ifstream ifs(outFile, std::ios::in | std::ios::binary);
+        uint64_t partialBytes = 0;
+
+        for (const auto& record : records)
+        {
+            std::string hash;
+            if ((record.idx != r.segments) || !::hashStream(ifs, record.size, hash) || (hash != record.hash)) break;
+
+            verified.push_back(record);
+
+            if (record.type == "done")
+            {
+                ++r.segments;
+                r.bytes += partialBytes + record.size;
+                partialBytes = 0;
+            }
+            else partialBytes += record.size;
+        }
+
+        r.partialBytes = partialBytes;
+    }
+
+    const uint64_t end = r.bytes + r.partialBytes;
+
+    if (fs::exists(outFile) && (fs::file_size(outFile) != end)) fs::resize_file(outFile, end);
+
+    // rewrite the journal with the verified records only
+    const fs::path tmpFile = m_file.u8string() + ".tmp";
+
+    {
+        std::ofstream ofs;
+        ofs.exceptions(std::ios::badbit | std::ios::failbit | std::ios::eofbit);
+        ofs.open(tmpFile, std::ios::out | std::ios::binary | std::ios::trunc);
+
+        ofs << ::magicLine << '\n';
+        ofs << "job " << jobId << '\n';
+        for (const auto& record : verified) ofs << ::serialiseRecord(record);
+
+        ofs.close();
+    }
+
+    fs::rename(tmpFile, m_file);
+
+    m_ofs = std::ofstream();
+    m_ofs.exceptions(std::ios::badbit | std::ios::failbit | std::ios::eofbit);
+    m_ofs.open(m_file, std::ios::out | std::ios::binary | std::ios::app);
+
+    return r;
+}
+
+void util::DownloadJournal::addSegment(size_t idx, const char* data, size_t size) { m_add("done", idx, data, size); }
+
+void util::DownloadJournal::addPartial(size_t idx, const char* data, size_t size) { m_add("part", idx, data, size); }
+
+void util::DownloadJournal::remove()
+{
+    if (m_ofs.is_open()) m_ofs.close();
+    fs::remove(m_file);
+}
+
+void util::DownloadJournal::m_add(const char* type, size_t idx, const char* data, size_t size)
+{
+    ::Record record;
+    record.type = type;
+    record.idx = idx;
+    record.size = size;
+    record.hash = util::toHexStr(util::fnv1a64(data, size));
+
+    m_ofs << ::serialiseRecord(record);
+    m_ofs.flush();
+}
@@ -0,0 +1,70 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_DOWNLOADJOURNAL_H
+#define IG_MIDDLEWARE_DOWNLOADJOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+
+namespace util {
+
+// Records the segments which have been written to a download's output file, so that an interrupted download can be resumed. Each record
+// holds the size and the checksum of a segment, the segments are stored back to back in the output file. The last record may be a
+// partially downloaded segment.
+class DownloadJournal
+{
+public:
+    class State
+    {
+    public:
+        State()
+            : segments(0), bytes(0), partialBytes(0)
+        {}
+
+        virtual ~State() {}
+
+        size_t segments;       // number of complete segments
+        uint64_t bytes;        // size of the complete segments, the partial segment follows at this offset
+        uint64_t partialBytes; // already downloaded bytes of segment `segments`
+    };
+
+public:
+    DownloadJournal() = delete;
+    explicit DownloadJournal(const std::filesystem::path& file);
+    virtual ~DownloadJournal() {}
+
+    const std::filesystem::path& file() const { return m_file; }
+
+    // Reads the journal and verifies the recorded segments against `outFile`, the output file is truncated to the verified part. An empty
+    // state is returned if the journal does not exist or belongs to another job. The journal is open for appending afterwards.
+    util::DownloadJournal::State resume(const std::string& jobId, const std::filesystem::path& outFile);
+
+    // the data has to be flushed to the output file before it is recorded
+    void addSegment(size_t idx, const char* data, size_t size);
+    void addPartial(size_t idx, const char* data, size_t size);
+
+    // closes and deletes the journal file
+    void remove();
+
+private:
+    std::filesystem::path m_file;
+    std::ofstream m_ofs;
+
+    void m_add(const char* type, size_t idx, const char* data, size_t size);
+
+    DownloadJournal(const DownloadJournal& other) = delete;
+    DownloadJournal& operator=(const DownloadJournal&);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_DOWNLOADJOURNAL_H
@@ -0,0 +1,148 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "export-manifest.h"
+#include "hash.h"
+
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* const magicLine = "m3u-tool export manifest 1";
+
+// target, size, mtime, hash ("-" if none) and source separated by tabs, the source is last because it may contain any other character
+bool parseRecord(const std::string& line, util::ExportManifest::Record& record)
+{
+    std::vector<std::string> fields;
+    size_t pos = 0;
+
+    while (fields.size() < 4)
+    {
+        const size_t tab = line.find('\t', pos);
+        if (tab == std::string::npos) return false;
+
+        fields.push_back(line.substr(pos, tab - pos));
+        pos = tab + 1;
+    }
+
+    try
+    {
+        size_t idx;
+
+        record.target = fields[0];
+        record.size = std::stoull(fields[1], &idx);
+        if (idx != fields[1].length()) return false;
+        record.mtime = std::stoll(fields[2], &idx);
+        if (idx != fields[2].length()) return false;
+        record.hash = (fields[3] == "-" ? std::string() : fields[3]);
+        record.source = line.substr(pos);
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    return (!record.target.empty() && !record.source.empty() && (record.target.find('/') == std::string::npos) &&
+            (record.target.find('\\') == std::string::npos) && (record.target != ".") && (record.target != ".."));
+}
+
+std::string serialiseRecord(const util::ExportManifest::Record& record)
+{
+    return record.target + '\t' + std::to_string(record.size) + '\t' + std::to_string(record.mtime) + '\t' +
+           (record.hash.empty() ? std::string("-") : record.hash) + '\t' + record.source + '\n';
+}
+
+} // namespace
+
+
+
+bool util::ExportManifest::Record::sameSource(const util::ExportManifest::Record& other) const
+{
+    return ((size == other.size) && (mtime == other.mtime) && (hash.empty() || other.hash.empty() || (hash == other.hash)));
+}
+
+util::ExportManifest::ExportManifest(const std::filesystem::path& file)
+    : m_file(file), m_records()
+{}
+
+void util::ExportManifest::load()
+{
+    m_records.clear();
+
+    std::ifstream ifs(m_file, std::ios::in | std::ios::binary);
+    std::string line;
+
+    if (ifs.good() && std::getline(ifs, line) && (line == ::magicLine))
+    {
+        Record record;
+
+        while (std::getline(ifs, line))
+        {
+            if (::parseRecord(line, record)) m_records.push_back(record);
+        }
+    }
+}
+
+void util::ExportManifest::save() const
+{
+    const fs::path tmpFile = m_file.u8string() + ".tmp";
+
+    {
+        std::ofstream ofs;
+        ofs.exceptions(std::ios::badbit | std::ios::failbit | std::ios::eofbit);
+        ofs.open(tmpFile, std::ios::out | std::ios::binary | std::ios::trunc);
+
+        ofs << ::magicLine << '\n';
+        for (const auto& record : m_records) ofs << ::serialiseRecord(record);
+
+        ofs.close();
+    }
+
+    fs::rename(tmpFile, m_file);
+}
+
+util::ExportManifest::Record util::ExportManifest::sourceRecord(const std::filesystem::path& source, bool hash)
+{
+    Record r;
+
+    r.source = util::ExportManifest::sourceKey(source);
+    r.size = fs::file_size(source);
+    r.mtime = (int64_t)fs::last_write_time(source).time_since_epoch().count();
+
+    if (hash)
+    {
+        constexpr size_t bufferSize = 1024 * 1024;
+        std::vector<char> buffer(bufferSize);
+
+        std::ifstream ifs(source, std::ios::in | std::ios::binary);
+        if (!ifs.good()) throw std::runtime_error("failed to open \"" + source.u8string() + "\"");
+
+        util::Xxh64 h;
+
+        while (ifs)
+        {
+            ifs.read(buffer.data(), (std::streamsize)buffer.size());
+            h.update(buffer.data(), (size_t)ifs.gcount());
+        }
+
+        if (ifs.bad()) throw std::runtime_error("failed to read \"" + source.u8string() + "\"");
+
+        r.hash = util::toHexStr(h.digest());
+    }
+
+    return r;
+}
@@ -0,0 +1,80 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_EXPORTMANIFEST_H
+#define IG_MIDDLEWARE_EXPORTMANIFEST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace util {
+
+// Records the files of an export directory and the source files they were exported from, so that a later export into the same directory
+// only has to copy new or changed files. A source is considered unchanged if its size, modification time and, if recorded, content hash
+// are equal.
+class ExportManifest
+{
+public:
+    class Record
+    {
+    public:
+        Record()
+            : target(), source(), size(0), mtime(0), hash()
+        {}
+
+        virtual ~Record() {}
+
+        std::string target; // file name in the export directory
+        std::string source; // absolute path
+        uint64_t size;
+        int64_t mtime;    // std::filesystem::file_time_type ticks
+        std::string hash; // empty if not computed
+
+        // same size, modification time and hash (if both have one)
+        bool sameSource(const util::ExportManifest::Record& other) const;
+    };
+
+    static constexpr const char* fileName = ".m3u-tool-export";
+
+public:
+    ExportManifest() = delete;
+    explicit ExportManifest(const std::filesystem::path& file);
+    virtual ~ExportManifest() {}
+
+    const std::filesystem::path& file() const { return m_file; }
+
+    // Reads the manifest, empty if it doesn't exist or is not a manifest. Damaged records are skipped.
+    void load();
+
+    // writes the manifest atomically, throws on failure
+    void save() const;
+
+    const std::vector<util::ExportManifest::Record>& records() const { return m_records; }
+    void add(const util::ExportManifest::Record& record) { m_records.push_back(record); }
+    void clear() { m_records.clear(); }
+
+    // absolute and normalised path, identifies the source in the records
+    static std::string sourceKey(const std::filesystem::path& source) { return std::filesystem::absolute(source).lexically_normal().u8string(); }
+
+    // creates a record of an existing source file, the content is hashed (XXH64) if `hash` is set
+    static util::ExportManifest::Record sourceRecord(const std::filesystem::path& source, bool hash);
+
+private:
+    std::filesystem::path m_file;
+    std::vector<util::ExportManifest::Record> m_records;
+
+    ExportManifest(const ExportManifest& other) = delete;
+    ExportManifest& operator=(const ExportManifest&);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_EXPORTMANIFEST_H
@@ -0,0 +1,404 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "file-copy.h"
+#include "hash.h"
+
+#include <omw/defs.h>
+
+#ifdef OMW_PLAT_LINUX
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // OMW_PLAT_LINUX
+
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string errorStr(const fs::path& file, const std::string& what) { return "\"" + file.u8string() + "\": " + what; }
+
+#ifdef OMW_PLAT_LINUX
+
+constexpr size_t bufferSize = 4 * 1024 * 1024;
+constexpr size_t maxKernelChunk = 0x7FFFF000; // the most sendfile() transfers in one call
+
+class FileDescriptor
+{
+public:
+    FileDescriptor()
+        : fd(-1)
+    {}
+
+    explicit FileDescriptor(int fd_)
+        : fd(fd_)
+    {}
+
+    virtual ~FileDescriptor()
+    {
+        if (fd >= 0) close(fd);
+    }
+
+    int fd;
+
+private:
+    FileDescriptor(const FileDescriptor& other) = delete;
+    FileDescriptor& operator=(const FileDescriptor&);
+};
+
+// errors which mean that the method is not supported for these files, ENOTTY is returned by file systems without the FICLONE ioctl
+bool isUnsupported(int err) { return ((err == EXDEV) || (err == ENOSYS) || (err == EOPNOTSUPP) || (err == EINVAL) || (err == ENOTTY)); }
+
+#endif // OMW_PLAT_LINUX
+
+} // namespace
+
+
+
+util::FileCopier::FileCopier()
+    : m_methods(), m_mtx()
+{}
+
+util::FileCopier::Result util::FileCopier::copy(const std::filesystem::path& inFile, const std::filesystem::path& outFile, bool hash)
+{
+    Result r;
+
+    const auto tStart = std::chrono::steady_clock::now();
+    m_copy(inFile, outFile, hash, r);
+    r.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+
+    return r;
+}
+
+const char* util::FileCopier::toString(util::FileCopier::Method method)
+{
+    const char* r;
+
+    switch (method)
+    {
+    case Method::reflink:
+        r = "reflink";
+        break;
+
+    case Method::copyFileRange:
+        r = "copy_file_range";
+        break;
+
+    case Method::sendfile:
+        r = "sendfile";
+        break;
+
+    case Method::ioUring:
+        r = "io_uring";
+        break;
+
+    default:
+        r = "read/write";
+        break;
+    }
+
+    return r;
+}
+
+#ifdef OMW_PLAT_LINUX
+
+void util::FileCopier::m_copy(const std::filesystem::path& inFile, const std::filesystem::path& outFile, bool hash, util::FileCopier::Result& result)
+{
+    const ::FileDescriptor in(open(inFile.c_str(), O_RDONLY | O_CLOEXEC));
+
+    if (in.fd < 0)
+    {
+        result.error = ::errorStr(inFile, std::strerror(errno));
+        return;
+    }
+
+    struct stat st;
+
+    if (fstat(in.fd, &st) != 0)
+    {
+        result.error = ::errorStr(inFile, std::strerror(errno));
+        return;
+    }
+
+    if (!S_ISREG(st.st_mode))
+    {
+        result.error = ::errorStr(inFile, "not a regular file");
+        return;
+    }
+
+    ::FileDescriptor out(open(outFile.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, S_IWUSR));
+
+    if (out.fd < 0)
+    {
+        result.error = ::errorStr(outFile, std::strerror(errno));
+        return;
+    }
+
+    // the output file was created by this function, it's removed if the copy fails
+    const auto fail = [&result, &out, &outFile](const fs::path& file, const std::string& what) {
+        result.error = ::errorStr(file, what);
+        close(out.fd);
+        out.fd = -1;
+        unlink(outFile.c_str());
+    };
+
+    if (fchmod(out.fd, st.st_mode & 07777) != 0)
+    {
+        fail(outFile, std::strerror(errno));
+        return;
+    }
+
+    struct stat outSt;
+
+    if (fstat(out.fd, &outSt) != 0)
+    {
+        fail(outFile, std::strerror(errno));
+        return;
+    }
+
+    // whether a method works depends on the file systems, e.g. a reflink only works within one btrfs or XFS
+    const device_pair devices((uint64_t)st.st_dev, (uint64_t)outSt.st_dev);
+
+    // the data has to pass through user space to be hashed
+    int m = (hash ? (int)Method::readWrite : m_fastest(devices));
+    util::Xxh64 h;
+
+    if (hash) posix_fadvise(in.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    // lowers the method of this and all further copies between the same devices
+    const auto fallback = [this, &m, &devices](Method next) {
+        m = (int)next;
+        m_lower(devices, next);
+    };
+
+    if (m == (int)Method::reflink)
+    {
+        if (ioctl(out.fd, FICLONE, in.fd) == 0)
+        {
+            result.bytes = (uint64_t)st.st_size;
+            result.method = Method::reflink;
+            return;
+        }
+
+        // other errors (e.g. different extent sizes) only affect this file
+        if (::isUnsupported(errno)) fallback(Method::copyFileRange);
+        else m = (int)Method::copyFileRange;
+    }
+
+    std::vector<char> buffer;
+    uint64_t done = 0;
+
+    // up to the end of the file, which may differ from `st.st_size` if the file is being written
+    while (true)
+    {
+        loff_t inOff = (loff_t)done;
+        loff_t outOff = (loff_t)done;
+        ssize_t n;
+
+        if (m == (int)Method::copyFileRange)
+        {
+            n = copy_file_range(in.fd, &inOff, out.fd, &outOff, ::maxKernelChunk, 0);
+
+            if ((n < 0) && ::isUnsupported(errno))
+            {
+                fallback(Method::sendfile);
+                continue;
+            }
+        }
+        else if (m == (int)Method::sendfile)
+        {
+            // sendfile() writes at the file position of the output
+            n = (lseek(out.fd, outOff, SEEK_SET) < 0 ? -1 : sendfile(out.fd, in.fd, &inOff, ::maxKernelChunk));
+
+            if ((n < 0) && ::isUnsupported(errno))
+            {
+                fallback(Method::readWrite);
+                continue;
+            }
+        }
+        else
+        {
+            if (buffer.empty()) buffer.resize(::bufferSize);
+
+            n = pread(in.fd, buffer.data(), buffer.size(), inOff);
+
+            if (hash && (n > 0)) h.update(buffer.data(), (size_t)n);
+
+            size_t written = 0;
+
+            while ((n > 0) && (written < (size_t)n))
+            {
+                const ssize_t w = pwrite(out.fd, buffer.data() + written, (size_t)n - written, outOff + (loff_t)written);
+
+                if (w > 0) written += (size_t)w;
+                else if ((w < 0) && (errno == EINTR)) continue;
+                else
+                {
+                    fail(outFile, (w < 0 ? std::strerror(errno) : "write() wrote nothing"));
+                    return;
+                }
+            }
+        }
+
+        if (n > 0) done += (uint64_t)n;
+        else if (n == 0) break;
+        else if (errno != EINTR)
+        {
+            fail(inFile, std::strerror(errno));
+            return;
+        }
+    }
+
+    if (close(out.fd) != 0)
+    {
+        out.fd = -1;
+        fail(outFile, std::strerror(errno));
+        return;
+    }
+
+    out.fd = -1;
+
+    result.bytes = done;
+    result.method = (Method)m;
+
+    if (hash)
+    {
+        result.hashed = true;
+        result.hash = h.digest();
+    }
+}
+
+int util::FileCopier::m_fastest(const device_pair& devices)
+{
+    std::lock_guard<std::mutex> lg(m_mtx);
+
+    const auto it = m_methods.find(devices);
+    return (it != m_methods.end() ? it->second : (int)Method::reflink);
+}
+
+void util::FileCopier::m_lower(const device_pair& devices, util::FileCopier::Method method)
+{
+    std::lock_guard<std::mutex> lg(m_mtx);
+
+    int& m = m_methods.emplace(devices, (int)Method::reflink).first->second;
+    m = std::max(m, (int)method);
+}
+
+uint64_t util::readSample(const std::filesystem::path& file, uint64_t maxBytes)
+{
+    const ::FileDescriptor in(open(file.c_str(), O_RDONLY | O_CLOEXEC));
+    if (in.fd < 0) return 0;
+
+    posix_fadvise(in.fd, 0, (off_t)maxBytes, POSIX_FADV_DONTNEED);
+
+    std::vector<char> buffer(std::min<uint64_t>(::bufferSize, maxBytes));
+    uint64_t r = 0;
+
+    while (r < maxBytes)
+    {
+        const ssize_t n = read(in.fd, buffer.data(), (size_t)std::min<uint64_t>(buffer.size(), maxBytes - r));
+
+        if (n > 0) r += (uint64_t)n;
+        else if ((n == 0) || (errno != EINTR)) break;
+    }
+
+    posix_fadvise(in.fd, 0, (off_t)maxBytes, POSIX_FADV_DONTNEED);
+
+    return r;
+}
+
+#else // OMW_PLAT_LINUX
+
+void util::FileCopier::m_copy(const std::filesystem::path& inFile, const std::filesystem::path& outFile, bool hash, util::FileCopier::Result& result)
+{
+    std::error_code ec;
+
+    result.method = Method::readWrite;
+
+    if (!hash)
+    {
+        fs::copy_file(inFile, outFile, ec);
+
+        if (ec) result.error = ::errorStr(outFile, ec.message());
+        else result.bytes = fs::file_size(outFile, ec);
+
+        return;
+    }
+
+    if (fs::exists(outFile, ec))
+    {
+        result.error = ::errorStr(outFile, "file exists");
+        return;
+    }
+
+    std::ifstream ifs(inFile, std::ios::in | std::ios::binary);
+    std::ofstream ofs(outFile, std::ios::out | std::ios::binary);
+
+    if (!ifs.good()) result.error = ::errorStr(inFile, "failed to open");
+    else if (!ofs.good()) result.error = ::errorStr(outFile, "failed to open");
+    else
+    {
+        std::vector<char> buffer(4 * 1024 * 1024);
+        util::Xxh64 h;
+
+        while (ifs && ofs)
+        {
+            ifs.read(buffer.data(), (std::streamsize)buffer.size());
+            const size_t n = (size_t)ifs.gcount();
+
+            h.update(buffer.data(), n);
+            ofs.write(buffer.data(), (std::streamsize)n);
+            result.bytes += n;
+        }
+
+        ofs.close();
+
+        if (ifs.bad()) result.error = ::errorStr(inFile, "failed to read");
+        else if (ofs.fail()) result.error = ::errorStr(outFile, "failed to write");
+        else
+        {
+            result.hashed = true;
+            result.hash = h.digest();
+        }
+    }
+
+    if (!result.good()) fs::remove(outFile, ec);
+}
+
+uint64_t util::readSample(const std::filesystem::path& file, uint64_t maxBytes)
+{
+    std::ifstream ifs(file, std::ios::in | std::ios::binary);
+    std::vector<char> buffer(4 * 1024 * 1024);
+    uint64_t r = 0;
+
+    while (ifs && (r < maxBytes))
+    {
+        ifs.read(buffer.data(), (std::streamsize)std::min<uint64_t>(buffer.size(), maxBytes - r));
+        r += (uint64_t)ifs.gcount();
+    }
+
+    return r;
+}
+
+#endif // OMW_PLAT_LINUX
@@ -0,0 +1,91 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_FILECOPY_H
+#define IG_MIDDLEWARE_FILECOPY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+
+namespace util {
+
+// Copies whole files. On Linux the fastest method supported by the file systems is used: a reflink (FICLONE, shares the extents on btrfs
+// and XFS), copy_file_range() (in the kernel, server side on NFS 4.2), sendfile() and read()/write() with a large buffer as last fallback.
+// A method which isn't supported is skipped for all further copies of the object between the same source and destination device.
+class FileCopier
+{
+public:
+    // ordered from the fastest to the slowest
+    enum class Method
+    {
+        reflink,
+        copyFileRange,
+        sendfile,
+        readWrite,
+        ioUring, // not used by FileCopier, the result of util::UringCopier
+    };
+
+    class Result
+    {
+    public:
+        Result()
+            : bytes(0), duration(0), method(Method::reflink), hashed(false), hash(0), error()
+        {}
+
+        virtual ~Result() {}
+
+        uint64_t bytes;
+        double duration;                 // [s]
+        util::FileCopier::Method method; // slowest method used
+        bool hashed;
+        uint64_t hash; // XXH64 of the copied data
+        std::string error;
+
+        bool good() const { return error.empty(); }
+
+        // [B/s], 0 if the duration is too short to be measured
+        double throughput() const { return (duration > 0 ? ((double)bytes / duration) : 0); }
+    };
+
+public:
+    FileCopier();
+    virtual ~FileCopier() {}
+
+    // Creates `outFile` with the content and permissions of `inFile`, fails if `outFile` exists. With `hash` the data is copied with
+    // read()/write() and hashed on the way, so that it's read only once. Thread safe.
+    util::FileCopier::Result copy(const std::filesystem::path& inFile, const std::filesystem::path& outFile, bool hash = false);
+
+    static const char* toString(util::FileCopier::Method method);
+
+private:
+    using device_pair = std::pair<uint64_t, uint64_t>; // source and destination st_dev
+
+    std::map<device_pair, int> m_methods; // the fastest method which may work, lowered by failures
+    std::mutex m_mtx;
+
+    int m_fastest(const device_pair& devices);
+    void m_lower(const device_pair& devices, util::FileCopier::Method method);
+
+    void m_copy(const std::filesystem::path& inFile, const std::filesystem::path& outFile, bool hash, util::FileCopier::Result& result);
+
+    FileCopier(const FileCopier& other) = delete;
+    FileCopier& operator=(const FileCopier&);
+};
+
+// Reads up to `maxBytes` from the beginning of `file` and returns the number of bytes read, used to sample the read throughput. On Linux
+// the pages are dropped from the page cache before and after, so that the sample is read from the storage device and doesn't stay cached.
+uint64_t readSample(const std::filesystem::path& file, uint64_t maxBytes);
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_FILECOPY_H
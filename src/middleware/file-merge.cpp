@@ -0,0 +1,399 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "file-merge.h"
+#include "worker-pool.h"
+
+#include <omw/defs.h>
+
+#ifdef OMW_PLAT_LINUX
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // OMW_PLAT_LINUX
+
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t bufferSize = 1024 * 1024;
+constexpr size_t maxKernelChunk = 1024 * 1024 * 1024; // bytes per copy_file_range() call, the kernel limits it anyway
+
+std::string errorStr(const fs::path& file, const std::string& what) { return "\"" + file.u8string() + "\": " + what; }
+
+#ifdef OMW_PLAT_LINUX
+
+class FileDescriptor
+{
+public:
+    FileDescriptor()
+        : fd(-1)
+    {}
+
+    explicit FileDescriptor(int fd_)
+        : fd(fd_)
+    {}
+
+    virtual ~FileDescriptor()
+    {
+        if (fd >= 0) close(fd);
+    }
+
+    int fd;
+
+private:
+    FileDescriptor(const FileDescriptor& other) = delete;
+    FileDescriptor& operator=(const FileDescriptor&);
+};
+
+// errors which mean that the method is not supported for these files
+bool isUnsupported(int err) { return ((err == EXDEV) || (err == ENOSYS) || (err == EOPNOTSUPP) || (err == EINVAL)); }
+
+#endif // OMW_PLAT_LINUX
+
+} // namespace
+
+
+
+util::FileMerger::FileMerger(size_t workers)
+    : m_workers(workers > 0 ? workers : 1)
+{}
+
+util::FileMerger::Result util::FileMerger::merge(const std::vector<util::MergeSource>& sources, const std::filesystem::path& outFile, bool append)
+{
+    Result r;
+    r.files = sources.size();
+
+    // output offsets
+    std::vector<uint64_t> lengths(sources.size());
+    std::vector<uint64_t> offsets(sources.size() + 1);
+
+    std::error_code ec;
+    offsets[0] = ((append && fs::exists(outFile)) ? fs::file_size(outFile) : 0);
+
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        const auto& src = sources[i];
+
+        const uint64_t size = fs::file_size(src.file, ec);
+        if (ec)
+        {
+            r.error = ::errorStr(src.file, ec.message());
+            return r;
+        }
+
+        const uint64_t begin = (uint64_t)std::max<int64_t>(src.offset, 0);
+        const uint64_t length = (src.length < 0 ? (size > begin ? (size - begin) : 0) : (uint64_t)src.length);
+
+        if ((begin + length) > size)
+        {
+            r.error = ::errorStr(src.file, "range " + std::to_string(begin) + "+" + std::to_string(length) + " exceeds the file size");
+            return r;
+        }
+
+        lengths[i] = length;
+        offsets[i + 1] = offsets[i] + length;
+    }
+
+    // an existing output file may be a hard link, it's replaced and not overwritten
+    if (!append) fs::remove(outFile, ec);
+
+    // allocate the output file, the sources are written to their offsets
+    {
+        std::ofstream ofs(outFile, std::ios::out | std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+
+        if (!ofs.good())
+        {
+            r.error = ::errorStr(outFile, "failed to open");
+            return r;
+        }
+    }
+
+    fs::resize_file(outFile, offsets.back(), ec);
+    if (ec)
+    {
+        r.error = ::errorStr(outFile, ec.message());
+        return r;
+    }
+
+    std::string error;
+    size_t errorIdx = sources.size();
+    int slowest = (int)Method::copyFileRange;
+    std::mutex mtx;
+
+    const auto copy = [&](size_t idx) {
+        Method method = Method::copyFileRange;
+        std::string err;
+
+        const bool ok = m_copy(sources[idx].file, std::max<int64_t>(sources[idx].offset, 0), outFile, (int64_t)offsets[idx], lengths[idx], method, err);
+
+        std::lock_guard<std::mutex> lg(mtx);
+
+        slowest = std::max(slowest, (int)method);
+
+        if (!ok && (idx < errorIdx))
+        {
+            error = err;
+            errorIdx = idx;
+        }
+    };
+
+    if ((m_workers == 1) || (sources.size() < 2))
+    {
+        for (size_t i = 0; (i < sources.size()) && error.empty(); ++i) copy(i);
+    }
+    else
+    {
+        util::WorkerPool pool(std::min(m_workers, sources.size()));
+        for (size_t i = 0; i < sources.size(); ++i) pool.submit([&copy, i]() { copy(i); });
+        pool.wait();
+    }
+
+    r.method = (Method)slowest;
+    r.error = error;
+
+    // keep the sources before the failed one
+    if (!error.empty()) fs::resize_file(outFile, offsets[errorIdx], ec);
+
+    r.bytes = offsets[errorIdx] - offsets[0];
+
+    return r;
+}
+
+const char* util::FileMerger::toString(util::FileMerger::Method method)
+{
+    const char* r;
+
+    switch (method)
+    {
+    case Method::copyFileRange:
+        r = "copy_file_range";
+        break;
+
+    case Method::splice:
+        r = "splice";
+        break;
+
+    default:
+        r = "read/write";
+        break;
+    }
+
+    return r;
+}
+
+#ifdef OMW_PLAT_LINUX
+
+bool util::FileMerger::m_copy(const std::filesystem::path& inFile, int64_t inOffset, const std::filesystem::path& outFile, int64_t outOffset,
+                              uint64_t count, util::FileMerger::Method& method, std::string& error)
+{
+    const ::FileDescriptor in(open(inFile.c_str(), O_RDONLY | O_CLOEXEC));
+    const ::FileDescriptor out(open(outFile.c_str(), O_WRONLY | O_CLOEXEC));
+
+    if (in.fd < 0)
+    {
+        error = ::errorStr(inFile, std::strerror(errno));
+        return false;
+    }
+
+    if (out.fd < 0)
+    {
+        error = ::errorStr(outFile, std::strerror(errno));
+        return false;
+    }
+
+    // the fallback only applies to this source, the sources may be on different file systems
+    int m = (int)Method::copyFileRange;
+
+    const auto fallback = [&m](Method next) { m = (int)next; };
+
+    ::FileDescriptor pipeRd, pipeWr;
+    std::vector<char> buffer;
+    uint64_t done = 0;
+
+    while (done < count)
+    {
+        const uint64_t remaining = count - done;
+        loff_t inOff = inOffset + (loff_t)done;
+        loff_t outOff = outOffset + (loff_t)done;
+
+        if (m == (int)Method::copyFileRange)
+        {
+            const ssize_t n = copy_file_range(in.fd, &inOff, out.fd, &outOff, (size_t)std::min<uint64_t>(remaining, ::maxKernelChunk), 0);
+
+            if (n > 0) done += (uint64_t)n;
+            else if (n == 0) break;
+            else if (errno == EINTR) continue;
+            else if (::isUnsupported(errno)) fallback(Method::splice);
+            else
+            {
+                error = ::errorStr(inFile, std::strerror(errno));
+                return false;
+            }
+        }
+        else if (m == (int)Method::splice)
+        {
+            if (pipeRd.fd < 0)
+            {
+                int fds[2];
+
+                if (pipe2(fds, O_CLOEXEC) != 0)
+                {
+                    fallback(Method::readWrite);
+                    continue;
+                }
+
+                pipeRd.fd = fds[0];
+                pipeWr.fd = fds[1];
+            }
+
+            const ssize_t n = splice(in.fd, &inOff, pipeWr.fd, nullptr, (size_t)std::min<uint64_t>(remaining, ::bufferSize), SPLICE_F_MOVE);
+
+            if (n == 0) break;
+            if (n < 0)
+            {
+                if (::isUnsupported(errno)) fallback(Method::readWrite);
+                else if (errno != EINTR)
+                {
+                    error = ::errorStr(inFile, std::strerror(errno));
+                    return false;
+                }
+
+                continue;
+            }
+
+            // drain the pipe completely, so that a fallback starts with an empty pipe
+            size_t inPipe = (size_t)n;
+
+            while (inPipe > 0)
+            {
+                const ssize_t w = splice(pipeRd.fd, nullptr, out.fd, &outOff, inPipe, SPLICE_F_MOVE);
+
+                if (w > 0)
+                {
+                    inPipe -= (size_t)w;
+                    done += (uint64_t)w;
+                }
+                else if ((w < 0) && (errno == EINTR)) continue;
+                else
+                {
+                    error = ::errorStr(outFile, (w < 0 ? std::strerror(errno) : "splice() wrote nothing"));
+                    return false;
+                }
+            }
+        }
+        else
+        {
+            if (buffer.empty()) buffer.resize(::bufferSize);
+
+            const ssize_t n = pread(in.fd, buffer.data(), (size_t)std::min<uint64_t>(remaining, buffer.size()), inOff);
+
+            if (n == 0) break;
+            if (n < 0)
+            {
+                if (errno == EINTR) continue;
+
+                error = ::errorStr(inFile, std::strerror(errno));
+                return false;
+            }
+
+            size_t written = 0;
+
+            while (written < (size_t)n)
+            {
+                const ssize_t w = pwrite(out.fd, buffer.data() + written, (size_t)n - written, outOff + (loff_t)written);
+
+                if (w > 0) written += (size_t)w;
+                else if ((w < 0) && (errno == EINTR)) continue;
+                else
+                {
+                    error = ::errorStr(outFile, (w < 0 ? std::strerror(errno) : "write() wrote nothing"));
+                    return false;
+                }
+            }
+
+            done += (uint64_t)n;
+        }
+    }
+
+    method = (Method)m;
+
+    if (done < count)
+    {
+        error = ::errorStr(inFile, "unexpected end of file");
+        return false;
+    }
+
+    return true;
+}
+
+#else // OMW_PLAT_LINUX
+
+bool util::FileMerger::m_copy(const std::filesystem::path& inFile, int64_t inOffset, const std::filesystem::path& outFile, int64_t outOffset,
+                              uint64_t count, util::FileMerger::Method& method, std::string& error)
+{
+    method = Method::readWrite;
+
+    std::ifstream ifs(inFile, std::ios::in | std::ios::binary);
+    std::fstream ofs(outFile, std::ios::in | std::ios::out | std::ios::binary);
+
+    if (!ifs.good() || !ifs.seekg(inOffset))
+    {
+        error = ::errorStr(inFile, "failed to open");
+        return false;
+    }
+
+    if (!ofs.good() || !ofs.seekp(outOffset))
+    {
+        error = ::errorStr(outFile, "failed to open");
+        return false;
+    }
+
+    std::vector<char> buffer(std::min<uint64_t>(count, ::bufferSize));
+
+    while (count > 0)
+    {
+        const size_t n = (size_t)std::min<uint64_t>(count, buffer.size());
+
+        if (!ifs.read(buffer.data(), (std::streamsize)n))
+        {
+            error = ::errorStr(inFile, "unexpected end of file");
+            return false;
+        }
+
+        if (!ofs.write(buffer.data(), (std::streamsize)n))
+        {
+            error = ::errorStr(outFile, "failed to write");
+            return false;
+        }
+
+        count -= n;
+    }
+
+    ofs.close();
+
+    if (ofs.fail())
+    {
+        error = ::errorStr(outFile, "failed to write");
+        return false;
+    }
+
+    return true;
+}
+
+#endif // OMW_PLAT_LINUX
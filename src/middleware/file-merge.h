@@ -0,0 +1,93 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_FILEMERGE_H
+#define IG_MIDDLEWARE_FILEMERGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+namespace util {
+
+// A file or a byte range of a file.
+class MergeSource
+{
+public:
+    MergeSource()
+        : file(), offset(0), length(-1)
+    {}
+
+    MergeSource(const std::filesystem::path& file_, int64_t offset_ = 0, int64_t length_ = -1)
+        : file(file_), offset(offset_), length(length_)
+    {}
+
+    virtual ~MergeSource() {}
+
+    std::filesystem::path file;
+    int64_t offset;
+    int64_t length; // -1 up to the end of the file
+};
+
+// Concatenates files into one file. The output offset of each source is computed in advance from the file sizes, which allows the
+// sources to be copied concurrently and in any order. On Linux the data is copied in the kernel with copy_file_range(), or splice()
+// through a pipe if the file systems don't support it, read()/write() is the last fallback.
+class FileMerger
+{
+public:
+    // ordered from the fastest to the slowest
+    enum class Method
+    {
+        copyFileRange,
+        splice,
+        readWrite,
+    };
+
+    class Result
+    {
+    public:
+        Result()
+            : files(0), bytes(0), method(Method::copyFileRange), error()
+        {}
+
+        virtual ~Result() {}
+
+        size_t files;
+        uint64_t bytes;
+        util::FileMerger::Method method; // slowest method used
+        std::string error;
+
+        bool good() const { return error.empty(); }
+    };
+
+public:
+    FileMerger() = delete;
+    explicit FileMerger(size_t workers);
+    virtual ~FileMerger() {}
+
+    // `append` adds the sources to the end of an existing file
+    util::FileMerger::Result merge(const std::vector<util::MergeSource>& sources, const std::filesystem::path& outFile, bool append = false);
+
+    static const char* toString(util::FileMerger::Method method);
+
+private:
+    size_t m_workers;
+
+    // `method` is set to the method which was used
+    bool m_copy(const std::filesystem::path& inFile, int64_t inOffset, const std::filesystem::path& outFile, int64_t outOffset, uint64_t count,
+                util::FileMerger::Method& method, std::string& error);
+
+    FileMerger(const FileMerger& other) = delete;
+    FileMerger& operator=(const FileMerger&);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_FILEMERGE_H
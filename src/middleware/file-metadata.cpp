@@ -0,0 +1,182 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <system_error>
+#include <unordered_set>
+#include <vector>
+
+#include "file-metadata.h"
+#include "worker-pool.h"
+
+#include <omw/defs.h>
+
+#ifdef OMW_PLAT_LINUX
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#endif // OMW_PLAT_LINUX
+
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// paths per task, so that the workers don't contend on the queue for every lookup
+constexpr size_t chunkSize = 16;
+
+#ifdef OMW_PLAT_LINUX
+
+// cleared if the kernel doesn't implement statx()
+std::atomic<bool> statxSupported(true);
+
+util::FileMetadata::Info::Type type(mode_t mode)
+{
+    using Type = util::FileMetadata::Info::Type;
+
+    if (S_ISREG(mode)) return Type::regular;
+    if (S_ISDIR(mode)) return Type::directory;
+    return Type::other;
+}
+
+bool lookupStatx(const fs::path& file, util::FileMetadata::Info& info)
+{
+    struct statx stx;
+
+    if (statx(AT_FDCWD, file.c_str(), AT_STATX_SYNC_AS_STAT, STATX_TYPE | STATX_SIZE | STATX_INO | STATX_MTIME, &stx) != 0)
+    {
+        if (errno == ENOSYS)
+        {
+            statxSupported = false;
+            return false;
+        }
+
+        info.error = errno;
+        return true;
+    }
+
+    info.type = ::type(stx.stx_mode);
+    info.size = stx.stx_size;
+    info.device = (uint64_t)makedev(stx.stx_dev_major, stx.stx_dev_minor);
+    info.inode = stx.stx_ino;
+    info.mtime = (int64_t)stx.stx_mtime.tv_sec * 1000000000 + stx.stx_mtime.tv_nsec;
+
+    return true;
+}
+
+void lookupStat(const fs::path& file, util::FileMetadata::Info& info)
+{
+    struct stat st;
+
+    if (stat(file.c_str(), &st) != 0)
+    {
+        info.error = errno;
+        return;
+    }
+
+    info.type = ::type(st.st_mode);
+    info.size = (uint64_t)st.st_size;
+    info.device = (uint64_t)st.st_dev;
+    info.inode = (uint64_t)st.st_ino;
+    info.mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+#endif // OMW_PLAT_LINUX
+
+} // namespace
+
+
+
+void util::FileMetadata::query(const std::vector<std::filesystem::path>& files, size_t workers)
+{
+    std::vector<fs::path> pending;
+    std::unordered_set<fs::path::string_type> seen;
+
+    for (const auto& file : files)
+    {
+        if ((m_table.count(file.native()) == 0) && seen.insert(file.native()).second) pending.push_back(file);
+    }
+
+    std::vector<Info> results(pending.size());
+
+    const size_t nChunks = (pending.size() + ::chunkSize - 1) / ::chunkSize;
+
+    if ((workers <= 1) || (nChunks < 2))
+    {
+        for (size_t i = 0; i < pending.size(); ++i) results[i] = lookup(pending[i]);
+    }
+    else
+    {
+        util::WorkerPool pool(std::min(workers, nChunks));
+
+        // every task writes to its own elements
+        for (size_t chunk = 0; chunk < nChunks; ++chunk)
+        {
+            pool.submit([&pending, &results, chunk]() {
+                const size_t end = std::min((chunk + 1) * ::chunkSize, pending.size());
+                for (size_t i = chunk * ::chunkSize; i < end; ++i) results[i] = lookup(pending[i]);
+            });
+        }
+
+        pool.wait();
+    }
+
+    for (size_t i = 0; i < pending.size(); ++i) m_table.emplace(pending[i].native(), results[i]);
+}
+
+util::FileMetadata::Info util::FileMetadata::get(const std::filesystem::path& file) const
+{
+    const auto it = m_table.find(file.native());
+    return (it != m_table.end() ? it->second : lookup(file));
+}
+
+#ifdef OMW_PLAT_LINUX
+
+util::FileMetadata::Info util::FileMetadata::lookup(const std::filesystem::path& file)
+{
+    Info r;
+
+    if (!::statxSupported || !::lookupStatx(file, r)) ::lookupStat(file, r);
+
+    return r;
+}
+
+#else // OMW_PLAT_LINUX
+
+util::FileMetadata::Info util::FileMetadata::lookup(const std::filesystem::path& file)
+{
+    Info r;
+    std::error_code ec;
+
+    const fs::file_status status = fs::status(file, ec);
+
+    if (ec || !fs::exists(status))
+    {
+        r.error = (ec ? ec.value() : ENOENT);
+        return r;
+    }
+
+    if (fs::is_regular_file(status))
+    {
+        r.type = Info::Type::regular;
+        r.size = fs::file_size(file, ec);
+    }
+    else if (fs::is_directory(status)) r.type = Info::Type::directory;
+    else r.type = Info::Type::other;
+
+    const fs::file_time_type mtime = fs::last_write_time(file, ec);
+    if (!ec) r.mtime = (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(mtime.time_since_epoch()).count();
+
+    return r;
+}
+
+#endif // OMW_PLAT_LINUX
@@ -0,0 +1,86 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_FILEMETADATA_H
+#define IG_MIDDLEWARE_FILEMETADATA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+
+namespace util {
+
+// Metadata of the files referenced by a playlist, looked up once in a batch and then read from the table.
+//
+// Each lookup is a single statx() call (stat() on kernels without it, std::filesystem on other platforms). On network file systems
+// every call is a round trip, so the lookups are spread over a number of threads.
+class FileMetadata
+{
+public:
+    static constexpr size_t defaultWorkers = 16;
+
+    class Info
+    {
+    public:
+        enum class Type
+        {
+            none, // doesn't exist or the lookup failed
+            regular,
+            directory,
+            other,
+        };
+
+    public:
+        Info()
+            : error(0), type(Type::none), size(0), device(0), inode(0), mtime(0)
+        {}
+
+        virtual ~Info() {}
+
+        int error; // errno of the lookup, 0 if the file exists
+        Type type;
+        uint64_t size;
+        uint64_t device; // st_dev, 0 if unknown (not Linux)
+        uint64_t inode;  // 0 if unknown (not Linux)
+        int64_t mtime; // [ns] since the Unix epoch on Linux, of std::filesystem::file_time_type otherwise
+
+        bool exists() const { return (type != Type::none); }
+        bool isRegular() const { return (type == Type::regular); }
+        bool isDirectory() const { return (type == Type::directory); }
+
+        // device and inode identify the file
+        bool hasFileId() const { return (inode != 0); }
+    };
+
+public:
+    FileMetadata()
+        : m_table()
+    {}
+
+    virtual ~FileMetadata() {}
+
+    // looks up the files which are not yet in the table, duplicates are looked up once
+    void query(const std::vector<std::filesystem::path>& files, size_t workers = defaultWorkers);
+
+    // from the table, looked up directly if it's not in there
+    util::FileMetadata::Info get(const std::filesystem::path& file) const;
+
+    size_t size() const { return m_table.size(); }
+    void clear() { m_table.clear(); }
+
+    static util::FileMetadata::Info lookup(const std::filesystem::path& file);
+
+private:
+    std::unordered_map<std::filesystem::path::string_type, util::FileMetadata::Info> m_table;
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_FILEMETADATA_H
@@ -0,0 +1,256 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "hash.h"
+
+
+namespace {
+
+// tables of the slicing-by-8 algorithm, table[0] is the classic byte-wise table
+class Crc32Tables
+{
+public:
+    Crc32Tables()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) crc = ((crc & 1) ? ((crc >> 1) ^ 0xEDB88320u) : (crc >> 1));
+            table[0][i] = crc;
+        }
+
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            for (size_t t = 1; t < 8; ++t) table[t][i] = (table[t - 1][i] >> 8) ^ table[0][table[t - 1][i] & 0xFF];
+        }
+    }
+
+    uint32_t table[8][256];
+};
+
+const Crc32Tables crc32Tables;
+
+constexpr uint64_t xxhPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t xxhPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t xxhPrime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t xxhPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t xxhPrime5 = 0x27D4EB2F165667C5ull;
+
+inline uint64_t rotl64(uint64_t x, int r) { return ((x << r) | (x >> (64 - r))); }
+
+// little endian, independent of the alignment
+inline uint64_t read64(const uint8_t* p)
+{
+    uint64_t r;
+    std::memcpy(&r, p, sizeof(r));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    r = __builtin_bswap64(r);
+#endif
+    return r;
+}
+
+inline uint32_t read32(const uint8_t* p)
+{
+    uint32_t r;
+    std::memcpy(&r, p, sizeof(r));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    r = __builtin_bswap32(r);
+#endif
+    return r;
+}
+
+inline uint64_t xxhRound(uint64_t acc, uint64_t input)
+{
+    acc += input * ::xxhPrime2;
+    acc = ::rotl64(acc, 31);
+    return acc * ::xxhPrime1;
+}
+
+inline uint64_t xxhMergeRound(uint64_t acc, uint64_t val)
+{
+    acc ^= ::xxhRound(0, val);
+    return acc * ::xxhPrime1 + ::xxhPrime4;
+}
+
+} // namespace
+
+
+
+uint64_t util::fnv1a64(const void* data, size_t size, uint64_t seed)
+{
+    constexpr uint64_t prime = 0x00000100000001b3ull;
+
+    const uint8_t* p = (const uint8_t*)data;
+    const uint8_t* const pEnd = p + size;
+
+    uint64_t h = seed;
+
+    while (p < pEnd)
+    {
+        h ^= *p;
+        h *= prime;
+        ++p;
+    }
+
+    return h;
+}
+
+uint32_t util::crc32(const void* data, size_t size, uint32_t crc)
+{
+    const auto& t = ::crc32Tables.table;
+
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t c = ~crc;
+
+    while (size >= 8)
+    {
+        const uint32_t lo = c ^ ((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+        const uint32_t hi = ((uint32_t)p[4] | ((uint32_t)p[5] << 8) | ((uint32_t)p[6] << 16) | ((uint32_t)p[7] << 24));
+
+        c = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+            t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+
+        p += 8;
+        size -= 8;
+    }
+
+    while (size > 0)
+    {
+        c = t[0][(c ^ *p) & 0xFF] ^ (c >> 8);
+        ++p;
+        --size;
+    }
+
+    return ~c;
+}
+
+util::Xxh64::Xxh64(uint64_t seed)
+    : m_seed(seed), m_totalLen(0), m_bufferSize(0)
+{
+    m_v[0] = seed + ::xxhPrime1 + ::xxhPrime2;
+    m_v[1] = seed + ::xxhPrime2;
+    m_v[2] = seed;
+    m_v[3] = seed - ::xxhPrime1;
+}
+
+void util::Xxh64::update(const void* data, size_t size)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    const uint8_t* const pEnd = p + size;
+
+    m_totalLen += size;
+
+    if ((m_bufferSize + size) < sizeof(m_buffer))
+    {
+        if (size > 0) std::memcpy(m_buffer + m_bufferSize, p, size);
+        m_bufferSize += size;
+        return;
+    }
+
+    if (m_bufferSize > 0)
+    {
+        const size_t n = sizeof(m_buffer) - m_bufferSize;
+        std::memcpy(m_buffer + m_bufferSize, p, n);
+        p += n;
+
+        for (size_t i = 0; i < 4; ++i) m_v[i] = ::xxhRound(m_v[i], ::read64(m_buffer + 8 * i));
+
+        m_bufferSize = 0;
+    }
+
+    // stripes of 32 bytes
+    uint64_t v1 = m_v[0], v2 = m_v[1], v3 = m_v[2], v4 = m_v[3];
+
+    while ((pEnd - p) >= 32)
+    {
+        v1 = ::xxhRound(v1, ::read64(p));
+        v2 = ::xxhRound(v2, ::read64(p + 8));
+        v3 = ::xxhRound(v3, ::read64(p + 16));
+        v4 = ::xxhRound(v4, ::read64(p + 24));
+        p += 32;
+    }
+
+    m_v[0] = v1;
+    m_v[1] = v2;
+    m_v[2] = v3;
+    m_v[3] = v4;
+
+    m_bufferSize = (size_t)(pEnd - p);
+    if (m_bufferSize > 0) std::memcpy(m_buffer, p, m_bufferSize);
+}
+
+uint64_t util::Xxh64::digest() const
+{
+    uint64_t h;
+
+    if (m_totalLen >= 32)
+    {
+        h = ::rotl64(m_v[0], 1) + ::rotl64(m_v[1], 7) + ::rotl64(m_v[2], 12) + ::rotl64(m_v[3], 18);
+        for (size_t i = 0; i < 4; ++i) h = ::xxhMergeRound(h, m_v[i]);
+    }
+    else h = m_seed + ::xxhPrime5;
+
+    h += m_totalLen;
+
+    const uint8_t* p = m_buffer;
+    const uint8_t* const pEnd = m_buffer + m_bufferSize;
+
+    while ((pEnd - p) >= 8)
+    {
+        h ^= ::xxhRound(0, ::read64(p));
+        h = ::rotl64(h, 27) * ::xxhPrime1 + ::xxhPrime4;
+        p += 8;
+    }
+
+    if ((pEnd - p) >= 4)
+    {
+        h ^= (uint64_t)::read32(p) * ::xxhPrime1;
+        h = ::rotl64(h, 23) * ::xxhPrime2 + ::xxhPrime3;
+        p += 4;
+    }
+
+    while (p < pEnd)
+    {
+        h ^= (uint64_t)(*p) * ::xxhPrime5;
+        h = ::rotl64(h, 11) * ::xxhPrime1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= ::xxhPrime2;
+    h ^= h >> 29;
+    h *= ::xxhPrime3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+uint64_t util::xxh64(const void* data, size_t size, uint64_t seed)
+{
+    util::Xxh64 h(seed);
+    h.update(data, size);
+    return h.digest();
+}
+
+std::string util::toHexStr(uint64_t value)
+{
+    constexpr const char* digits = "0123456789abcdef";
+
+    std::string r(16, '0');
+
+    for (size_t i = 0; i < 16; ++i)
+    {
+        r[15 - i] = digits[value & 0x0F];
+        value >>= 4;
+    }
+
+    return r;
+}
@@ -0,0 +1,50 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_HASH_H
+#define IG_MIDDLEWARE_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+namespace util {
+
+// FNV-1a, used for file names, lookup keys and to detect damaged local data, not for authenticating data
+uint64_t fnv1a64(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+static inline uint64_t fnv1a64(const std::string& str) { return util::fnv1a64(str.data(), str.size()); }
+
+// CRC-32 (ISO-HDLC, as used by zip and gzip), `crc` is the result of the preceding data
+uint32_t crc32(const void* data, size_t size, uint32_t crc = 0);
+
+// XXH64, fast enough to be computed while copying files, the hex string of the value is compatible with xxhsum
+class Xxh64
+{
+public:
+    explicit Xxh64(uint64_t seed = 0);
+    virtual ~Xxh64() {}
+
+    void update(const void* data, size_t size);
+    uint64_t digest() const;
+
+private:
+    uint64_t m_v[4];
+    uint64_t m_seed;
+    uint64_t m_totalLen;
+    uint8_t m_buffer[32];
+    size_t m_bufferSize;
+};
+
+uint64_t xxh64(const void* data, size_t size, uint64_t seed = 0);
+
+// 16 lower case hex digits
+std::string toHexStr(uint64_t value);
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_HASH_H
@@ -0,0 +1,221 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include "hls-crypto.h"
+
+#include <openssl/evp.h>
+
+
+namespace {
+
+constexpr long keyConnectTimeout = 30; // [s]
+constexpr long keyTimeout = 60;        // [s]
+
+// EVP_*Update() takes an int size
+constexpr size_t maxChunkSize = 64 * 1024 * 1024;
+
+int hexDigit(char c)
+{
+    if ((c >= '0') && (c <= '9')) return (c - '0');
+    if ((c >= 'a') && (c <= 'f')) return (c - 'a' + 10);
+    if ((c >= 'A') && (c <= 'F')) return (c - 'A' + 10);
+    return -1;
+}
+
+} // namespace
+
+
+
+bool util::parseIV(const std::string& str, util::aes_block_t& iv)
+{
+    if ((str.length() < 3) || (str[0] != '0') || ((str[1] != 'x') && (str[1] != 'X'))) return false;
+
+    const std::string hex = str.substr(2);
+    if (hex.length() > 32) return false;
+
+    // shorter values are zero extended on the left
+    const std::string digits = std::string(32 - hex.length(), '0') + hex;
+
+    for (size_t i = 0; i < iv.size(); ++i)
+    {
+        const int hi = ::hexDigit(digits[2 * i]);
+        const int lo = ::hexDigit(digits[2 * i + 1]);
+        if ((hi < 0) || (lo < 0)) return false;
+
+        iv[i] = (uint8_t)((hi << 4) | lo);
+    }
+
+    return true;
+}
+
+util::aes_block_t util::sequenceIV(int64_t sequence)
+{
+    util::aes_block_t iv;
+    iv.fill(0);
+
+    uint64_t value = (uint64_t)sequence;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        iv[iv.size() - 1 - i] = (uint8_t)(value & 0xFF);
+        value >>= 8;
+    }
+
+    return iv;
+}
+
+
+
+util::Aes128Decryptor::Aes128Decryptor(const util::aes_block_t& key, const util::aes_block_t& iv)
+    : m_ctx(EVP_CIPHER_CTX_new())
+{
+    EVP_CIPHER_CTX* const ctx = (EVP_CIPHER_CTX*)m_ctx;
+
+    if (!ctx || (EVP_DecryptInit_ex(ctx, EVP_aes_128_cbc(), nullptr, key.data(), iv.data()) != 1))
+    {
+        EVP_CIPHER_CTX_free(ctx);
+        throw std::runtime_error("failed to initialise AES-128 decryption");
+    }
+}
+
+util::Aes128Decryptor::~Aes128Decryptor() { EVP_CIPHER_CTX_free((EVP_CIPHER_CTX*)m_ctx); }
+
+bool util::Aes128Decryptor::update(const char* data, size_t size, std::string& out)
+{
+    EVP_CIPHER_CTX* const ctx = (EVP_CIPHER_CTX*)m_ctx;
+
+    while (size > 0)
+    {
+        const size_t n = std::min(size, ::maxChunkSize);
+
+        const size_t pos = out.size();
+        out.resize(pos + n + EVP_MAX_BLOCK_LENGTH);
+
+        int outSize = 0;
+        if (EVP_DecryptUpdate(ctx, (unsigned char*)(out.data() + pos), &outSize, (const unsigned char*)data, (int)n) != 1)
+        {
+            out.resize(pos);
+            return false;
+        }
+
+        out.resize(pos + (size_t)outSize);
+
+        data += n;
+        size -= n;
+    }
+
+    return true;
+}
+
+bool util::Aes128Decryptor::final(std::string& out)
+{
+    const size_t pos = out.size();
+    out.resize(pos + EVP_MAX_BLOCK_LENGTH);
+
+    int outSize = 0;
+    const bool ok = (EVP_DecryptFinal_ex((EVP_CIPHER_CTX*)m_ctx, (unsigned char*)(out.data() + pos), &outSize) == 1);
+
+    out.resize(pos + (ok ? (size_t)outSize : 0));
+
+    return ok;
+}
+
+bool util::Aes128Decryptor::decrypt(std::string& data, const util::aes_block_t& key, const util::aes_block_t& iv)
+{
+    util::Aes128Decryptor decryptor(key, iv);
+
+    std::string plain;
+    plain.reserve(data.size() + EVP_MAX_BLOCK_LENGTH);
+
+    if (!decryptor.update(data.data(), data.size(), plain) || !decryptor.final(plain)) return false;
+
+    data.swap(plain);
+
+    return true;
+}
+
+
+
+util::KeyCache::KeyCache(util::Curl& curl)
+    : m_curl(curl), m_keys(), m_mtx()
+{}
+
+bool util::KeyCache::get(const std::string& keyUri, util::aes_block_t& key, std::string& error)
+{
+    std::shared_future<Entry> future;
+    std::promise<Entry> promise;
+    bool fetch = false;
+
+    {
+        std::lock_guard<std::mutex> lg(m_mtx);
+
+        const auto it = m_keys.find(keyUri);
+
+        if (it != m_keys.end()) future = it->second;
+        else
+        {
+            future = promise.get_future().share();
+            m_keys.emplace(keyUri, future);
+            fetch = true;
+        }
+    }
+
+    // a failed fetch is passed to the threads which are already waiting for it and removed, so that the next segment tries again
+    if (fetch)
+    {
+        try
+        {
+            const Entry entry = m_fetch(keyUri);
+            if (!entry.error.empty()) m_forget(keyUri);
+            promise.set_value(entry);
+        }
+        catch (...)
+        {
+            m_forget(keyUri);
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+    const Entry& entry = future.get();
+
+    key = entry.key;
+    error = entry.error;
+
+    return error.empty();
+}
+
+size_t util::KeyCache::fetched() const
+{
+    std::lock_guard<std::mutex> lg(m_mtx);
+    return m_keys.size();
+}
+
+void util::KeyCache::m_forget(const std::string& keyUri)
+{
+    std::lock_guard<std::mutex> lg(m_mtx);
+    m_keys.erase(keyUri);
+}
+
+util::KeyCache::Entry util::KeyCache::m_fetch(const std::string& keyUri)
+{
+    Entry r;
+
+    const util::HttpGetResponse res = m_curl.httpGETResume(util::HttpRequest(keyUri, ::keyConnectTimeout, ::keyTimeout), 3);
+
+    if (!res.good()) r.error = "key \"" + keyUri + "\": curl " + std::to_string(res.curlCode()) + ", HTTP " + std::to_string(res.httpCode());
+    else if (res.data().size() != r.key.size()) r.error = "key \"" + keyUri + "\" has " + std::to_string(res.data().size()) + " bytes";
+    else std::memcpy(r.key.data(), res.data().data(), r.key.size());
+
+    return r;
+}
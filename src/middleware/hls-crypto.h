@@ -0,0 +1,118 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_HLSCRYPTO_H
+#define IG_MIDDLEWARE_HLSCRYPTO_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "middleware/curl-helper.h"
+
+
+namespace util {
+
+typedef std::array<uint8_t, 16> aes_block_t;
+
+// parses the hexadecimal IV attribute of EXT-X-KEY (0x...)
+bool parseIV(const std::string& str, util::aes_block_t& iv);
+
+// IV of a segment without IV attribute, the media sequence number as big endian 128 bit integer
+util::aes_block_t sequenceIV(int64_t sequence);
+
+// Key and IV of an AES-128 encrypted segment (EXT-X-KEY:METHOD=AES-128), `keyUri` is empty for unencrypted segments.
+class SegmentKey
+{
+public:
+    SegmentKey()
+        : keyUri(), iv()
+    {}
+
+    SegmentKey(const std::string& keyUri_, const util::aes_block_t& iv_)
+        : keyUri(keyUri_), iv(iv_)
+    {}
+
+    virtual ~SegmentKey() {}
+
+    std::string keyUri;
+    util::aes_block_t iv;
+
+    bool isNone() const { return keyUri.empty(); }
+};
+
+// AES-128-CBC decryption with PKCS#7 padding, the data can be passed in chunks. The crypto library uses the AES instructions of the CPU
+// if available.
+class Aes128Decryptor
+{
+public:
+    Aes128Decryptor(const util::aes_block_t& key, const util::aes_block_t& iv);
+    virtual ~Aes128Decryptor();
+
+    // appends the decrypted data to `out`, up to one block is held back until the next call or final()
+    bool update(const char* data, size_t size, std::string& out);
+
+    // removes the padding, returns false if the data was not a multiple of the block size or the padding is invalid
+    bool final(std::string& out);
+
+    // decrypts a whole segment, `data` is replaced by the plain text
+    static bool decrypt(std::string& data, const util::aes_block_t& key, const util::aes_block_t& iv);
+
+private:
+    void* m_ctx;
+
+    Aes128Decryptor(const Aes128Decryptor& other) = delete;
+    Aes128Decryptor& operator=(const Aes128Decryptor&);
+};
+
+// Fetches each key URI once, thread safe. Concurrent requests of a key which is being fetched wait for the first request.
+class KeyCache
+{
+public:
+    KeyCache() = delete;
+    explicit KeyCache(util::Curl& curl);
+    virtual ~KeyCache() {}
+
+    // Returns false and sets `error` if the key could not be fetched or has not 16 bytes, a failed key is fetched again by the next call.
+    // Rethrows an exception of the fetch.
+    bool get(const std::string& keyUri, util::aes_block_t& key, std::string& error);
+
+    // number of keys which were fetched successfully or are being fetched
+    size_t fetched() const;
+
+private:
+    class Entry
+    {
+    public:
+        Entry()
+            : key(), error()
+        {}
+
+        virtual ~Entry() {}
+
+        util::aes_block_t key;
+        std::string error; // empty on success
+    };
+
+    util::Curl& m_curl;
+    std::map<std::string, std::shared_future<util::KeyCache::Entry>> m_keys;
+    mutable std::mutex m_mtx;
+
+    util::KeyCache::Entry m_fetch(const std::string& keyUri);
+    void m_forget(const std::string& keyUri);
+
+    KeyCache(const KeyCache& other) = delete;
+    KeyCache& operator=(const KeyCache&);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_HLSCRYPTO_H
@@ -0,0 +1,151 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "hash.h"
+#include "http-archive.h"
+
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const char* const magicLine = "m3u-tool http archive 1";
+const char* const indexFileName = "index.txt";
+
+// reads the value of a `name value` line
+bool readField(std::istream& is, const std::string& name, std::string& value)
+{
+    std::string line;
+    if (!std::getline(is, line)) return false;
+
+    if ((line.length() <= name.length()) || (line.compare(0, name.length(), name) != 0) || (line[name.length()] != ' ')) return false;
+
+    value = line.substr(name.length() + 1);
+
+    return true;
+}
+
+} // namespace
+
+
+
+void util::HttpArchive::setRecord(const std::filesystem::path& dir)
+{
+    fs::create_directories(dir);
+
+    m_mode = MODE_RECORD;
+    m_dir = dir;
+    m_latency = -1;
+    m_bandwidth = 0;
+}
+
+void util::HttpArchive::setReplay(const std::filesystem::path& dir, double latency, uint64_t bandwidth)
+{
+    if (!fs::is_directory(dir)) throw std::runtime_error("HTTP archive \"" + dir.u8string() + "\" not found");
+
+    m_mode = MODE_REPLAY;
+    m_dir = dir;
+    m_latency = latency;
+    m_bandwidth = bandwidth;
+}
+
+void util::HttpArchive::record(const std::string& key, const util::HttpArchive::Entry& entry)
+{
+    const fs::path file = m_entryFile(key);
+
+    std::stringstream tmpName;
+    tmpName << file.filename().u8string() << ".tmp." << std::this_thread::get_id();
+    const fs::path tmpFile = file.parent_path() / tmpName.str();
+
+    {
+        std::ofstream ofs;
+        ofs.exceptions(std::ios::badbit | std::ios::failbit | std::ios::eofbit);
+        ofs.open(tmpFile, std::ios::out | std::ios::binary);
+
+        ofs << std::setprecision(9);
+        ofs << ::magicLine << '\n';
+        ofs << "key " << key << '\n';
+        ofs << "curl " << entry.curlCode << '\n';
+        ofs << "http " << entry.httpCode << '\n';
+        ofs << "timing " << entry.timing.dns << ' ' << entry.timing.connect << ' ' << entry.timing.tls << ' ' << entry.timing.ttfb << ' '
+            << entry.timing.total << ' ' << entry.timing.bytes << ' ' << entry.timing.speed << '\n';
+        ofs << "headers " << entry.headers.size() << '\n';
+        ofs << "body " << entry.body.size() << '\n';
+        ofs << '\n';
+        ofs << entry.headers;
+        ofs << entry.body;
+
+        ofs.close();
+    }
+
+    std::lock_guard<std::mutex> lg(m_mtx);
+
+    const bool isNew = !fs::exists(file);
+
+    fs::rename(tmpFile, file);
+
+    if (isNew)
+    {
+        std::ofstream ofs;
+        ofs.exceptions(std::ios::badbit | std::ios::failbit | std::ios::eofbit);
+        ofs.open(m_dir / ::indexFileName, std::ios::out | std::ios::binary | std::ios::app);
+        ofs << file.filename().u8string() << ' ' << key << '\n';
+        ofs.close();
+    }
+}
+
+bool util::HttpArchive::load(const std::string& key, util::HttpArchive::Entry& entry) const
+{
+    std::ifstream ifs(m_entryFile(key), std::ios::in | std::ios::binary);
+    if (!ifs.good()) return false;
+
+    std::string line;
+    if (!std::getline(ifs, line) || (line != ::magicLine)) return false;
+
+    std::string value;
+
+    // hash collision or a foreign file
+    if (!::readField(ifs, "key", value) || (value != key)) return false;
+
+    if (!::readField(ifs, "curl", value)) return false;
+    entry.curlCode = std::stoi(value);
+
+    if (!::readField(ifs, "http", value)) return false;
+    entry.httpCode = std::stoi(value);
+
+    if (!::readField(ifs, "timing", value)) return false;
+    std::istringstream timing(value);
+    timing >> entry.timing.dns >> entry.timing.connect >> entry.timing.tls >> entry.timing.ttfb >> entry.timing.total >> entry.timing.bytes >>
+        entry.timing.speed;
+
+    if (!::readField(ifs, "headers", value)) return false;
+    const size_t headersSize = std::stoull(value);
+
+    if (!::readField(ifs, "body", value)) return false;
+    const size_t bodySize = std::stoull(value);
+
+    if (!std::getline(ifs, line) || !line.empty()) return false;
+
+    entry.headers.resize(headersSize);
+    entry.body.resize(bodySize);
+    ifs.read(entry.headers.data(), (std::streamsize)headersSize);
+    ifs.read(entry.body.data(), (std::streamsize)bodySize);
+
+    return !ifs.fail();
+}
+
+fs::path util::HttpArchive::m_entryFile(const std::string& key) const { return m_dir / (util::toHexStr(util::fnv1a64(key)) + ".entry"); }
@@ -0,0 +1,94 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_HTTPARCHIVE_H
+#define IG_MIDDLEWARE_HTTPARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+
+#include "middleware/http-stats.h"
+
+
+namespace util {
+
+// Directory with one file per request, used to record the responses of util::Curl and serve them back offline.
+// The entry file name is the hash of the request key (URL and request options), `index.txt` lists the keys.
+class HttpArchive
+{
+public:
+    enum MODE
+    {
+        MODE_OFF = 0,
+        MODE_RECORD,
+        MODE_REPLAY,
+    };
+
+    class Entry
+    {
+    public:
+        Entry()
+            : curlCode(-1), httpCode(-1), headers(), body(), timing()
+        {}
+
+        virtual ~Entry() {}
+
+        int curlCode;
+        int httpCode;
+        std::string headers; // raw header lines
+        std::string body;
+        util::HttpTiming timing;
+    };
+
+public:
+    HttpArchive()
+        : m_mode(MODE_OFF), m_dir(), m_latency(-1), m_bandwidth(0), m_mtx()
+    {}
+
+    virtual ~HttpArchive() {}
+
+    // creates the directory if needed
+    void setRecord(const std::filesystem::path& dir);
+
+    // `latency` [s] replaces the recorded time to first byte if >= 0, `bandwidth` [B/s] 0 = unlimited
+    void setReplay(const std::filesystem::path& dir, double latency = -1, uint64_t bandwidth = 0);
+
+    int mode() const { return m_mode; }
+    bool isRecording() const { return (m_mode == MODE_RECORD); }
+    bool isReplaying() const { return (m_mode == MODE_REPLAY); }
+
+    // simulated latency [s], negative if the recorded one is used
+    double latency() const { return m_latency; }
+
+    // simulated bandwidth [B/s], 0 = unlimited
+    uint64_t bandwidth() const { return m_bandwidth; }
+
+    // thread safe, throws on file errors
+    void record(const std::string& key, const util::HttpArchive::Entry& entry);
+
+    // returns false if the key is not in the archive, does not simulate any timing
+    bool load(const std::string& key, util::HttpArchive::Entry& entry) const;
+
+private:
+    int m_mode;
+    std::filesystem::path m_dir;
+    double m_latency;
+    uint64_t m_bandwidth;
+    std::mutex m_mtx;
+
+    std::filesystem::path m_entryFile(const std::string& key) const;
+
+    HttpArchive(const HttpArchive& other) = delete;
+    HttpArchive& operator=(const HttpArchive&);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_HTTPARCHIVE_H
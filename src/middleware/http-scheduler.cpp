@@ -0,0 +1,169 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "http-scheduler.h"
+
+
+namespace {
+
+constexpr double adaptiveMaxLimit = 64;   // upper bound of the adaptive limit if no maxConnections is set
+constexpr double adaptiveStartLimit = 4;  // initial adaptive limit
+constexpr double latencyThreshold = 2.5;  // a latency above baseLatency * latencyThreshold counts as congestion
+constexpr double baseLatencyDrift = 0.01; // lets the base latency slowly follow a changed path
+constexpr double minBucketSize = 16 * 1024;
+
+} // namespace
+
+
+
+util::HttpScheduler::Slot::~Slot()
+{
+    if (!m_done && m_scheduler) m_scheduler->m_release(m_host, 0, Result::neutral, false);
+}
+
+void util::HttpScheduler::Slot::done(double latency, util::HttpScheduler::Result result)
+{
+    if (!m_done && m_scheduler) m_scheduler->m_release(m_host, latency, result, true);
+    m_done = true;
+}
+
+
+
+util::HttpScheduler::HttpScheduler()
+    : m_cfg(), m_active(0), m_hostActive(), m_limit(0), m_baseLatency(0), m_mtx(), m_cv(), m_rate(0), m_tokens(0), m_tokenTime(clock_type::now()), m_bucketMtx()
+{}
+
+void util::HttpScheduler::setConfig(const util::HttpScheduler::Config& config)
+{
+    {
+        std::lock_guard<std::mutex> lg(m_mtx);
+
+        m_cfg = config;
+
+        if (m_cfg.adaptive)
+        {
+            const double upper = (m_cfg.maxConnections > 0 ? (double)m_cfg.maxConnections : ::adaptiveMaxLimit);
+            m_limit = std::min(::adaptiveStartLimit, upper);
+        }
+        else m_limit = (double)m_cfg.maxConnections;
+
+        m_baseLatency = 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lg(m_bucketMtx);
+        m_rate = (double)config.bandwidth;
+        m_tokens = 0;
+        m_tokenTime = clock_type::now();
+    }
+
+    m_cv.notify_all();
+}
+
+util::HttpScheduler::Config util::HttpScheduler::config() const
+{
+    std::lock_guard<std::mutex> lg(m_mtx);
+    return m_cfg;
+}
+
+util::HttpScheduler::Slot util::HttpScheduler::acquire(const std::string& host)
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+
+    m_cv.wait(lock, [this, &host]() { return m_canStart(host); });
+
+    ++m_active;
+    ++m_hostActive[host];
+
+    return util::HttpScheduler::Slot(this, host);
+}
+
+void util::HttpScheduler::consume(size_t nBytes)
+{
+    double wait = 0;
+
+    {
+        std::lock_guard<std::mutex> lg(m_bucketMtx);
+
+        const double rate = m_rate;
+        if (rate <= 0) return;
+
+        const double bucketSize = std::max(rate, ::minBucketSize);
+
+        const auto now = clock_type::now();
+        const double elapsed = std::chrono::duration<double>(now - m_tokenTime).count();
+        m_tokenTime = now;
+
+        m_tokens = std::min(m_tokens + elapsed * rate, bucketSize);
+
+        // the bucket may go into debt, the caller then sleeps until it is paid back
+        m_tokens -= (double)nBytes;
+        if (m_tokens < 0) wait = -m_tokens / rate;
+    }
+
+    if (wait > 0) std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+}
+
+size_t util::HttpScheduler::limit() const
+{
+    std::lock_guard<std::mutex> lg(m_mtx);
+    return (size_t)m_limit;
+}
+
+bool util::HttpScheduler::m_canStart(const std::string& host) const
+{
+    if ((m_limit > 0) && (m_active >= std::max<size_t>(1, (size_t)m_limit))) return false;
+
+    if (m_cfg.maxHostConnections > 0)
+    {
+        const auto it = m_hostActive.find(host);
+        if ((it != m_hostActive.end()) && (it->second >= m_cfg.maxHostConnections)) return false;
+    }
+
+    return true;
+}
+
+void util::HttpScheduler::m_release(const std::string& host, double latency, util::HttpScheduler::Result result, bool report)
+{
+    {
+        std::lock_guard<std::mutex> lg(m_mtx);
+
+        if (m_active > 0) --m_active;
+
+        auto it = m_hostActive.find(host);
+        if (it != m_hostActive.end())
+        {
+            if (it->second > 1) --(it->second);
+            else m_hostActive.erase(it);
+        }
+
+        if (m_cfg.adaptive && report && (result != Result::neutral))
+        {
+            const double upper = (m_cfg.maxConnections > 0 ? (double)m_cfg.maxConnections : ::adaptiveMaxLimit);
+
+            if ((result == Result::good) && (latency > 0))
+            {
+                if ((m_baseLatency <= 0) || (latency < m_baseLatency)) m_baseLatency = latency;
+                else m_baseLatency += (latency - m_baseLatency) * ::baseLatencyDrift;
+            }
+
+            const bool congested = (result == Result::congested) || ((m_baseLatency > 0) && (latency > (m_baseLatency * ::latencyThreshold)));
+
+            if (congested) m_limit = std::max(1.0, m_limit / 2.0);
+            else m_limit = std::min(upper, m_limit + (1.0 / m_limit));
+        }
+    }
+
+    m_cv.notify_all();
+}
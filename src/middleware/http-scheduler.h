@@ -0,0 +1,120 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_HTTPSCHEDULER_H
+#define IG_MIDDLEWARE_HTTPSCHEDULER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+
+namespace util {
+
+// limits the transfers of util::Curl, all members are thread safe
+class HttpScheduler
+{
+public:
+    class Config
+    {
+    public:
+        Config()
+            : maxConnections(0), maxHostConnections(0), bandwidth(0), adaptive(false)
+        {}
+
+        virtual ~Config() {}
+
+        size_t maxConnections;     // 0 = unlimited
+        size_t maxHostConnections; // 0 = unlimited
+        uint64_t bandwidth;        // [B/s], 0 = unlimited
+        bool adaptive;             // AIMD concurrency limit, bounded by maxConnections
+    };
+
+    // outcome of a transfer for the adaptive concurrency control
+    enum class Result
+    {
+        good,      // increases the limit, the latency feeds the base latency
+        neutral,   // e.g. 404, says nothing about the load of the server and leaves the limit unchanged
+        congested, // transport error, 5xx or 429, halves the limit
+    };
+
+    // a granted transfer, the slot is released on destruction
+    class Slot
+    {
+    public:
+        Slot() = delete;
+        Slot(util::HttpScheduler* scheduler, const std::string& host)
+            : m_scheduler(scheduler), m_host(host), m_done(false)
+        {}
+
+        Slot(Slot&& other) noexcept
+            : m_scheduler(other.m_scheduler), m_host(std::move(other.m_host)), m_done(other.m_done)
+        {
+            other.m_done = true;
+        }
+
+        virtual ~Slot();
+
+        // feeds the result into the adaptive concurrency control and releases the slot
+        void done(double latency, util::HttpScheduler::Result result);
+
+    private:
+        util::HttpScheduler* m_scheduler;
+        std::string m_host;
+        bool m_done;
+
+        Slot(const Slot& other) = delete;
+        Slot& operator=(const Slot&);
+    };
+
+public:
+    HttpScheduler();
+    virtual ~HttpScheduler() {}
+
+    void setConfig(const util::HttpScheduler::Config& config);
+    util::HttpScheduler::Config config() const;
+
+    // blocks until a transfer to `host` is allowed
+    util::HttpScheduler::Slot acquire(const std::string& host);
+
+    // token bucket, blocks until `nBytes` may be received
+    void consume(size_t nBytes);
+
+    // current concurrency limit, 0 = unlimited
+    size_t limit() const;
+
+private:
+    using clock_type = std::chrono::steady_clock;
+
+    util::HttpScheduler::Config m_cfg;
+
+    size_t m_active;
+    std::map<std::string, size_t> m_hostActive;
+    double m_limit;
+    double m_baseLatency; // smoothed minimum of the observed latencies
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cv;
+
+    double m_rate;
+    double m_tokens;
+    clock_type::time_point m_tokenTime;
+    std::mutex m_bucketMtx;
+
+    bool m_canStart(const std::string& host) const;
+    void m_release(const std::string& host, double latency, util::HttpScheduler::Result result, bool report);
+
+    HttpScheduler(const HttpScheduler& other) = delete;
+    HttpScheduler& operator=(const HttpScheduler&);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_HTTPSCHEDULER_H
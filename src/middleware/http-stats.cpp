@@ -0,0 +1,159 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "http-stats.h"
+#include "util.h"
+
+
+namespace {
+
+// nearest rank method
+double percentile(std::vector<double> values, double p)
+{
+    double r = 0;
+
+    if (!values.empty())
+    {
+        std::sort(values.begin(), values.end());
+
+        size_t rank = (size_t)std::ceil(p / 100.0 * (double)values.size());
+        if (rank > 0) --rank;
+        if (rank >= values.size()) rank = values.size() - 1;
+
+        r = values[rank];
+    }
+
+    return r;
+}
+
+std::string msStr(double seconds)
+{
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << (seconds * 1000.0) << "ms";
+    return ss.str();
+}
+
+} // namespace
+
+
+
+std::string util::HttpTiming::toString() const
+{
+    std::stringstream ss;
+
+    ss << "dns " << ::msStr(dns);
+    ss << ", connect " << ::msStr(connect);
+    ss << ", tls " << ::msStr(tls);
+    ss << ", ttfb " << ::msStr(ttfb);
+    ss << ", total " << ::msStr(total);
+    ss << ", " << bytes << "B";
+    ss << " @ " << std::fixed << std::setprecision(1) << (speed / 1000.0) << "kB/s";
+
+    return ss.str();
+}
+
+
+
+void util::HttpStats::HostStats::add(const util::HttpTiming& timing, bool good)
+{
+    m_total.push_back(timing.total);
+    m_ttfb.push_back(timing.ttfb);
+    m_bytes += timing.bytes;
+    m_time += timing.total;
+
+    if (!good) ++m_errors;
+}
+
+double util::HttpStats::HostStats::totalPercentile(double p) const { return ::percentile(m_total, p); }
+
+double util::HttpStats::HostStats::ttfbPercentile(double p) const { return ::percentile(m_ttfb, p); }
+
+
+
+void util::HttpStats::add(const std::string& host, const util::HttpTiming& timing, bool good)
+{
+    std::lock_guard<std::mutex> lg(m_mtx);
+    m_hosts[host].add(timing, good);
+}
+
+bool util::HttpStats::empty() const
+{
+    std::lock_guard<std::mutex> lg(m_mtx);
+    return m_hosts.empty();
+}
+
+std::map<std::string, util::HttpStats::HostStats> util::HttpStats::hosts() const
+{
+    std::lock_guard<std::mutex> lg(m_mtx);
+    return m_hosts;
+}
+
+std::string util::HttpStats::toString() const
+{
+    const auto hostStats = hosts();
+
+    std::stringstream ss;
+
+    for (const auto& e : hostStats)
+    {
+        const auto& hs = e.second;
+
+        ss << e.first << "\n";
+        ss << "    requests:   " << hs.requests() << " (" << hs.errors() << " failed)\n";
+        ss << "    total:      p50 " << ::msStr(hs.totalPercentile(50)) << ", p90 " << ::msStr(hs.totalPercentile(90)) << ", p99 "
+           << ::msStr(hs.totalPercentile(99)) << "\n";
+        ss << "    ttfb:       p50 " << ::msStr(hs.ttfbPercentile(50)) << ", p90 " << ::msStr(hs.ttfbPercentile(90)) << ", p99 "
+           << ::msStr(hs.ttfbPercentile(99)) << "\n";
+        ss << "    throughput: " << hs.bytes() << "B @ " << std::fixed << std::setprecision(1) << (hs.throughput() / 1000.0) << "kB/s\n";
+    }
+
+    return ss.str();
+}
+
+std::string util::HttpStats::toJson() const
+{
+    const auto hostStats = hosts();
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(6);
+
+    ss << "{\n  \"hosts\": [";
+
+    bool first = true;
+    for (const auto& e : hostStats)
+    {
+        const auto& hs = e.second;
+
+        if (!first) ss << ',';
+        first = false;
+
+        ss << "\n    {";
+        ss << "\n      \"host\": \"" << util::jsonEscape(e.first) << "\",";
+        ss << "\n      \"requests\": " << hs.requests() << ",";
+        ss << "\n      \"errors\": " << hs.errors() << ",";
+        ss << "\n      \"bytes\": " << hs.bytes() << ",";
+        ss << "\n      \"throughput\": " << hs.throughput() << ",";
+        ss << "\n      \"total\": { \"p50\": " << hs.totalPercentile(50) << ", \"p90\": " << hs.totalPercentile(90) << ", \"p99\": " << hs.totalPercentile(99)
+           << " },";
+        ss << "\n      \"ttfb\": { \"p50\": " << hs.ttfbPercentile(50) << ", \"p90\": " << hs.ttfbPercentile(90) << ", \"p99\": " << hs.ttfbPercentile(99)
+           << " }";
+        ss << "\n    }";
+    }
+
+    ss << (hostStats.empty() ? "]" : "\n  ]") << "\n}\n";
+
+    return ss.str();
+}
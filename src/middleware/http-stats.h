@@ -0,0 +1,100 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_HTTPSTATS_H
+#define IG_MIDDLEWARE_HTTPSTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace util {
+
+// timing breakdown of one request as reported by curl, the times are in seconds since the start of the request
+struct HttpTiming
+{
+    HttpTiming()
+        : dns(0), connect(0), tls(0), ttfb(0), total(0), bytes(0), speed(0)
+    {}
+
+    double dns;     // name lookup done
+    double connect; // TCP connection established
+    double tls;     // TLS handshake done (0 on plain HTTP)
+    double ttfb;    // first byte received
+    double total;   // transfer done
+    uint64_t bytes; // downloaded body size
+    double speed;   // average download speed [B/s]
+
+    std::string toString() const;
+};
+
+class HttpStats
+{
+public:
+    class HostStats
+    {
+    public:
+        HostStats()
+            : m_total(), m_ttfb(), m_bytes(0), m_time(0), m_errors(0)
+        {}
+
+        virtual ~HostStats() {}
+
+        void add(const util::HttpTiming& timing, bool good);
+
+        size_t requests() const { return m_total.size(); }
+        size_t errors() const { return m_errors; }
+        uint64_t bytes() const { return m_bytes; }
+
+        // bytes per accumulated transfer time [B/s]
+        double throughput() const { return (m_time > 0 ? ((double)m_bytes / m_time) : 0); }
+
+        // p in [0, 100]
+        double totalPercentile(double p) const;
+        double ttfbPercentile(double p) const;
+
+    private:
+        std::vector<double> m_total;
+        std::vector<double> m_ttfb;
+        uint64_t m_bytes;
+        double m_time;
+        size_t m_errors;
+    };
+
+public:
+    HttpStats()
+        : m_hosts(), m_mtx()
+    {}
+
+    virtual ~HttpStats() {}
+
+    // thread safe
+    void add(const std::string& host, const util::HttpTiming& timing, bool good);
+
+    bool empty() const;
+
+    // copy of the per host data, thread safe
+    std::map<std::string, util::HttpStats::HostStats> hosts() const;
+
+    std::string toString() const;
+    std::string toJson() const;
+
+private:
+    std::map<std::string, util::HttpStats::HostStats> m_hosts;
+    mutable std::mutex m_mtx;
+
+    HttpStats(const HttpStats& other) = delete;
+    HttpStats& operator=(const HttpStats&);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_HTTPSTATS_H
@@ -0,0 +1,108 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "live-follower.h"
+
+
+namespace {
+
+constexpr long connectTimeout = 30; // [s]
+constexpr long reloadTimeout = 60;  // [s]
+
+// the server has to answer a blocking reload within 3 target durations
+constexpr double blockingTimeoutFactor = 3;
+
+void appendQuery(std::string& url, const std::string& param) { url += ((url.find('?') == std::string::npos) ? '?' : '&') + param; }
+
+} // namespace
+
+
+
+util::LiveFollower::LiveFollower(util::Curl& curl, const std::string& url)
+    : m_curl(curl),
+      m_url(url),
+      m_blocking(true),
+      m_playlist(),
+      m_response(),
+      m_polls(0),
+      m_ended(false),
+      m_nextSequence(0),
+      m_missed(0),
+      m_targetDuration(0),
+      m_canBlockReload(false),
+      m_canSkip(false)
+{}
+
+bool util::LiveFollower::poll()
+{
+    const bool delta = ((m_polls > 0) && m_canSkip);
+
+    if (!m_fetch(delta)) return false;
+
+    // the delta update skipped segments which have not been seen yet, the full playlist is needed
+    if (delta && ((m_playlist.mediaSequence() + m_playlist.skippedSegments()) > m_nextSequence))
+    {
+        if (!m_fetch(false)) return false;
+    }
+
+    if ((m_polls > 0) && (m_playlist.mediaSequence() > m_nextSequence)) m_missed += m_playlist.mediaSequence() - m_nextSequence;
+
+    m_nextSequence = std::max(m_nextSequence, m_playlist.endSequence());
+    m_ended = m_playlist.endList();
+    m_targetDuration = m_playlist.targetDuration();
+    m_canBlockReload = m_playlist.serverControl().canBlockReload;
+    m_canSkip = (m_playlist.serverControl().canSkipUntil > 0);
+
+    ++m_polls;
+
+    return true;
+}
+
+double util::LiveFollower::reloadDelay() const
+{
+    if (m_blocking && m_canBlockReload) return 0;
+
+    const double targetDuration = (m_targetDuration > 0 ? m_targetDuration : 1);
+
+    // RFC 8216 6.3.4, half the target duration if the playlist has not changed
+    return (m_playlist.empty() ? (targetDuration / 2.0) : targetDuration);
+}
+
+bool util::LiveFollower::m_fetch(bool delta)
+{
+    std::string url = m_url;
+    long timeout = ::reloadTimeout;
+
+    if (m_polls > 0)
+    {
+        if (m_blocking && m_canBlockReload)
+        {
+            ::appendQuery(url, "_HLS_msn=" + std::to_string(m_nextSequence));
+            timeout = std::max(timeout, (long)std::ceil(m_targetDuration * ::blockingTimeoutFactor) + ::connectTimeout);
+        }
+
+        if (delta) ::appendQuery(url, "_HLS_skip=YES");
+    }
+
+    m_response = m_curl.httpGET(util::HttpRequest(url, ::connectTimeout, timeout));
+
+    if (!m_response.good())
+    {
+        m_playlist = m3u::MediaPlaylist();
+        return false;
+    }
+
+    const std::string& data = m_response.data();
+    m_playlist.parse(data.data(), data.data() + data.size(), (m_polls > 0 ? m_nextSequence : 0));
+
+    return true;
+}
@@ -0,0 +1,78 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_LIVEFOLLOWER_H
+#define IG_MIDDLEWARE_LIVEFOLLOWER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "middleware/curl-helper.h"
+#include "middleware/m3u-media.h"
+
+
+namespace util {
+
+// Polls a live media playlist and keeps only the state needed for the next reload, the segments seen before are not parsed again. If the
+// server advertises it in EXT-X-SERVER-CONTROL, blocking playlist reload (`_HLS_msn`) and playlist delta updates (`_HLS_skip`) are used.
+class LiveFollower
+{
+public:
+    LiveFollower() = delete;
+    LiveFollower(util::Curl& curl, const std::string& url);
+    virtual ~LiveFollower() {}
+
+    const std::string& url() const { return m_url; }
+
+    // blocking reload is only used if enabled (default) and supported by the server
+    void setBlocking(bool blocking) { m_blocking = blocking; }
+
+    // Reloads the playlist, returns false if the request failed. On success newSegments() contains the segments which appeared since the
+    // previous poll.
+    bool poll();
+
+    const m3u::MediaPlaylist& newSegments() const { return m_playlist; }
+    const util::HttpGetResponse& response() const { return m_response; }
+
+    size_t polls() const { return m_polls; }
+    bool ended() const { return m_ended; }
+
+    // media sequence number of the next expected segment
+    int64_t nextSequence() const { return m_nextSequence; }
+
+    // number of segments which were removed from the playlist before they have been seen
+    int64_t missedSegments() const { return m_missed; }
+
+    bool canBlockReload() const { return m_canBlockReload; }
+    bool canSkip() const { return m_canSkip; }
+
+    // [s] time to wait until the next poll, 0 if the next poll is a blocking reload
+    double reloadDelay() const;
+
+private:
+    util::Curl& m_curl;
+    std::string m_url;
+    bool m_blocking;
+
+    m3u::MediaPlaylist m_playlist;
+    util::HttpGetResponse m_response;
+
+    size_t m_polls;
+    bool m_ended;
+    int64_t m_nextSequence;
+    int64_t m_missed;
+    double m_targetDuration;
+    bool m_canBlockReload;
+    bool m_canSkip;
+
+    bool m_fetch(bool delta);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_LIVEFOLLOWER_H
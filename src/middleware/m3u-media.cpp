@@ -0,0 +1,350 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "m3u-media.h"
+#include "m3u.h"
+
+
+namespace {
+
+inline bool startsWith(std::string_view str, std::string_view prefix) { return (str.substr(0, prefix.size()) == prefix); }
+
+template <typename T> bool parseNumber(std::string_view str, T& value)
+{
+    const char* const pEnd = str.data() + str.size();
+    const auto res = std::from_chars(str.data(), pEnd, value);
+    return (res.ec == std::errc());
+}
+
+// "<n>[@<o>]", `offset` is left unchanged if not present
+bool parseByteRange(std::string_view str, int64_t& length, int64_t& offset)
+{
+    const size_t atPos = str.find('@');
+
+    if (!parseNumber(str.substr(0, atPos), length)) return false;
+    if ((atPos != std::string_view::npos) && !parseNumber(str.substr(atPos + 1), offset)) return false;
+
+    return true;
+}
+
+std::string getAttribute(const m3u::Entry& entry, const std::string& key)
+{
+    std::string r;
+    if (entry.extParam().contains(key)) r = entry.extParam().get(key).value().data();
+    return r;
+}
+
+} // namespace
+
+
+
+const char* const m3u::ext_x_targetduration_str = "#EXT-X-TARGETDURATION:";
+const char* const m3u::ext_x_media_sequence_str = "#EXT-X-MEDIA-SEQUENCE:";
+const char* const m3u::ext_x_discontinuity_sequence_str = "#EXT-X-DISCONTINUITY-SEQUENCE:";
+const char* const m3u::ext_x_discontinuity_str = "#EXT-X-DISCONTINUITY";
+const char* const m3u::ext_x_byterange_str = "#EXT-X-BYTERANGE:";
+const char* const m3u::ext_x_key_str = "#EXT-X-KEY:";
+const char* const m3u::ext_x_map_str = "#EXT-X-MAP:";
+const char* const m3u::ext_x_endlist_str = "#EXT-X-ENDLIST";
+const char* const m3u::ext_x_playlist_type_str = "#EXT-X-PLAYLIST-TYPE:";
+const char* const m3u::ext_x_server_control_str = "#EXT-X-SERVER-CONTROL:";
+const char* const m3u::ext_x_skip_str = "#EXT-X-SKIP:";
+
+
+
+m3u::MediaPlaylist::MediaPlaylist()
+    : m_version(0),
+      m_targetDuration(0),
+      m_mediaSequence(0),
+      m_discontinuitySequence(0),
+      m_endList(false),
+      m_playlistType(),
+      m_serverControl(),
+      m_skippedSegments(0),
+      m_firstSequence(0),
+      m_keepFrom(0),
+      m_duration(),
+      m_start(1, 0.0),
+      m_uriPool(),
+      m_uriOffset(1, 0),
+      m_rangeOffset(),
+      m_rangeLength(),
+      m_key(),
+      m_map(),
+      m_flags(),
+      m_run(),
+      m_keys(),
+      m_maps(),
+      m_runs(),
+      m_pending()
+{}
+
+void m3u::MediaPlaylist::parse(const char* p, const char* pEnd, int64_t firstSequence)
+{
+    m_clear();
+    m_keepFrom = firstSequence;
+
+    while (p < pEnd)
+    {
+        const char* lineEnd = std::find(p, pEnd, '\n');
+
+        std::string_view line(p, lineEnd - p);
+        if (!line.empty() && (line.back() == '\r')) line.remove_suffix(1);
+
+        m_parseLine(line);
+
+        p = lineEnd + (lineEnd < pEnd ? 1 : 0);
+    }
+}
+
+std::string_view m3u::MediaPlaylist::uriView(size_t idx) const
+{
+    return std::string_view(m_uriPool.data() + m_uriOffset[idx], m_uriOffset[idx + 1] - m_uriOffset[idx]);
+}
+
+m3u::MediaPlaylist::Segment m3u::MediaPlaylist::segment(size_t idx) const
+{
+    Segment r;
+
+    r.sequence = sequence(idx);
+    r.duration = duration(idx);
+    r.start = startTime(idx);
+    r.uri = uri(idx);
+    r.rangeOffset = rangeOffset(idx);
+    r.rangeLength = rangeLength(idx);
+    r.key = keyIndex(idx);
+    r.map = mapIndex(idx);
+    r.discontinuity = discontinuity(idx);
+
+    return r;
+}
+
+bool m3u::MediaPlaylist::isEncrypted() const
+{
+    for (const auto& key : m_keys)
+    {
+        if (!key.isNone()) return true;
+    }
+
+    return false;
+}
+
+size_t m3u::MediaPlaylist::segmentAt(double time) const
+{
+    if ((time < 0) || (time >= totalDuration())) return size();
+
+    // first start time greater than `time`, the segment before it contains `time`
+    const auto it = std::upper_bound(m_start.begin(), m_start.end() - 1, time);
+
+    return (size_t)(it - m_start.begin()) - 1;
+}
+
+void m3u::MediaPlaylist::m_clear()
+{
+    m_version = 0;
+    m_targetDuration = 0;
+    m_mediaSequence = 0;
+    m_discontinuitySequence = 0;
+    m_endList = false;
+    m_playlistType.clear();
+    m_serverControl = ServerControl();
+    m_skippedSegments = 0;
+    m_firstSequence = 0;
+    m_keepFrom = 0;
+
+    m_duration.clear();
+    m_start.assign(1, 0.0);
+    m_uriPool.clear();
+    m_uriOffset.assign(1, 0);
+    m_rangeOffset.clear();
+    m_rangeLength.clear();
+    m_key.clear();
+    m_map.clear();
+    m_flags.clear();
+    m_run.clear();
+
+    m_keys.clear();
+    m_maps.clear();
+    m_runs.clear();
+
+    m_pending = Pending();
+}
+
+void m3u::MediaPlaylist::m_parseLine(std::string_view line)
+{
+    if (line.empty()) return;
+
+    if (line[0] != '#') m_addSegment(line);
+    else if (::startsWith(line, m3u::extinf_str))
+    {
+        std::string_view value = line.substr(std::char_traits<char>::length(m3u::extinf_str));
+        value = value.substr(0, value.find(','));
+
+        double duration = 0;
+        if (::parseNumber(value, duration)) m_pending.duration = duration;
+    }
+    else if (::startsWith(line, m3u::ext_x_byterange_str))
+    {
+        int64_t length = -1;
+        int64_t offset = m_pending.prevRangeEnd;
+
+        if (::parseByteRange(line.substr(std::char_traits<char>::length(m3u::ext_x_byterange_str)), length, offset))
+        {
+            m_pending.rangeLength = length;
+            m_pending.rangeOffset = offset;
+        }
+    }
+    else if (::startsWith(line, m3u::ext_x_discontinuity_sequence_str))
+    {
+        ::parseNumber(line.substr(std::char_traits<char>::length(m3u::ext_x_discontinuity_sequence_str)), m_discontinuitySequence);
+    }
+    else if (line == m3u::ext_x_discontinuity_str) m_pending.discontinuity = true;
+    else if (::startsWith(line, m3u::ext_x_key_str))
+    {
+        const m3u::Entry e("", std::string(line));
+
+        Key key;
+        key.method = ::getAttribute(e, "METHOD");
+        key.uri = ::getAttribute(e, "URI");
+        key.iv = ::getAttribute(e, "IV");
+        key.keyFormat = ::getAttribute(e, "KEYFORMAT");
+
+        if (key.isNone()) m_pending.key = -1;
+        else
+        {
+            m_keys.push_back(key);
+            m_pending.key = (int)(m_keys.size() - 1);
+        }
+    }
+    else if (::startsWith(line, m3u::ext_x_map_str))
+    {
+        const m3u::Entry e("", std::string(line));
+
+        Map map;
+        map.uri = ::getAttribute(e, "URI");
+
+        const std::string range = ::getAttribute(e, "BYTERANGE");
+        if (!range.empty())
+        {
+            map.rangeOffset = 0;
+            if (!::parseByteRange(range, map.rangeLength, map.rangeOffset)) map.rangeOffset = -1;
+        }
+
+        m_maps.push_back(map);
+        m_pending.map = (int)(m_maps.size() - 1);
+    }
+    else if (::startsWith(line, m3u::ext_x_targetduration_str))
+    {
+        ::parseNumber(line.substr(std::char_traits<char>::length(m3u::ext_x_targetduration_str)), m_targetDuration);
+    }
+    else if (::startsWith(line, m3u::ext_x_media_sequence_str))
+    {
+        ::parseNumber(line.substr(std::char_traits<char>::length(m3u::ext_x_media_sequence_str)), m_mediaSequence);
+        m_pending.sequence = m_mediaSequence;
+    }
+    else if (::startsWith(line, m3u::ext_x_skip_str))
+    {
+        const m3u::Entry e("", std::string(line));
+
+        int64_t skipped = 0;
+        if (::parseNumber(::getAttribute(e, "SKIPPED-SEGMENTS"), skipped) && (skipped > 0))
+        {
+            m_skippedSegments += skipped;
+            m_pending.sequence += skipped;
+        }
+    }
+    else if (::startsWith(line, m3u::ext_x_server_control_str))
+    {
+        const m3u::Entry e("", std::string(line));
+
+        ::parseNumber(::getAttribute(e, "CAN-SKIP-UNTIL"), m_serverControl.canSkipUntil);
+        m_serverControl.canBlockReload = (::getAttribute(e, "CAN-BLOCK-RELOAD") == "YES");
+    }
+    else if (::startsWith(line, m3u::ext_x_playlist_type_str)) m_playlistType = line.substr(std::char_traits<char>::length(m3u::ext_x_playlist_type_str));
+    else if (::startsWith(line, "#EXT-X-VERSION:")) ::parseNumber(line.substr(15), m_version);
+    else if (line == m3u::ext_x_endlist_str) m_endList = true;
+
+    // other tags and comments are ignored
+}
+
+void m3u::MediaPlaylist::m_addSegment(std::string_view uri)
+{
+    if (m_pending.sequence < m_keepFrom)
+    {
+        m_endSegment();
+        return;
+    }
+
+    const size_t idx = size();
+
+    if (idx == 0) m_firstSequence = m_pending.sequence;
+
+    if (m_uriPool.size() + uri.size() > UINT32_MAX) throw std::length_error("media playlist URI pool overflow");
+
+    const double duration = (m_pending.duration > 0 ? m_pending.duration : 0);
+
+    m_duration.push_back((float)duration);
+    m_start.push_back(m_start.back() + duration);
+    m_uriPool.append(uri.data(), uri.size());
+    m_uriOffset.push_back((uint32_t)m_uriPool.size());
+    m_key.push_back(m_pending.key);
+    m_map.push_back(m_pending.map);
+    m_flags.push_back(m_pending.discontinuity ? flag_discontinuity : 0);
+
+    const bool hasRange = (m_pending.rangeOffset >= 0);
+
+    if (hasRange && m_rangeOffset.empty())
+    {
+        m_rangeOffset.assign(idx, -1);
+        m_rangeLength.assign(idx, -1);
+    }
+
+    if (!m_rangeOffset.empty())
+    {
+        m_rangeOffset.push_back(m_pending.rangeOffset);
+        m_rangeLength.push_back(m_pending.rangeLength);
+    }
+
+    // coalesce contiguous unencrypted byte ranges of the same resource
+    bool coalesce = false;
+    if (hasRange && (idx > 0) && !m_runs.empty() && (m_key[idx] < 0) && (m_key[idx - 1] < 0) && (m_map[idx] == m_map[idx - 1]))
+    {
+        const auto& run = m_runs.back();
+        coalesce = (run.offset >= 0) && ((run.offset + run.length) == m_pending.rangeOffset) && (uriView(idx - 1) == uri);
+    }
+
+    if (coalesce)
+    {
+        ++m_runs.back().count;
+        m_runs.back().length += m_pending.rangeLength;
+    }
+    else if (hasRange) m_runs.push_back(RangeRun(idx, m_pending.rangeOffset, m_pending.rangeLength));
+    else m_runs.push_back(RangeRun(idx, -1, -1));
+
+    m_run.push_back((uint32_t)(m_runs.size() - 1));
+
+    m_endSegment();
+}
+
+void m3u::MediaPlaylist::m_endSegment()
+{
+    // the key and map stay active for the following segments
+    m_pending.prevRangeEnd = ((m_pending.rangeOffset >= 0) ? (m_pending.rangeOffset + m_pending.rangeLength) : 0);
+    m_pending.duration = -1;
+    m_pending.rangeOffset = -1;
+    m_pending.rangeLength = -1;
+    m_pending.discontinuity = false;
+    ++m_pending.sequence;
+}
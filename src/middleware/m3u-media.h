@@ -0,0 +1,245 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_M3UMEDIA_H
+#define IG_MIDDLEWARE_M3UMEDIA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace m3u {
+
+extern const char* const ext_x_targetduration_str;
+extern const char* const ext_x_media_sequence_str;
+extern const char* const ext_x_discontinuity_sequence_str;
+extern const char* const ext_x_discontinuity_str;
+extern const char* const ext_x_byterange_str;
+extern const char* const ext_x_key_str;
+extern const char* const ext_x_map_str;
+extern const char* const ext_x_endlist_str;
+extern const char* const ext_x_playlist_type_str;
+extern const char* const ext_x_server_control_str;
+extern const char* const ext_x_skip_str;
+
+// HLS media playlist, the segments are stored in compact per attribute arrays and all URIs share one string pool.
+class MediaPlaylist
+{
+public:
+    class Key
+    {
+    public:
+        Key()
+            : method(), uri(), iv(), keyFormat()
+        {}
+
+        virtual ~Key() {}
+
+        std::string method; // NONE, AES-128, SAMPLE-AES, ...
+        std::string uri;
+        std::string iv; // hexadecimal as in the playlist (0x...), empty if not specified
+        std::string keyFormat;
+
+        bool isNone() const { return (method.empty() || (method == "NONE")); }
+    };
+
+    class Map
+    {
+    public:
+        Map()
+            : uri(), rangeOffset(-1), rangeLength(-1)
+        {}
+
+        virtual ~Map() {}
+
+        std::string uri;
+        int64_t rangeOffset; // < 0 = whole resource
+        int64_t rangeLength;
+    };
+
+    // Consecutive segments which are contiguous byte ranges of the same unencrypted resource and can be fetched with one request.
+    // A segment without byte range is a run on its own with a negative offset.
+    class RangeRun
+    {
+    public:
+        RangeRun()
+            : first(0), count(0), offset(-1), length(-1)
+        {}
+
+        RangeRun(size_t first_, int64_t offset_, int64_t length_)
+            : first(first_), count(1), offset(offset_), length(length_)
+        {}
+
+        virtual ~RangeRun() {}
+
+        size_t first;
+        size_t count;
+        int64_t offset;
+        int64_t length;
+    };
+
+    class Segment
+    {
+    public:
+        Segment()
+            : sequence(0), duration(0), start(0), uri(), rangeOffset(-1), rangeLength(-1), key(-1), map(-1), discontinuity(false)
+        {}
+
+        virtual ~Segment() {}
+
+        int64_t sequence;
+        double duration;
+        double start;
+        std::string uri;
+        int64_t rangeOffset;
+        int64_t rangeLength;
+        int key; // index into keys(), -1 if none
+        int map; // index into maps(), -1 if none
+        bool discontinuity;
+    };
+
+    class ServerControl
+    {
+    public:
+        ServerControl()
+            : canSkipUntil(0), canBlockReload(false)
+        {}
+
+        virtual ~ServerControl() {}
+
+        double canSkipUntil; // [s] 0 if delta updates are not supported
+        bool canBlockReload;
+    };
+
+public:
+    MediaPlaylist();
+
+    MediaPlaylist(const std::string& txt)
+        : MediaPlaylist()
+    {
+        parse(txt.data(), txt.data() + txt.size());
+    }
+
+    MediaPlaylist(const char* p, const char* pEnd)
+        : MediaPlaylist()
+    {
+        parse(p, pEnd);
+    }
+
+    virtual ~MediaPlaylist() {}
+
+    // Segments with a media sequence number lower than `firstSequence` are skipped without being stored, which is used to parse only the
+    // new part of a reloaded live playlist.
+    void parse(const char* p, const char* pEnd, int64_t firstSequence = 0);
+
+    size_t size() const { return m_duration.size(); }
+    bool empty() const { return m_duration.empty(); }
+
+    int version() const { return m_version; }
+    double targetDuration() const { return m_targetDuration; }
+    int64_t mediaSequence() const { return m_mediaSequence; }
+    int64_t discontinuitySequence() const { return m_discontinuitySequence; }
+    bool endList() const { return m_endList; }
+    const std::string& playlistType() const { return m_playlistType; }
+    const m3u::MediaPlaylist::ServerControl& serverControl() const { return m_serverControl; }
+
+    // number of segments replaced by EXT-X-SKIP in a playlist delta update
+    int64_t skippedSegments() const { return m_skippedSegments; }
+
+    // media sequence number of the segment which will follow the last one in the playlist
+    int64_t endSequence() const { return m_pending.sequence; }
+
+    int64_t sequence(size_t idx) const { return (m_firstSequence + (int64_t)idx); }
+    double duration(size_t idx) const { return m_duration[idx]; }
+    double startTime(size_t idx) const { return m_start[idx]; }
+    std::string_view uriView(size_t idx) const;
+    std::string uri(size_t idx) const { return std::string(uriView(idx)); }
+    bool hasByteRange(size_t idx) const { return (!m_rangeOffset.empty() && (m_rangeOffset[idx] >= 0)); }
+    int64_t rangeOffset(size_t idx) const { return (m_rangeOffset.empty() ? -1 : m_rangeOffset[idx]); }
+    int64_t rangeLength(size_t idx) const { return (m_rangeLength.empty() ? -1 : m_rangeLength[idx]); }
+    int keyIndex(size_t idx) const { return m_key[idx]; }
+    int mapIndex(size_t idx) const { return m_map[idx]; }
+    bool discontinuity(size_t idx) const { return ((m_flags[idx] & flag_discontinuity) != 0); }
+    m3u::MediaPlaylist::Segment segment(size_t idx) const;
+
+    const std::vector<m3u::MediaPlaylist::Key>& keys() const { return m_keys; }
+    const std::vector<m3u::MediaPlaylist::Map>& maps() const { return m_maps; }
+    bool isEncrypted() const;
+
+    // O(1)
+    double totalDuration() const { return m_start.back(); }
+
+    // O(log n), index of the segment playing at `time` [s], size() if out of range
+    size_t segmentAt(double time) const;
+
+    // O(1), index into rangeRuns()
+    size_t rangeRunOf(size_t idx) const { return m_run[idx]; }
+    const std::vector<m3u::MediaPlaylist::RangeRun>& rangeRuns() const { return m_runs; }
+
+private:
+    enum
+    {
+        flag_discontinuity = 0x01,
+    };
+
+    int m_version;
+    double m_targetDuration;
+    int64_t m_mediaSequence;
+    int64_t m_discontinuitySequence;
+    bool m_endList;
+    std::string m_playlistType;
+    m3u::MediaPlaylist::ServerControl m_serverControl;
+    int64_t m_skippedSegments;
+    int64_t m_firstSequence; // sequence number of the first stored segment
+    int64_t m_keepFrom;
+
+    std::vector<float> m_duration;
+    std::vector<double> m_start; // size() + 1 elements, the last one is the total duration
+    std::string m_uriPool;
+    std::vector<uint32_t> m_uriOffset; // size() + 1 elements
+    std::vector<int64_t> m_rangeOffset; // empty if no segment has a byte range
+    std::vector<int64_t> m_rangeLength;
+    std::vector<int32_t> m_key;
+    std::vector<int32_t> m_map;
+    std::vector<uint8_t> m_flags;
+    std::vector<uint32_t> m_run;
+
+    std::vector<m3u::MediaPlaylist::Key> m_keys;
+    std::vector<m3u::MediaPlaylist::Map> m_maps;
+    std::vector<m3u::MediaPlaylist::RangeRun> m_runs;
+
+    // parser state which belongs to the next segment
+    struct Pending
+    {
+        Pending()
+            : sequence(0), duration(-1), rangeOffset(-1), rangeLength(-1), discontinuity(false), key(-1), map(-1), prevRangeEnd(0)
+        {}
+
+        int64_t sequence;
+        double duration;
+        int64_t rangeOffset;
+        int64_t rangeLength;
+        bool discontinuity;
+        int key;
+        int map;
+        int64_t prevRangeEnd;
+    };
+
+    Pending m_pending;
+
+    void m_clear();
+    void m_parseLine(std::string_view line);
+    void m_addSegment(std::string_view uri);
+    void m_endSegment();
+};
+
+} // namespace m3u
+
+
+#endif // IG_MIDDLEWARE_M3UMEDIA_H
@@ -0,0 +1,183 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "m3u-variant.h"
+#include "util.h"
+
+
+namespace {
+
+// CODECS identifier (part before the first dot) or family name to codec family
+uint32_t codecFamily(std::string_view name)
+{
+    const std::string str = omw_::toLower(std::string(name.substr(0, name.find('.'))));
+
+    if ((str == "avc1") || (str == "avc3") || (str == "avc") || (str == "h264")) return m3u::VariantIndex::codec_avc;
+    if ((str == "hvc1") || (str == "hev1") || (str == "hevc") || (str == "h265")) return m3u::VariantIndex::codec_hevc;
+    if ((str == "dvh1") || (str == "dvhe") || (str == "dva1") || (str == "dvav") || (str == "dv")) return m3u::VariantIndex::codec_dolbyVision;
+    if ((str == "av01") || (str == "av1")) return m3u::VariantIndex::codec_av1;
+    if ((str == "vp09") || (str == "vp9")) return m3u::VariantIndex::codec_vp9;
+
+    return 0;
+}
+
+// calls `fn` with each trimmed element of a comma separated list
+template <class Fn> void forEachElement(std::string_view list, Fn fn)
+{
+    while (!list.empty())
+    {
+        const size_t comma = list.find(',');
+
+        std::string_view element = list.substr(0, comma);
+        while (!element.empty() && (element.front() == ' ')) element.remove_prefix(1);
+        while (!element.empty() && (element.back() == ' ')) element.remove_suffix(1);
+
+        if (!element.empty()) fn(element);
+
+        if (comma == std::string_view::npos) break;
+        list.remove_prefix(comma + 1);
+    }
+}
+
+uint64_t parseUInt(const std::string& str)
+{
+    uint64_t value = 0;
+    const auto res = std::from_chars(str.data(), str.data() + str.size(), value);
+    return ((res.ec == std::errc()) ? value : 0);
+}
+
+// the variants are sorted by this key
+bool keyLess(int heightA, uint64_t bandwidthA, int heightB, uint64_t bandwidthB)
+{
+    return ((heightA < heightB) || ((heightA == heightB) && (bandwidthA < bandwidthB)));
+}
+
+} // namespace
+
+
+
+void m3u::VariantIndex::assign(const m3u::HLS& hls)
+{
+    m_variants.clear();
+    m_variants.reserve(hls.streams().size());
+
+    for (size_t i = 0; i < hls.streams().size(); ++i)
+    {
+        Variant v;
+        v.streamIdx = i;
+
+        for (const auto& param : hls.streams()[i].extParam())
+        {
+            const std::string& value = param.value().data();
+
+            if (param.key() == "BANDWIDTH") v.bandwidth = ::parseUInt(value);
+            else if (param.key() == "AVERAGE-BANDWIDTH") v.averageBandwidth = ::parseUInt(value);
+            else if (param.key() == "RESOLUTION")
+            {
+                const size_t x = value.find('x');
+
+                if (x != std::string::npos)
+                {
+                    int w = -1, h = -1;
+                    const auto resW = std::from_chars(value.data(), value.data() + x, w);
+                    const auto resH = std::from_chars(value.data() + x + 1, value.data() + value.size(), h);
+
+                    if ((resW.ec == std::errc()) && (resH.ec == std::errc()))
+                    {
+                        v.width = w;
+                        v.height = h;
+                    }
+                }
+            }
+            else if (param.key() == "FRAME-RATE") v.frameRate = std::strtod(value.c_str(), nullptr);
+            else if (param.key() == "CODECS") ::forEachElement(value, [&v](std::string_view codec) { v.codecs |= ::codecFamily(codec); });
+            else if (param.key() == "VIDEO-RANGE") v.hdr = v.hdr || (value == "PQ") || (value == "HLG");
+            else if (param.key() == "AUDIO") v.audioGroup = value;
+        }
+
+        if ((v.codecs & codec_dolbyVision) != 0) v.hdr = true;
+
+        m_variants.push_back(v);
+    }
+
+    std::sort(m_variants.begin(), m_variants.end(), [](const Variant& a, const Variant& b) {
+        if (::keyLess(a.height, a.bandwidth, b.height, b.bandwidth)) return true;
+        if (::keyLess(b.height, b.bandwidth, a.height, a.bandwidth)) return false;
+        return (a.streamIdx < b.streamIdx);
+    });
+}
+
+int m3u::VariantIndex::select(const m3u::VariantIndex::Policy& policy) const
+{
+    const int maxHeight = (policy.maxHeight < 0 ? std::numeric_limits<int>::max() : policy.maxHeight);
+    const uint64_t maxBandwidth = (policy.maxBandwidth == 0 ? std::numeric_limits<uint64_t>::max() : policy.maxBandwidth);
+
+    const auto accept = [&](const Variant& v) {
+        return ((v.bandwidth <= maxBandwidth) && ((policy.maxFrameRate <= 0) || (v.frameRate <= policy.maxFrameRate)) &&
+                ((policy.codecs == 0) || (v.codecs == 0) || ((v.codecs & ~policy.codecs) == 0)) &&
+                (policy.audioGroup.empty() || (v.audioGroup == policy.audioGroup)));
+    };
+
+    // first variant above the limits, the ones before it have a lower height or the maximal height and a bandwidth within the budget
+    auto groupEnd = std::upper_bound(m_variants.begin(), m_variants.end(), 0, [&](int, const Variant& v) {
+        return ::keyLess(maxHeight, maxBandwidth, v.height, v.bandwidth);
+    });
+
+    // Height by height from the highest, the variants of a height are contiguous and sorted by bandwidth. The ones above the bandwidth
+    // budget are skipped by a binary search, only the remaining filters (frame rate, codecs, audio group) need a scan.
+    while (groupEnd != m_variants.begin())
+    {
+        const int height = std::prev(groupEnd)->height;
+
+        const auto groupBegin = std::lower_bound(m_variants.begin(), groupEnd, height, [](const Variant& v, int h) { return (v.height < h); });
+        const auto last = std::upper_bound(groupBegin, groupEnd, maxBandwidth, [](uint64_t bw, const Variant& v) { return (bw < v.bandwidth); });
+
+        int r = -1;
+
+        for (auto it = last; it != groupBegin;)
+        {
+            --it;
+
+            if (accept(*it))
+            {
+                // the preferred dynamic range, otherwise the highest bandwidth of this height
+                if (it->hdr == policy.preferHdr) return (int)(it - m_variants.begin());
+                if (r < 0) r = (int)(it - m_variants.begin());
+            }
+        }
+
+        if (r >= 0) return r;
+
+        groupEnd = groupBegin;
+    }
+
+    return -1;
+}
+
+bool m3u::VariantIndex::parseCodecs(const std::string& list, uint32_t& codecs)
+{
+    bool ok = true;
+    codecs = 0;
+
+    ::forEachElement(list, [&](std::string_view element) {
+        const uint32_t family = ::codecFamily(element);
+        if (family == 0) ok = false;
+        codecs |= family;
+    });
+
+    return (ok && (codecs != 0));
+}
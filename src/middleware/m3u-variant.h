@@ -0,0 +1,107 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_M3UVARIANT_H
+#define IG_MIDDLEWARE_M3UVARIANT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "middleware/m3u.h"
+
+
+namespace m3u {
+
+// Decoded attributes of the variant streams (EXT-X-STREAM-INF) of a master playlist. The variants are sorted by resolution height and
+// bandwidth once, a selection query is a binary search for the height limit, then per height from the highest a binary search for the
+// bandwidth limit and a scan over the remaining candidates for the other filters. assign() reuses the storage, one index can be used for
+// many playlists.
+class VariantIndex
+{
+public:
+    // video codec families
+    static constexpr uint32_t codec_avc = 0x01;
+    static constexpr uint32_t codec_hevc = 0x02;
+    static constexpr uint32_t codec_dolbyVision = 0x04;
+    static constexpr uint32_t codec_av1 = 0x08;
+    static constexpr uint32_t codec_vp9 = 0x10;
+
+    class Variant
+    {
+    public:
+        Variant()
+            : streamIdx(0), width(-1), height(-1), bandwidth(0), averageBandwidth(0), frameRate(0), codecs(0), hdr(false), audioGroup()
+        {}
+
+        virtual ~Variant() {}
+
+        size_t streamIdx;          // index in m3u::HLS::streams()
+        int width;                 // -1 if unknown
+        int height;                // -1 if unknown
+        uint64_t bandwidth;        // [bit/s] peak
+        uint64_t averageBandwidth; // [bit/s] 0 if unknown
+        double frameRate;          // 0 if unknown
+        uint32_t codecs;           // video codec families, 0 if unknown
+        bool hdr;                  // VIDEO-RANGE PQ or HLG, or Dolby Vision
+        std::string audioGroup;
+    };
+
+    class Policy
+    {
+    public:
+        Policy()
+            : maxHeight(-1), maxBandwidth(0), maxFrameRate(0), codecs(0), preferHdr(false), audioGroup()
+        {}
+
+        virtual ~Policy() {}
+
+        int maxHeight;          // < 0 no limit
+        uint64_t maxBandwidth;  // [bit/s] 0 no limit
+        double maxFrameRate;    // 0 no limit
+        uint32_t codecs;        // allowed video codec families, 0 any (variants without CODECS are always allowed)
+        bool preferHdr;         // of the variants with the selected height, otherwise SDR is preferred
+        std::string audioGroup; // empty any
+    };
+
+public:
+    VariantIndex()
+        : m_variants()
+    {}
+
+    explicit VariantIndex(const m3u::HLS& hls)
+        : m_variants()
+    {
+        assign(hls);
+    }
+
+    virtual ~VariantIndex() {}
+
+    void assign(const m3u::HLS& hls);
+
+    // sorted by height, bandwidth and stream index
+    const std::vector<m3u::VariantIndex::Variant>& variants() const { return m_variants; }
+
+    // Index in variants() of the variant with the highest resolution and then the highest bandwidth which satisfies the policy, -1 if
+    // there is none.
+    int select(const m3u::VariantIndex::Policy& policy) const;
+
+    // index of the variant with the lowest resolution and bandwidth, -1 if there are no variants
+    int lowest() const { return (m_variants.empty() ? -1 : 0); }
+
+    // Parses a comma separated list of codec families (avc, h264, hevc, h265, dv, av1, vp9) or CODECS identifiers (avc1.640028, hvc1,
+    // ...), returns false if an element is unknown.
+    static bool parseCodecs(const std::string& list, uint32_t& codecs);
+
+private:
+    std::vector<m3u::VariantIndex::Variant> m_variants;
+};
+
+} // namespace m3u
+
+
+#endif // IG_MIDDLEWARE_M3UVARIANT_H
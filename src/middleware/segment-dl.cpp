@@ -0,0 +1,311 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "download-journal.h"
+#include "file-merge.h"
+#include "hash.h"
+#include "segment-dl.h"
+#include "worker-pool.h"
+
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// identifies the request list in the journal
+std::string jobId(const std::vector<util::HttpRequest>& requests)
+{
+    uint64_t h = util::fnv1a64(nullptr, 0);
+
+    for (const auto& request : requests)
+    {
+        const std::string key = request.key() + '\n';
+        h = util::fnv1a64(key.data(), key.size(), h);
+    }
+
+    return util::toHexStr(h);
+}
+
+} // namespace
+
+
+
+util::SegmentDownloader::SegmentDownloader(util::Curl& curl, size_t workers, size_t window)
+    : m_curl(curl), m_workers(workers > 0 ? workers : 1), m_window(window), m_attempts(3), m_journalFile(), m_cache(nullptr), m_keyCache(curl)
+{
+    if (m_window < m_workers) m_window = m_workers;
+}
+
+util::SegmentDownloader::Result util::SegmentDownloader::run(const std::vector<util::HttpRequest>& requests, const std::vector<util::SegmentKey>& keys,
+                                                             const std::filesystem::path& outFile, bool append)
+{
+    std::unique_ptr<util::DownloadJournal> journal;
+    util::DownloadJournal::State resumeState;
+
+    if (!append && (m_journalFile.empty() || !fs::exists(m_journalFile)))
+    {
+        // an existing output file may be a hard link to a cached file, it's replaced and not overwritten
+        std::error_code ec;
+        fs::remove(outFile, ec);
+
+        const bool encrypted = std::any_of(keys.begin(), keys.end(), [](const util::SegmentKey& key) { return !key.isNone(); });
+
+        Result r;
+        if (m_cache && !encrypted && m_fromCache(requests, outFile, r)) return r;
+    }
+
+    if (!m_journalFile.empty() && !append)
+    {
+        journal = std::make_unique<util::DownloadJournal>(m_journalFile);
+        resumeState = journal->resume(::jobId(requests), outFile);
+    }
+
+    std::ofstream ofs;
+    ofs.exceptions(std::ios::badbit | std::ios::failbit | std::ios::eofbit);
+    ofs.open(outFile, std::ios::out | std::ios::binary | ((append || journal) ? std::ios::app : std::ios::trunc));
+
+    size_t idx = resumeState.segments;
+
+    const auto write = [&](const std::string& data) {
+        ofs.write(data.data(), (std::streamsize)data.size());
+
+        if (journal)
+        {
+            ofs.flush();
+            journal->addSegment(idx, data.data(), data.size());
+        }
+
+        ++idx;
+    };
+
+    std::string errorData;
+    Result r = m_run(requests, keys, resumeState.segments, resumeState.partialBytes, write, errorData);
+
+    r.resumed = resumeState.segments;
+    r.bytes += resumeState.bytes + resumeState.partialBytes;
+
+    // keep what has been received of the next segment, it's continued with a range request
+    if (journal && !errorData.empty())
+    {
+        ofs.write(errorData.data(), (std::streamsize)errorData.size());
+        ofs.flush();
+        journal->addPartial(r.written, errorData.data(), errorData.size());
+    }
+
+    ofs.close();
+
+    if (journal && r.good()) journal->remove();
+
+    return r;
+}
+
+util::SegmentDownloader::Result util::SegmentDownloader::run(const std::vector<util::HttpRequest>& requests, const std::vector<util::SegmentKey>& keys,
+                                                             const std::function<void(const std::string& data)>& sink)
+{
+    std::string errorData;
+    return m_run(requests, keys, 0, 0, sink, errorData);
+}
+
+util::SegmentDownloader::Result util::SegmentDownloader::m_run(const std::vector<util::HttpRequest>& requests, const std::vector<util::SegmentKey>& keys,
+                                                               size_t first, uint64_t partialBytes, const std::function<void(const std::string& data)>& sink,
+                                                               std::string& errorData)
+{
+    Result r;
+    r.segments = requests.size();
+    r.written = first;
+
+    if (!keys.empty() && (keys.size() != requests.size())) throw std::invalid_argument("SegmentDownloader: number of keys and requests differ");
+
+    const auto isEncrypted = [&keys](size_t idx) { return (!keys.empty() && !keys[idx].isNone()); };
+
+    std::map<size_t, std::string> done; // downloaded but not yet written segments
+    std::string error;
+    size_t errorIdx = 0;
+    std::mutex mtx;
+    std::condition_variable cv;
+
+    errorData.clear(); // partially downloaded segment `errorIdx`
+
+    util::WorkerPool pool(m_workers);
+
+    const auto download = [&](size_t idx) {
+        // segments before a failed one are still downloaded, they are kept in the output file
+        {
+            std::lock_guard<std::mutex> lg(mtx);
+            if (!error.empty() && (idx > errorIdx)) return;
+        }
+
+        util::HttpRequest request = requests[idx];
+
+        // continue a partially downloaded segment
+        if ((idx == first) && (partialBytes > 0) && !isEncrypted(idx))
+        {
+            request.setRange((request.hasRange() ? request.rangeBegin : 0) + (int64_t)partialBytes, request.rangeEnd);
+        }
+
+        // the continuation of a partial segment isn't cached
+        bool cached = false;
+        const util::HttpGetResponse res = ((m_cache && (request.rangeBegin == requests[idx].rangeBegin))
+                                               ? m_cache->fetch(m_curl, request, util::ContentCache::Validation::none, m_attempts, cached)
+                                               : m_curl.httpGETResume(request, m_attempts));
+
+        std::string data;
+        std::string decryptError;
+
+        // decrypted here, so that it overlaps the transfers of the other workers
+        if (res.good())
+        {
+            data = res.data();
+
+            if (isEncrypted(idx))
+            {
+                util::aes_block_t key;
+
+                if (m_keyCache.get(keys[idx].keyUri, key, decryptError) && !util::Aes128Decryptor::decrypt(data, key, keys[idx].iv))
+                {
+                    decryptError = "failed to decrypt";
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lg(mtx);
+
+            if (res.good() && decryptError.empty())
+            {
+                done.emplace(idx, std::move(data));
+                if (cached) ++r.cached;
+            }
+            else if (error.empty() || (idx < errorIdx))
+            {
+                error = "segment " + std::to_string(idx) + " \"" + requests[idx].key() + "\": ";
+                if (res.good()) error += decryptError;
+                else error += "curl " + std::to_string(res.curlCode()) + ", HTTP " + std::to_string(res.httpCode());
+
+                errorIdx = idx;
+
+                // an encrypted segment can't be continued, the journal holds plain text
+                if (!res.good() && !isEncrypted(idx) && ((res.httpCode() == 200) || (res.httpCode() == 206))) errorData = res.data();
+                else errorData.clear();
+            }
+        }
+
+        cv.notify_all();
+    };
+
+    size_t submitted = r.written;
+
+    try
+    {
+        while (r.written < requests.size())
+        {
+            bool failed;
+            {
+                std::lock_guard<std::mutex> lg(mtx);
+                failed = !error.empty();
+            }
+
+            while (!failed && (submitted < requests.size()) && (submitted < (r.written + m_window)))
+            {
+                const size_t idx = submitted;
+                pool.submit([&download, idx]() { download(idx); });
+                ++submitted;
+            }
+
+            std::string data;
+
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+
+                cv.wait(lock, [&]() { return ((done.count(r.written) != 0) || (!error.empty() && (r.written >= errorIdx))); });
+
+                if (done.count(r.written) == 0) break;
+
+                auto it = done.find(r.written);
+                data.swap(it->second);
+                done.erase(it);
+            }
+
+            sink(data);
+
+            r.bytes += data.size();
+            ++r.written;
+        }
+
+        pool.wait();
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lg(mtx);
+            if (error.empty()) error = "aborted";
+        }
+
+        pool.wait();
+        throw;
+    }
+
+    r.error = error;
+
+    if (error.empty() || (errorIdx != r.written)) errorData.clear();
+
+    return r;
+}
+
+bool util::SegmentDownloader::m_fromCache(const std::vector<util::HttpRequest>& requests, const std::filesystem::path& outFile,
+                                          util::SegmentDownloader::Result& result)
+{
+    const std::vector<fs::path> objects = m_cache->objectFiles(requests);
+    if (objects.empty() || (objects.size() != requests.size())) return false;
+
+    Result r;
+    r.segments = requests.size();
+
+    if (objects.size() == 1)
+    {
+        util::ContentCache::LinkMethod method;
+        std::string error;
+
+        if (!util::ContentCache::link(objects[0], outFile, method, error)) return false;
+
+        r.linked = util::ContentCache::toString(method);
+    }
+    else
+    {
+        std::vector<util::MergeSource> sources(objects.begin(), objects.end());
+
+        util::FileMerger merger(m_workers);
+        const auto res = merger.merge(sources, outFile);
+
+        // a cached file has been evicted meanwhile
+        if (!res.good()) return false;
+
+        r.linked = util::FileMerger::toString(res.method);
+    }
+
+    std::error_code ec;
+    r.written = r.segments;
+    r.cached = r.segments;
+    r.bytes = fs::file_size(outFile, ec);
+
+    result = r;
+
+    return true;
+}
@@ -0,0 +1,108 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_SEGMENTDL_H
+#define IG_MIDDLEWARE_SEGMENTDL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "middleware/content-cache.h"
+#include "middleware/curl-helper.h"
+#include "middleware/hls-crypto.h"
+
+
+namespace util {
+
+// Downloads the segments of a media playlist concurrently and writes them in order into one file. At most `window` segments are
+// downloaded ahead of the segment which is written next, which bounds the memory used by out of order segments. A request may be a byte
+// range of a resource (coalesced byte range segments or an init section).
+class SegmentDownloader
+{
+public:
+    class Result
+    {
+    public:
+        Result()
+            : segments(0), written(0), resumed(0), cached(0), bytes(0), linked(), error()
+        {}
+
+        virtual ~Result() {}
+
+        size_t segments;
+        size_t written;
+        size_t resumed; // segments found complete in the journal, included in `written`
+        size_t cached;  // segments served from the cache, included in `written`
+        uint64_t bytes;
+        std::string linked; // method used if the output file was created from cached files only, empty otherwise
+        std::string error;
+
+        bool good() const { return (written == segments) && error.empty(); }
+    };
+
+public:
+    SegmentDownloader() = delete;
+    SegmentDownloader(util::Curl& curl, size_t workers, size_t window);
+    virtual ~SegmentDownloader() {}
+
+    size_t workers() const { return m_workers; }
+    size_t window() const { return m_window; }
+
+    // number of attempts per segment
+    void setAttempts(size_t attempts) { m_attempts = (attempts > 0 ? attempts : 1); }
+
+    // Resumes an interrupted download of the same requests if the journal file exists, the journal is deleted when the download has
+    // completed. An empty path disables the journal (default), it's not used in append mode.
+    void setJournal(const std::filesystem::path& file) { m_journalFile = file; }
+
+    // The segments are looked up in and added to `cache` (nullptr disables it, default). If all segments of a file download are cached,
+    // the output file is linked to or merged from the cached files without reading them.
+    void setCache(util::ContentCache* cache) { m_cache = cache; }
+
+    // `append` adds the segments to the end of an existing file, used to follow a live stream
+    util::SegmentDownloader::Result run(const std::vector<util::HttpRequest>& requests, const std::filesystem::path& outFile, bool append = false)
+    {
+        return run(requests, std::vector<util::SegmentKey>(), outFile, append);
+    }
+
+    // `keys` is empty or has one element per request, the encrypted segments are decrypted by the download workers
+    util::SegmentDownloader::Result run(const std::vector<util::HttpRequest>& requests, const std::vector<util::SegmentKey>& keys,
+                                        const std::filesystem::path& outFile, bool append = false);
+
+    // Passes the segments in order to `sink` instead of writing them to a file, called by the thread which called run(). The journal is
+    // not used.
+    util::SegmentDownloader::Result run(const std::vector<util::HttpRequest>& requests, const std::vector<util::SegmentKey>& keys,
+                                        const std::function<void(const std::string& data)>& sink);
+
+    // the keys are kept for subsequent runs
+    const util::KeyCache& keyCache() const { return m_keyCache; }
+
+private:
+    util::Curl& m_curl;
+    size_t m_workers;
+    size_t m_window;
+    size_t m_attempts;
+    std::filesystem::path m_journalFile;
+    util::ContentCache* m_cache;
+    util::KeyCache m_keyCache;
+
+    // creates the output file from cached files, false if not all requests are cached
+    bool m_fromCache(const std::vector<util::HttpRequest>& requests, const std::filesystem::path& outFile, util::SegmentDownloader::Result& result);
+
+    // Downloads the requests starting at `first`, the first one is continued at `partialBytes`. The data received of a failed
+    // request is moved to `errorData` if it's the next to be written and it can be continued.
+    util::SegmentDownloader::Result m_run(const std::vector<util::HttpRequest>& requests, const std::vector<util::SegmentKey>& keys, size_t first,
+                                          uint64_t partialBytes, const std::function<void(const std::string& data)>& sink, std::string& errorData);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_SEGMENTDL_H
@@ -0,0 +1,170 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include "encoding-helper.h"
+#include "uri-probe.h"
+#include "util.h"
+#include "worker-pool.h"
+
+
+namespace fs = std::filesystem;
+
+namespace {
+
+int64_t parseInt(const std::string& str)
+{
+    if (str.empty()) return -1;
+
+    int64_t value = 0;
+
+    for (const char c : str)
+    {
+        if ((c < '0') || (c > '9')) return -1;
+        value = value * 10 + (c - '0');
+    }
+
+    return value;
+}
+
+// total length from "bytes 0-0/1234", -1 if unknown ("*")
+int64_t contentRangeLength(const std::string& contentRange)
+{
+    const size_t slash = contentRange.rfind('/');
+    if (slash == std::string::npos) return -1;
+
+    return ::parseInt(contentRange.substr(slash + 1));
+}
+
+// the server doesn't implement HEAD for this resource
+bool headUnsupported(const util::HttpGetResponse& res) { return ((res.curlCode() == 0) && ((res.httpCode() == 405) || (res.httpCode() == 501))); }
+
+} // namespace
+
+
+
+util::UriProbe::UriProbe(util::Curl& curl, size_t workers)
+    : m_curl(curl), m_workers(workers > 0 ? workers : 1), m_method(Method::head), m_timeoutConn(10), m_timeout(30)
+{}
+
+std::vector<util::UriProbe::Result> util::UriProbe::probe(const std::vector<std::string>& uris)
+{
+    std::vector<Result> r(uris.size());
+
+    // first occurrence of each URI
+    std::unordered_map<std::string, size_t> first;
+    std::vector<size_t> unique;
+
+    first.reserve(uris.size());
+
+    for (size_t i = 0; i < uris.size(); ++i)
+    {
+        if (first.emplace(uris[i], i).second) unique.push_back(i);
+    }
+
+    if ((m_workers == 1) || (unique.size() < 2))
+    {
+        for (const size_t idx : unique) r[idx] = m_probe(uris[idx]);
+    }
+    else
+    {
+        util::WorkerPool pool(std::min(m_workers, unique.size()));
+
+        // every task writes to its own element
+        for (const size_t idx : unique) pool.submit([this, &r, &uris, idx]() { r[idx] = m_probe(uris[idx]); });
+
+        pool.wait();
+    }
+
+    for (size_t i = 0; i < uris.size(); ++i)
+    {
+        const size_t idx = first.at(uris[i]);
+        if (idx != i) r[i] = r[idx];
+    }
+
+    return r;
+}
+
+const char* util::UriProbe::toString(util::UriProbe::Method method)
+{
+    const char* r;
+
+    switch (method)
+    {
+    case Method::head:
+        r = "HEAD";
+        break;
+
+    case Method::rangedGet:
+        r = "GET";
+        break;
+
+    default:
+        r = "file";
+        break;
+    }
+
+    return r;
+}
+
+util::UriProbe::Result util::UriProbe::m_probe(const std::string& uri)
+{
+    Result r;
+    r.uri = uri;
+
+    if (!util::Uri(uri).isUrl())
+    {
+        std::error_code ec;
+        const fs::path file = enc::path(uri);
+
+        r.method = Method::none;
+
+        if (fs::is_regular_file(file, ec)) r.size = (int64_t)fs::file_size(file, ec);
+        else if (!fs::exists(file, ec)) r.error = "file not found";
+
+        return r;
+    }
+
+    util::HttpRequest request(uri, m_timeoutConn, m_timeout);
+    util::HttpGetResponse res;
+
+    if (m_method != Method::rangedGet)
+    {
+        request.head = true;
+
+        r.method = Method::head;
+        res = m_curl.httpGET(request);
+    }
+
+    if ((m_method == Method::rangedGet) || ::headUnsupported(res))
+    {
+        request.head = false;
+        request.setRange(0, 0);
+
+        r.method = Method::rangedGet;
+        res = m_curl.httpGET(request);
+    }
+
+    r.curlCode = res.curlCode();
+    r.httpCode = res.httpCode();
+    r.latency = res.timing().ttfb;
+
+    // a server which ignored the range responded without Content-Range
+    const std::string contentRange = (r.method == Method::rangedGet ? res.header("Content-Range") : std::string());
+    r.size = (contentRange.empty() ? ::parseInt(res.header("Content-Length")) : ::contentRangeLength(contentRange));
+
+    if (!res.good()) r.error = "curl " + std::to_string(res.curlCode()) + ", HTTP " + std::to_string(res.httpCode());
+
+    return r;
+}
@@ -0,0 +1,88 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_URIPROBE_H
+#define IG_MIDDLEWARE_URIPROBE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "middleware/curl-helper.h"
+
+
+namespace util {
+
+// Checks if URIs are available without downloading them. URLs are requested with HEAD, or with a GET of the first byte if the server
+// doesn't support HEAD (or if it's configured so), local paths are checked in the file system. The requests are sent concurrently by a
+// pool of workers and pass the scheduler of the curl instance, so its connection limits apply.
+class UriProbe
+{
+public:
+    enum class Method
+    {
+        none, // local file
+        head,
+        rangedGet,
+    };
+
+    class Result
+    {
+    public:
+        Result()
+            : uri(), method(Method::none), curlCode(0), httpCode(0), latency(0), size(-1), error()
+        {}
+
+        virtual ~Result() {}
+
+        std::string uri;
+        util::UriProbe::Method method; // method of the final request
+        int curlCode;
+        int httpCode;   // 0 for local files
+        double latency; // [s] until the response header was received
+        int64_t size;   // [B] from Content-Length or Content-Range, -1 if unknown
+        std::string error;
+
+        bool good() const { return error.empty(); }
+    };
+
+public:
+    UriProbe() = delete;
+    UriProbe(util::Curl& curl, size_t workers);
+    virtual ~UriProbe() {}
+
+    // `rangedGet` skips the HEAD request
+    void setMethod(util::UriProbe::Method method) { m_method = method; }
+
+    void setTimeout(long timeoutConn, long timeout)
+    {
+        m_timeoutConn = timeoutConn;
+        m_timeout = timeout;
+    }
+
+    // The results are in the order of `uris`, a URI which occurs more than once is requested only once.
+    std::vector<util::UriProbe::Result> probe(const std::vector<std::string>& uris);
+
+    static const char* toString(util::UriProbe::Method method);
+
+private:
+    util::Curl& m_curl;
+    size_t m_workers;
+    util::UriProbe::Method m_method;
+    long m_timeoutConn;
+    long m_timeout;
+
+    util::UriProbe::Result m_probe(const std::string& uri);
+
+    UriProbe(const UriProbe& other) = delete;
+    UriProbe& operator=(const UriProbe&);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_URIPROBE_H
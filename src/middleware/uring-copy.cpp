@@ -0,0 +1,556 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "uring-copy.h"
+
+#include <omw/defs.h>
+
+#ifdef OMW_PLAT_LINUX
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif // OMW_PLAT_LINUX
+
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string errorStr(const fs::path& file, const std::string& what) { return "\"" + file.u8string() + "\": " + what; }
+
+#ifdef OMW_PLAT_LINUX
+
+constexpr size_t bufferSize = 256 * 1024;
+
+int sysSetup(unsigned entries, struct io_uring_params* params) { return (int)syscall(__NR_io_uring_setup, entries, params); }
+
+int sysEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0);
+}
+
+int sysRegister(int fd, unsigned opcode, const void* arg, unsigned nArgs) { return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nArgs); }
+
+enum class State
+{
+    idle,
+    openIn,
+    openOut,
+    read,
+    write,
+    closeOut,
+};
+
+// a file in flight, at most one operation per slot is submitted
+class Slot
+{
+public:
+    Slot()
+        : state(State::idle), index(0), inFile(), outFile(), inFd(-1), outFd(-1), mode(0), offset(0), length(0), written(0), result(), tStart()
+    {}
+
+    virtual ~Slot() { closeFiles(); }
+
+    State state;
+    size_t index; // of the file
+    fs::path inFile;
+    fs::path outFile;
+    int inFd;
+    int outFd;
+    mode_t mode;     // of the input file
+    uint64_t offset; // of the data in the buffer
+    size_t length;   // of the data in the buffer
+    size_t written;  // of the data in the buffer
+    util::FileCopier::Result result;
+    std::chrono::steady_clock::time_point tStart;
+
+    void closeFiles()
+    {
+        if (inFd >= 0) close(inFd);
+        if (outFd >= 0) close(outFd);
+
+        inFd = -1;
+        outFd = -1;
+    }
+
+private:
+    Slot(const Slot& other) = delete;
+    Slot& operator=(const Slot&);
+};
+
+#endif // OMW_PLAT_LINUX
+
+} // namespace
+
+
+
+#ifdef OMW_PLAT_LINUX
+
+// the mapped submission and completion queues
+class util::UringCopier::Ring
+{
+public:
+    explicit Ring(unsigned entries)
+        : fd(-1), m_sqRing(MAP_FAILED), m_cqRing(MAP_FAILED), m_sqes(MAP_FAILED), m_sqRingSize(0), m_cqRingSize(0), m_sqesSize(0), m_toSubmit(0)
+    {
+        struct io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+
+        fd = ::sysSetup(entries, &params);
+        if (fd < 0) throw std::runtime_error(std::string("io_uring_setup: ") + std::strerror(errno));
+
+        m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        m_sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+        // both rings are in one mapping since Linux 5.4
+        const bool singleMmap = ((params.features & IORING_FEAT_SINGLE_MMAP) != 0);
+        if (singleMmap && (m_cqRingSize > m_sqRingSize)) m_sqRingSize = m_cqRingSize;
+
+        m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (m_sqRing == MAP_FAILED) m_throw("mmap");
+
+        if (singleMmap) m_cqRing = m_sqRing;
+        else
+        {
+            m_cqRing = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (m_cqRing == MAP_FAILED) m_throw("mmap");
+        }
+
+        m_sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (m_sqes == MAP_FAILED) m_throw("mmap");
+
+        char* const sq = (char*)m_sqRing;
+        char* const cq = (char*)m_cqRing;
+
+        m_sqHead = (unsigned*)(sq + params.sq_off.head);
+        m_sqTail = (unsigned*)(sq + params.sq_off.tail);
+        m_sqMask = *(unsigned*)(sq + params.sq_off.ring_mask);
+        m_sqEntries = *(unsigned*)(sq + params.sq_off.ring_entries);
+        m_sqArray = (unsigned*)(sq + params.sq_off.array);
+
+        m_cqHead = (unsigned*)(cq + params.cq_off.head);
+        m_cqTail = (unsigned*)(cq + params.cq_off.tail);
+        m_cqMask = *(unsigned*)(cq + params.cq_off.ring_mask);
+        m_cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    }
+
+    virtual ~Ring() { m_unmap(); }
+
+    int fd;
+
+    // the next submission queue entry, cleared, nullptr if the queue is full
+    struct io_uring_sqe* sqe()
+    {
+        const unsigned tail = *m_sqTail;
+        const unsigned head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+
+        if ((tail - head) >= m_sqEntries) return nullptr;
+
+        struct io_uring_sqe* r = (struct io_uring_sqe*)m_sqes + (tail & m_sqMask);
+        std::memset(r, 0, sizeof(*r));
+
+        m_sqArray[tail & m_sqMask] = tail & m_sqMask;
+        __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+        ++m_toSubmit;
+
+        return r;
+    }
+
+    // submits the queued entries and waits for at least one completion
+    void submitAndWait()
+    {
+        while (true)
+        {
+            const int n = ::sysEnter(fd, m_toSubmit, 1, IORING_ENTER_GETEVENTS);
+
+            if (n >= 0)
+            {
+                m_toSubmit -= ((unsigned)n < m_toSubmit ? (unsigned)n : m_toSubmit);
+                return;
+            }
+
+            if ((errno != EINTR) && (errno != EAGAIN) && (errno != EBUSY)) throw std::runtime_error(std::string("io_uring_enter: ") + std::strerror(errno));
+        }
+    }
+
+    // pops a completion, false if there is none
+    bool cqe(uint64_t& userData, int& res)
+    {
+        const unsigned head = *m_cqHead;
+        if (head == __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE)) return false;
+
+        const struct io_uring_cqe& e = m_cqes[head & m_cqMask];
+        userData = e.user_data;
+        res = e.res;
+
+        __atomic_store_n(m_cqHead, head + 1, __ATOMIC_RELEASE);
+
+        return true;
+    }
+
+private:
+    void* m_sqRing;
+    void* m_cqRing;
+    void* m_sqes;
+    size_t m_sqRingSize;
+    size_t m_cqRingSize;
+    size_t m_sqesSize;
+    unsigned m_toSubmit;
+
+    unsigned* m_sqHead;
+    unsigned* m_sqTail;
+    unsigned m_sqMask;
+    unsigned m_sqEntries;
+    unsigned* m_sqArray;
+    unsigned* m_cqHead;
+    unsigned* m_cqTail;
+    unsigned m_cqMask;
+    struct io_uring_cqe* m_cqes;
+
+    void m_unmap()
+    {
+        if (m_sqes != MAP_FAILED) munmap(m_sqes, m_sqesSize);
+        if ((m_cqRing != MAP_FAILED) && (m_cqRing != m_sqRing)) munmap(m_cqRing, m_cqRingSize);
+        if (m_sqRing != MAP_FAILED) munmap(m_sqRing, m_sqRingSize);
+        if (fd >= 0) close(fd);
+
+        m_sqes = MAP_FAILED;
+        m_cqRing = MAP_FAILED;
+        m_sqRing = MAP_FAILED;
+        fd = -1;
+    }
+
+    [[noreturn]] void m_throw(const char* what)
+    {
+        const std::string msg = std::string(what) + ": " + std::strerror(errno);
+        m_unmap();
+        throw std::runtime_error(msg);
+    }
+
+    Ring(const Ring& other) = delete;
+    Ring& operator=(const Ring&);
+};
+
+util::UringCopier::UringCopier(size_t depth)
+    : m_depth(depth > 0 ? depth : 1), m_fixedBuffers(false), m_buffers(), m_ring()
+{
+    if (!available()) throw std::runtime_error("io_uring is not available");
+
+    m_ring = std::make_unique<Ring>((unsigned)m_depth);
+    m_buffers.resize(m_depth * ::bufferSize);
+
+    std::vector<struct iovec> iov(m_depth);
+
+    for (size_t i = 0; i < m_depth; ++i)
+    {
+        iov[i].iov_base = m_buffers.data() + i * ::bufferSize;
+        iov[i].iov_len = ::bufferSize;
+    }
+
+    // the pages are pinned, which is limited by RLIMIT_MEMLOCK on kernels older than 5.12
+    m_fixedBuffers = (::sysRegister(m_ring->fd, IORING_REGISTER_BUFFERS, iov.data(), (unsigned)iov.size()) == 0);
+}
+
+util::UringCopier::~UringCopier() {}
+
+void util::UringCopier::copy(const std::vector<util::UringCopier::File>& files, const util::UringCopier::callback_type& callback)
+{
+    std::vector<::Slot> slots(m_depth);
+    size_t next = 0;
+    size_t active = 0;
+    std::exception_ptr exception; // of the callback, the files in flight are completed before it's rethrown
+
+    const auto submit = [this](size_t slotIdx) {
+        struct io_uring_sqe* sqe = m_ring->sqe();
+
+        // every slot has at most one operation in flight and the queue has at least one entry per slot
+        if (!sqe) throw std::runtime_error("io_uring submission queue is full");
+
+        sqe->user_data = slotIdx;
+
+        return sqe;
+    };
+
+    const auto submitOpen = [&submit](size_t slotIdx, const fs::path& file, int flags, mode_t mode) {
+        struct io_uring_sqe* sqe = submit(slotIdx);
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t)(uintptr_t)file.c_str();
+        sqe->len = mode;
+        sqe->open_flags = (uint32_t)flags;
+    };
+
+    const auto submitRead = [this, &submit, &slots](size_t slotIdx) {
+        ::Slot& slot = slots[slotIdx];
+        struct io_uring_sqe* sqe = submit(slotIdx);
+        sqe->opcode = (m_fixedBuffers ? IORING_OP_READ_FIXED : IORING_OP_READ);
+        sqe->fd = slot.inFd;
+        sqe->addr = (uint64_t)(uintptr_t)(m_buffers.data() + slotIdx * ::bufferSize);
+        sqe->len = (uint32_t)::bufferSize;
+        sqe->off = slot.offset;
+        sqe->buf_index = (uint16_t)slotIdx;
+    };
+
+    const auto submitWrite = [this, &submit, &slots](size_t slotIdx) {
+        ::Slot& slot = slots[slotIdx];
+        struct io_uring_sqe* sqe = submit(slotIdx);
+        sqe->opcode = (m_fixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE);
+        sqe->fd = slot.outFd;
+        sqe->addr = (uint64_t)(uintptr_t)(m_buffers.data() + slotIdx * ::bufferSize + slot.written);
+        sqe->len = (uint32_t)(slot.length - slot.written);
+        sqe->off = slot.offset + slot.written;
+        sqe->buf_index = (uint16_t)slotIdx;
+    };
+
+    // takes the next file, false if there is none
+    const auto start = [&](size_t slotIdx) {
+        if (next >= files.size()) return false;
+
+        ::Slot& slot = slots[slotIdx];
+        slot.state = ::State::openIn;
+        slot.index = next;
+        slot.inFile = files[next].inFile;
+        slot.outFile = files[next].outFile;
+        slot.offset = 0;
+        slot.length = 0;
+        slot.written = 0;
+        slot.result = util::FileCopier::Result();
+        slot.result.method = util::FileCopier::Method::ioUring;
+        slot.tStart = std::chrono::steady_clock::now();
+
+        ++next;
+        ++active;
+
+        submitOpen(slotIdx, slot.inFile, O_RDONLY | O_CLOEXEC, 0);
+
+        return true;
+    };
+
+    const auto finish = [&](size_t slotIdx) {
+        ::Slot& slot = slots[slotIdx];
+
+        slot.state = ::State::idle;
+        slot.result.duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - slot.tStart).count();
+        --active;
+
+        const size_t index = slot.index;
+        const util::FileCopier::Result result = slot.result;
+
+        start(slotIdx);
+
+        if (exception) return;
+
+        try
+        {
+            callback(index, result);
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+            next = files.size();
+        }
+    };
+
+    // the output file was created by this copy, it's removed
+    const auto fail = [&](size_t slotIdx, const fs::path& file, const std::string& what) {
+        ::Slot& slot = slots[slotIdx];
+
+        slot.result.error = ::errorStr(file, what);
+
+        const bool created = (slot.outFd >= 0) || (slot.state == ::State::closeOut);
+        slot.closeFiles();
+        if (created) unlink(slot.outFile.c_str());
+
+        finish(slotIdx);
+    };
+
+    const auto handle = [&](size_t slotIdx, int res) {
+        ::Slot& slot = slots[slotIdx];
+
+        // interrupted or out of resources, the operation is repeated
+        const bool retry = ((res == -EINTR) || (res == -EAGAIN));
+
+        switch (slot.state)
+        {
+        case ::State::openIn:
+            if (retry) submitOpen(slotIdx, slot.inFile, O_RDONLY | O_CLOEXEC, 0);
+            else if (res < 0) fail(slotIdx, slot.inFile, std::strerror(-res));
+            else
+            {
+                slot.inFd = res;
+
+                struct stat st;
+
+                if (fstat(slot.inFd, &st) != 0) fail(slotIdx, slot.inFile, std::strerror(errno));
+                else if (!S_ISREG(st.st_mode)) fail(slotIdx, slot.inFile, "not a regular file");
+                else
+                {
+                    slot.mode = st.st_mode & 07777;
+                    slot.state = ::State::openOut;
+                    submitOpen(slotIdx, slot.outFile, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, S_IWUSR);
+                }
+            }
+            break;
+
+        case ::State::openOut:
+            if (retry) submitOpen(slotIdx, slot.outFile, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, S_IWUSR);
+            else if (res < 0) fail(slotIdx, slot.outFile, std::strerror(-res));
+            else
+            {
+                slot.outFd = res;
+
+                if (fchmod(slot.outFd, slot.mode) != 0) fail(slotIdx, slot.outFile, std::strerror(errno));
+                else
+                {
+                    slot.state = ::State::read;
+                    submitRead(slotIdx);
+                }
+            }
+            break;
+
+        case ::State::read:
+            if (retry) submitRead(slotIdx);
+            else if (res < 0) fail(slotIdx, slot.inFile, std::strerror(-res));
+            else if (res == 0)
+            {
+                // end of file, errors of the output (e.g. of NFS) are reported by close
+                close(slot.inFd);
+                slot.inFd = -1;
+
+                struct io_uring_sqe* sqe = submit(slotIdx);
+                sqe->opcode = IORING_OP_CLOSE;
+                sqe->fd = slot.outFd;
+
+                slot.outFd = -1;
+                slot.state = ::State::closeOut;
+            }
+            else
+            {
+                slot.length = (size_t)res;
+                slot.written = 0;
+                slot.state = ::State::write;
+                submitWrite(slotIdx);
+            }
+            break;
+
+        case ::State::write:
+            if (retry) submitWrite(slotIdx);
+            else if (res <= 0) fail(slotIdx, slot.outFile, (res < 0 ? std::strerror(-res) : "write() wrote nothing"));
+            else
+            {
+                slot.written += (size_t)res;
+
+                // short write
+                if (slot.written < slot.length) submitWrite(slotIdx);
+                else
+                {
+                    slot.offset += slot.length;
+                    slot.result.bytes += slot.length;
+                    slot.state = ::State::read;
+                    submitRead(slotIdx);
+                }
+            }
+            break;
+
+        case ::State::closeOut:
+            if (res < 0) fail(slotIdx, slot.outFile, std::strerror(-res));
+            else finish(slotIdx);
+            break;
+
+        default:
+            break;
+        }
+    };
+
+    for (size_t i = 0; i < slots.size(); ++i)
+    {
+        if (!start(i)) break;
+    }
+
+    while (active > 0)
+    {
+        m_ring->submitAndWait();
+
+        uint64_t userData;
+        int res;
+
+        while (m_ring->cqe(userData, res)) handle((size_t)userData, res);
+    }
+
+    if (exception) std::rethrow_exception(exception);
+}
+
+bool util::UringCopier::available()
+{
+    static const bool r = []() {
+        try
+        {
+            Ring ring(4);
+
+            const unsigned nOps = IORING_OP_LAST;
+            std::vector<char> buffer(sizeof(struct io_uring_probe) + nOps * sizeof(struct io_uring_probe_op), 0);
+            struct io_uring_probe* probe = (struct io_uring_probe*)buffer.data();
+
+            // the probe was added with the operations used (Linux 5.6)
+            if (::sysRegister(ring.fd, IORING_REGISTER_PROBE, probe, nOps) != 0) return false;
+
+            for (const int op : { IORING_OP_OPENAT, IORING_OP_CLOSE, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED })
+            {
+                if ((op > probe->last_op) || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) return false;
+            }
+        }
+        catch (...)
+        {
+            return false;
+        }
+
+        return true;
+    }();
+
+    return r;
+}
+
+#else // OMW_PLAT_LINUX
+
+class util::UringCopier::Ring
+{};
+
+util::UringCopier::UringCopier(size_t depth)
+    : m_depth(depth), m_fixedBuffers(false), m_buffers(), m_ring()
+{
+    throw std::runtime_error("io_uring is not available");
+}
+
+util::UringCopier::~UringCopier() {}
+
+void util::UringCopier::copy(const std::vector<util::UringCopier::File>& files, const util::UringCopier::callback_type& callback)
+{
+    (void)files;
+    (void)callback;
+}
+
+bool util::UringCopier::available() { return false; }
+
+#endif // OMW_PLAT_LINUX
@@ -6,6 +6,7 @@ copyright       GPL-3.0 - Copyright (c) 2024 Oliver Blaser
 
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
@@ -19,6 +20,12 @@ copyright       GPL-3.0 - Copyright (c) 2024 Oliver Blaser
 #include <omw/omw.h>
 #include <omw/string.h>
 
+#ifdef OMW_PLAT_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif // OMW_PLAT_WIN
+
 
 using std::cout;
 using std::endl;
@@ -187,6 +194,64 @@ omw::string util::getDirName(const fs::path& dir)
     return r;
 }
 
+bool util::parseSize(const std::string& str, uint64_t& value)
+{
+    if (str.empty()) return false;
+
+    std::string digits = str;
+    uint64_t factor = 1;
+
+    switch (str.back())
+    {
+    case 'k':
+    case 'K':
+        factor = 1024;
+        break;
+
+    case 'M':
+        factor = 1024 * 1024;
+        break;
+
+    case 'G':
+        factor = 1024 * 1024 * 1024;
+        break;
+
+    default:
+        break;
+    }
+
+    if (factor != 1) digits.pop_back();
+
+    if (!omw::isUInteger(digits) || (digits.length() > 15)) return false;
+
+    const uint64_t n = std::stoull(digits);
+    if (n > (UINT64_MAX / factor)) return false;
+
+    value = n * factor;
+
+    return true;
+}
+
+std::string util::jsonEscape(const std::string& str)
+{
+    std::string r;
+
+    for (const char& c : str)
+    {
+        if (c == '"') r += "\\\"";
+        else if (c == '\\') r += "\\\\";
+        else if ((unsigned char)c < 0x20)
+        {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", (unsigned)c);
+            r += buffer;
+        }
+        else r += c;
+    }
+
+    return r;
+}
+
 std::string util::readFile(const std::filesystem::path& file)
 {
     std::stringstream txt;
@@ -209,6 +274,15 @@ void util::writeFile(const fs::path& file, const std::string& text)
     ofs.close();
 }
 
+bool util::stderrIsTerminal()
+{
+#ifdef OMW_PLAT_WIN
+    return (_isatty(_fileno(stderr)) != 0);
+#else
+    return (isatty(STDERR_FILENO) != 0);
+#endif
+}
+
 
 
 int omw_::cli::choice(const std::string& q, int def, char first, char second)
@@ -147,8 +147,17 @@ std::string getDateTimeStr(time_t t = std::time(nullptr), const char* strftimeFo
 
 omw::string getDirName(const std::filesystem::path& dir);
 
+// parses an unsigned integer with an optional binary suffix (k, M, G), returns false on invalid input or if the value overflows
+bool parseSize(const std::string& str, uint64_t& value);
+
+// escapes quotes, backslashes and control characters for a JSON string
+std::string jsonEscape(const std::string& str);
+
 std::string readFile(const std::filesystem::path& file);
 void writeFile(const std::filesystem::path& file, const std::string& text);
+
+// stderr is a terminal, not redirected to a file or pipe
+bool stderrIsTerminal();
 } // namespace util
 
 
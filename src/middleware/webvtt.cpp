@@ -0,0 +1,360 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "webvtt.h"
+
+
+namespace {
+
+constexpr size_t recentCues = 64;
+
+constexpr int64_t mpegtsClock = 90000;        // [Hz]
+constexpr int64_t mpegtsRollover = 1LL << 33; // the PTS is a 33 bit value
+
+std::string_view trim(std::string_view str)
+{
+    while (!str.empty() && ((str.front() == ' ') || (str.front() == '\t'))) str.remove_prefix(1);
+    while (!str.empty() && ((str.back() == ' ') || (str.back() == '\t') || (str.back() == '\r'))) str.remove_suffix(1);
+    return str;
+}
+
+bool startsWith(std::string_view str, std::string_view prefix) { return (str.compare(0, prefix.length(), prefix) == 0); }
+
+// block keyword followed by the end of the line, a space or a tab
+bool isBlock(std::string_view line, std::string_view keyword)
+{
+    return startsWith(line, keyword) && ((line.length() == keyword.length()) || (line[keyword.length()] == ' ') || (line[keyword.length()] == '\t'));
+}
+
+bool parseInt(std::string_view str, int64_t& value)
+{
+    if (str.empty()) return false;
+    const auto res = std::from_chars(str.data(), str.data() + str.length(), value);
+    return ((res.ec == std::errc()) && (res.ptr == (str.data() + str.length())));
+}
+
+// [hh:]mm:ss.ttt
+bool parseTime(std::string_view str, int64_t& ms)
+{
+    const size_t dot = str.rfind('.');
+    if ((dot == std::string_view::npos) || ((str.length() - dot) != 4)) return false;
+
+    int64_t millis;
+    if (!::parseInt(str.substr(dot + 1), millis)) return false;
+
+    str = str.substr(0, dot);
+
+    int64_t fields[3] = { 0, 0, 0 };
+    size_t n = 0;
+
+    while (true)
+    {
+        if (n >= 3) return false;
+
+        const size_t colon = str.find(':');
+        if (!::parseInt(str.substr(0, colon), fields[n])) return false;
+        ++n;
+
+        if (colon == std::string_view::npos) break;
+        str = str.substr(colon + 1);
+    }
+
+    if (n < 2) return false;
+
+    const int64_t hours = (n == 3 ? fields[0] : 0);
+    const int64_t minutes = fields[n - 2];
+    const int64_t seconds = fields[n - 1];
+
+    if ((minutes > 59) || (seconds > 59)) return false;
+
+    ms = ((hours * 60 + minutes) * 60 + seconds) * 1000 + millis;
+
+    return true;
+}
+
+std::string srtTime(int64_t ms)
+{
+    if (ms < 0) ms = 0;
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%02lld:%02lld:%02lld,%03lld", (long long)(ms / 3600000), (long long)((ms / 60000) % 60),
+                  (long long)((ms / 1000) % 60), (long long)(ms % 1000));
+
+    return buffer;
+}
+
+// removes the WebVTT specific markup, keeps <b>, <i> and <u> without classes and decodes the character references
+std::string srtText(const std::string& vtt)
+{
+    std::string r;
+    r.reserve(vtt.length());
+
+    size_t i = 0;
+
+    while (i < vtt.length())
+    {
+        const char c = vtt[i];
+
+        if (c == '<')
+        {
+            const size_t end = vtt.find('>', i);
+            if (end == std::string::npos) break;
+
+            std::string_view tag(vtt.data() + i + 1, end - i - 1);
+            const bool closing = (!tag.empty() && (tag[0] == '/'));
+            if (closing) tag.remove_prefix(1);
+
+            const std::string_view name = tag.substr(0, tag.find_first_of(". \t"));
+
+            if ((name == "b") || (name == "i") || (name == "u"))
+            {
+                r += (closing ? "</" : "<");
+                r += name;
+                r += '>';
+            }
+
+            i = end + 1;
+        }
+        else if (c == '&')
+        {
+            static const char* const references[][2] = {
+                { "&amp;", "&" }, { "&lt;", "<" }, { "&gt;", ">" }, { "&nbsp;", "\xc2\xa0" }, { "&lrm;", "\xe2\x80\x8e" }, { "&rlm;", "\xe2\x80\x8f" },
+            };
+
+            const std::string_view rest(vtt.data() + i, vtt.length() - i);
+            bool found = false;
+
+            for (const auto& ref : references)
+            {
+                if (::startsWith(rest, ref[0]))
+                {
+                    r += ref[1];
+                    i += std::string_view(ref[0]).length();
+                    found = true;
+                    break;
+                }
+            }
+
+            if (!found)
+            {
+                r += c;
+                ++i;
+            }
+        }
+        else
+        {
+            r += c;
+            ++i;
+        }
+    }
+
+    return r;
+}
+
+} // namespace
+
+
+
+util::WebVttToSrt::WebVttToSrt(std::ostream& os)
+    : m_os(os),
+      m_state(State::begin),
+      m_line(),
+      m_cue(),
+      m_recent(),
+      m_hasBase(false),
+      m_baseMpegts(0),
+      m_baseLocal(0),
+      m_shift(0),
+      m_index(0),
+      m_dropped(0)
+{}
+
+void util::WebVttToSrt::write(const char* data, size_t size)
+{
+    const char* const end = data + size;
+
+    while (data < end)
+    {
+        const char* const lf = (const char*)std::memchr(data, '\n', (size_t)(end - data));
+
+        if (!lf)
+        {
+            m_line.append(data, (size_t)(end - data));
+            break;
+        }
+
+        if (m_line.empty()) m_processLine(std::string_view(data, (size_t)(lf - data)));
+        else
+        {
+            m_line.append(data, (size_t)(lf - data));
+            m_processLine(m_line);
+            m_line.clear();
+        }
+
+        data = lf + 1;
+    }
+}
+
+void util::WebVttToSrt::endSegment()
+{
+    if (!m_line.empty())
+    {
+        m_processLine(m_line);
+        m_line.clear();
+    }
+
+    // a blank line completes the last cue
+    m_processLine(std::string_view());
+
+    m_state = State::begin;
+    m_shift = 0;
+}
+
+void util::WebVttToSrt::m_processLine(std::string_view line)
+{
+    line = ::trim(line);
+
+    if (m_state == State::begin)
+    {
+        if (::startsWith(line, "\xef\xbb\xbf")) line.remove_prefix(3);
+
+        if (::isBlock(line, "WEBVTT"))
+        {
+            m_state = State::header;
+            return;
+        }
+
+        m_state = State::idle;
+    }
+
+    switch (m_state)
+    {
+    case State::header:
+        if (line.empty()) m_state = State::idle;
+        else if (::startsWith(line, "X-TIMESTAMP-MAP=")) m_parseTimestampMap(line.substr(16));
+        break;
+
+    case State::idle:
+        if (line.empty()) break;
+
+        if (::isBlock(line, "NOTE") || ::isBlock(line, "STYLE") || ::isBlock(line, "REGION")) m_state = State::skip;
+        else if (line.find("-->") != std::string_view::npos) m_state = (m_parseTiming(line) ? State::text : State::skip);
+        else m_state = State::timing; // cue identifier, not used in SRT
+        break;
+
+    case State::timing:
+        if (line.empty()) m_state = State::idle;
+        else m_state = (m_parseTiming(line) ? State::text : State::skip);
+        break;
+
+    case State::text:
+        if (line.empty())
+        {
+            m_writeCue();
+            m_state = State::idle;
+        }
+        else
+        {
+            if (!m_cue.text.empty()) m_cue.text += '\n';
+            m_cue.text.append(line.data(), line.length());
+        }
+        break;
+
+    case State::skip:
+        if (line.empty()) m_state = State::idle;
+        break;
+
+    default:
+        break;
+    }
+}
+
+bool util::WebVttToSrt::m_parseTiming(std::string_view line)
+{
+    const size_t arrow = line.find("-->");
+    if (arrow == std::string_view::npos) return false;
+
+    const std::string_view start = ::trim(line.substr(0, arrow));
+
+    // the cue settings follow the end time
+    std::string_view end = ::trim(line.substr(arrow + 3));
+    end = end.substr(0, end.find_first_of(" \t"));
+
+    if (!::parseTime(start, m_cue.start) || !::parseTime(end, m_cue.end)) return false;
+
+    m_cue.start += m_shift;
+    m_cue.end += m_shift;
+    m_cue.text.clear();
+
+    return true;
+}
+
+// X-TIMESTAMP-MAP=MPEGTS:<ticks>,LOCAL:<time>, maps the cue time LOCAL to the media time MPEGTS
+void util::WebVttToSrt::m_parseTimestampMap(std::string_view value)
+{
+    int64_t mpegts = 0;
+    int64_t local = 0;
+
+    while (!value.empty())
+    {
+        const size_t comma = value.find(',');
+        const std::string_view field = value.substr(0, comma);
+
+        if (::startsWith(field, "MPEGTS:")) ::parseInt(field.substr(7), mpegts);
+        else if (::startsWith(field, "LOCAL:")) ::parseTime(field.substr(6), local);
+
+        if (comma == std::string_view::npos) break;
+        value = value.substr(comma + 1);
+    }
+
+    if (!m_hasBase)
+    {
+        m_hasBase = true;
+        m_baseMpegts = mpegts;
+        m_baseLocal = local;
+    }
+
+    int64_t ticks = mpegts - m_baseMpegts;
+    if (ticks < -(::mpegtsRollover / 2)) ticks += ::mpegtsRollover;
+
+    m_shift = (ticks * 1000 / ::mpegtsClock) - (local - m_baseLocal);
+}
+
+void util::WebVttToSrt::m_writeCue()
+{
+    m_cue.text = ::srtText(m_cue.text);
+
+    bool drop = m_cue.text.empty();
+
+    for (const auto& cue : m_recent)
+    {
+        if (cue == m_cue) drop = true;
+    }
+
+    if (drop)
+    {
+        ++m_dropped;
+        return;
+    }
+
+    ++m_index;
+
+    m_os << m_index << '\n';
+    m_os << ::srtTime(m_cue.start) << " --> " << ::srtTime(m_cue.end) << '\n';
+    m_os << m_cue.text << "\n\n";
+
+    m_recent.push_back(m_cue);
+    if (m_recent.size() > ::recentCues) m_recent.pop_front();
+}
@@ -0,0 +1,96 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_WEBVTT_H
+#define IG_MIDDLEWARE_WEBVTT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+
+namespace util {
+
+// Converts WebVTT to SubRip (SRT) while the data arrives, the data can be passed in chunks of any size. The segments of a HLS subtitle
+// playlist are complete WebVTT files, endSegment() is called after each of them.
+//
+// The cue times of a segment are shifted by its X-TIMESTAMP-MAP relative to the one of the first segment. Cues which are repeated by
+// consecutive segments (cues spanning a segment boundary) are written once. Cue settings, NOTE, STYLE and REGION blocks are dropped, of
+// the cue text tags only <b>, <i> and <u> are kept.
+class WebVttToSrt
+{
+public:
+    WebVttToSrt() = delete;
+    explicit WebVttToSrt(std::ostream& os);
+    virtual ~WebVttToSrt() {}
+
+    void write(const char* data, size_t size);
+    void write(const std::string& data) { write(data.data(), data.size()); }
+
+    // ends the current WebVTT file, the next data starts with a new header
+    void endSegment();
+
+    // number of cues written
+    size_t cues() const { return m_index; }
+
+    // number of cues dropped because they were a repetition or had no text
+    size_t dropped() const { return m_dropped; }
+
+private:
+    enum class State
+    {
+        begin,  // start of a WebVTT file
+        header, // WEBVTT line up to the first blank line
+        idle,   // between blocks
+        timing, // cue identifier read, the timing line follows
+        text,   // cue text
+        skip,   // ignored block
+    };
+
+    class Cue
+    {
+    public:
+        Cue()
+            : start(0), end(0), text()
+        {}
+
+        virtual ~Cue() {}
+
+        int64_t start; // [ms]
+        int64_t end;   // [ms]
+        std::string text;
+
+        bool operator==(const Cue& other) const { return ((start == other.start) && (end == other.end) && (text == other.text)); }
+    };
+
+    std::ostream& m_os;
+    State m_state;
+    std::string m_line; // incomplete line of the previous chunk
+    Cue m_cue;
+    std::deque<util::WebVttToSrt::Cue> m_recent;
+    bool m_hasBase;
+    int64_t m_baseMpegts; // X-TIMESTAMP-MAP of the first segment
+    int64_t m_baseLocal;  // [ms]
+    int64_t m_shift;      // [ms] added to the cue times of the current segment
+    size_t m_index;
+    size_t m_dropped;
+
+    void m_processLine(std::string_view line);
+    bool m_parseTiming(std::string_view line);
+    void m_parseTimestampMap(std::string_view value);
+    void m_writeCue();
+
+    WebVttToSrt(const WebVttToSrt& other) = delete;
+    WebVttToSrt& operator=(const WebVttToSrt&);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_WEBVTT_H
@@ -0,0 +1,99 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "worker-pool.h"
+
+
+
+util::WorkerPool::WorkerPool(size_t nThreads)
+    : m_threads(), m_queue(), m_busy(0), m_stop(false), m_exception(), m_mtx(), m_cvTask(), m_cvIdle()
+{
+    if (nThreads < 1) nThreads = 1;
+
+    for (size_t i = 0; i < nThreads; ++i) m_threads.push_back(std::thread(&util::WorkerPool::m_run, this));
+}
+
+util::WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lg(m_mtx);
+        m_stop = true;
+    }
+
+    m_cvTask.notify_all();
+
+    for (auto& t : m_threads) t.join();
+}
+
+void util::WorkerPool::submit(const task_type& task)
+{
+    {
+        std::lock_guard<std::mutex> lg(m_mtx);
+        m_queue.push_back(task);
+    }
+
+    m_cvTask.notify_one();
+}
+
+void util::WorkerPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mtx);
+
+    m_cvIdle.wait(lock, [this]() { return (m_queue.empty() && (m_busy == 0)); });
+
+    if (m_exception)
+    {
+        std::exception_ptr ex = m_exception;
+        m_exception = nullptr;
+        std::rethrow_exception(ex);
+    }
+}
+
+void util::WorkerPool::m_run()
+{
+    while (true)
+    {
+        task_type task;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mtx);
+
+            m_cvTask.wait(lock, [this]() { return (m_stop || !m_queue.empty()); });
+
+            // remaining tasks are still processed on stop
+            if (m_queue.empty()) break;
+
+            task = std::move(m_queue.front());
+            m_queue.pop_front();
+            ++m_busy;
+        }
+
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lg(m_mtx);
+            if (!m_exception) m_exception = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lg(m_mtx);
+            --m_busy;
+        }
+
+        m_cvIdle.notify_all();
+    }
+}
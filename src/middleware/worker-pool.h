@@ -0,0 +1,59 @@
+/*
+author          Oliver Blaser
+date            18.10.2026
+copyright       GPL-3.0 - Copyright (c) 2026 Oliver Blaser
+*/
+
+#ifndef IG_MIDDLEWARE_WORKERPOOL_H
+#define IG_MIDDLEWARE_WORKERPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace util {
+
+class WorkerPool
+{
+public:
+    using task_type = std::function<void()>;
+
+public:
+    WorkerPool() = delete;
+    explicit WorkerPool(size_t nThreads);
+    virtual ~WorkerPool();
+
+    size_t size() const { return m_threads.size(); }
+
+    void submit(const task_type& task);
+
+    // blocks until all submitted tasks are done, rethrows the first exception thrown by a task
+    void wait();
+
+private:
+    std::vector<std::thread> m_threads;
+    std::deque<task_type> m_queue;
+    size_t m_busy;
+    bool m_stop;
+    std::exception_ptr m_exception;
+    std::mutex m_mtx;
+    std::condition_variable m_cvTask;
+    std::condition_variable m_cvIdle;
+
+    void m_run();
+
+    WorkerPool(const WorkerPool& other) = delete;
+    WorkerPool& operator=(const WorkerPool&);
+};
+
+} // namespace util
+
+
+#endif // IG_MIDDLEWARE_WORKERPOOL_H
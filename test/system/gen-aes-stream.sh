@@ -0,0 +1,82 @@
+#!/bin/bash
+
+# author        Oliver Blaser
+# date          18.10.2026
+# copyright     GNU GPLv3 - Copyright (c) 2026 Oliver Blaser
+
+# Generates an AES-128 encrypted HLS VOD stream with random segments. The key changes after half of the segments, the first key has an
+# explicit IV, the second one uses the media sequence number as IV. plain.ts is the expected result of the decryption.
+#
+# Usage:
+# ./gen-aes-stream.sh OUTDIR [COUNT]
+#
+# Test:
+# ./gen-aes-stream.sh out/aes
+# (cd out/aes && python3 -m http.server 8080) &
+# m3u-tool vstreamdl http://localhost:8080/master.m3u8 out/aes-dl aes --download -v
+# cmp out/aes-dl/aes.ts out/aes/plain.ts
+
+
+
+if [ "$1" == "" ]; then
+    echo "Usage: ./gen-aes-stream.sh OUTDIR [COUNT]"
+    exit 1
+fi
+
+outDir=$1
+count=${2:-20}
+mediaSequence=7
+half=$((count / 2))
+
+mkdir -p $outDir/v || exit 1
+
+key1=$(openssl rand -hex 16)
+key2=$(openssl rand -hex 16)
+iv1=$(openssl rand -hex 16)
+
+echo -n $key1 | xxd -r -p > $outDir/v/key1.bin
+echo -n $key2 | xxd -r -p > $outDir/v/key2.bin
+
+cat > $outDir/master.m3u8 << EOF
+#EXTM3U
+#EXT-X-STREAM-INF:BANDWIDTH=800000,RESOLUTION=1280x720
+v/index.m3u8
+EOF
+
+playlist=$outDir/v/index.m3u8
+
+echo "#EXTM3U" > $playlist
+echo "#EXT-X-VERSION:3" >> $playlist
+echo "#EXT-X-TARGETDURATION:4" >> $playlist
+echo "#EXT-X-MEDIA-SEQUENCE:$mediaSequence" >> $playlist
+echo "#EXT-X-PLAYLIST-TYPE:VOD" >> $playlist
+echo "#EXT-X-KEY:METHOD=AES-128,URI=\"key1.bin\",IV=0x$iv1" >> $playlist
+
+rm -f $outDir/plain.ts
+
+for ((i = 0; i < count; i++)); do
+    seq=$((mediaSequence + i))
+    segFile=$(printf "seg%03d" $i)
+
+    # sizes which are not a multiple of the block size
+    head -c $((5000 + (i * 1237) % 9000)) /dev/urandom > $outDir/v/$segFile.plain
+    cat $outDir/v/$segFile.plain >> $outDir/plain.ts
+
+    if [ $i -lt $half ]; then
+        openssl enc -aes-128-cbc -K $key1 -iv $iv1 -in $outDir/v/$segFile.plain -out $outDir/v/$segFile.ts || exit 1
+    else
+        if [ $i -eq $half ]; then echo "#EXT-X-KEY:METHOD=AES-128,URI=\"key2.bin\"" >> $playlist; fi
+
+        iv=$(printf "%032x" $seq)
+        openssl enc -aes-128-cbc -K $key2 -iv $iv -in $outDir/v/$segFile.plain -out $outDir/v/$segFile.ts || exit 1
+    fi
+
+    rm $outDir/v/$segFile.plain
+
+    echo "#EXTINF:4.000," >> $playlist
+    echo "$segFile.ts" >> $playlist
+done
+
+echo "#EXT-X-ENDLIST" >> $playlist
+
+echo "generated $count segments in $outDir"
@@ -0,0 +1,126 @@
+#!/bin/bash
+
+# author        Oliver Blaser
+# date          18.10.2026
+# copyright     GNU GPLv3 - Copyright (c) 2026 Oliver Blaser
+
+# Generates a HLS stream with two WebVTT subtitle renditions and the SRT files expected from their conversion. The "en" segments use cue
+# times relative to the segment and a X-TIMESTAMP-MAP per segment, the "de" segments use absolute cue times and repeat the cue which
+# spans the segment boundary.
+#
+# Usage:
+# ./gen-vtt-stream.sh OUTDIR [COUNT]
+#
+# Test:
+# ./gen-vtt-stream.sh out/vtt
+# (cd out/vtt && python3 -m http.server 8080) &
+# m3u-tool vstreamdl http://localhost:8080/master.m3u8 out/vtt-dl vtt --download -v
+# cmp out/vtt-dl/subs/vtt-en.srt out/vtt/expected-en.srt
+# cmp out/vtt-dl/subs/vtt-de.srt out/vtt/expected-de.srt
+
+
+
+if [ "$1" == "" ]; then
+    echo "Usage: ./gen-vtt-stream.sh OUTDIR [COUNT]"
+    exit 1
+fi
+
+outDir=$1
+count=${2:-10}
+segDuration=6
+
+mkdir -p $outDir/v $outDir/en $outDir/de || exit 1
+
+# hh:mm:ss.ttt and hh:mm:ss,ttt of milliseconds
+vttTime() { printf "%02d:%02d:%02d.%03d" $(($1 / 3600000)) $((($1 / 60000) % 60)) $((($1 / 1000) % 60)) $(($1 % 1000)); }
+srtTime() { printf "%02d:%02d:%02d,%03d" $(($1 / 3600000)) $((($1 / 60000) % 60)) $((($1 / 1000) % 60)) $(($1 % 1000)); }
+
+cat > $outDir/master.m3u8 << EOF
+#EXTM3U
+#EXT-X-MEDIA:TYPE=SUBTITLES,GROUP-ID="subs",NAME="English",LANGUAGE="en",DEFAULT=YES,AUTOSELECT=YES,URI="en/index.m3u8"
+#EXT-X-MEDIA:TYPE=SUBTITLES,GROUP-ID="subs",NAME="Deutsch",LANGUAGE="de",URI="de/index.m3u8"
+#EXT-X-STREAM-INF:BANDWIDTH=800000,RESOLUTION=1280x720,SUBTITLES="subs"
+v/index.m3u8
+EOF
+
+for playlist in $outDir/v/index.m3u8 $outDir/en/index.m3u8 $outDir/de/index.m3u8; do
+    echo "#EXTM3U" > $playlist
+    echo "#EXT-X-VERSION:3" >> $playlist
+    echo "#EXT-X-TARGETDURATION:$segDuration" >> $playlist
+    echo "#EXT-X-PLAYLIST-TYPE:VOD" >> $playlist
+done
+
+rm -f $outDir/expected-en.srt $outDir/expected-de.srt
+
+for ((i = 0; i < count; i++)); do
+    seg=$(printf "seg%03d" $i)
+    start=$((i * segDuration * 1000))
+    mpegts=$((900000 + i * segDuration * 90000))
+
+    head -c 1000 /dev/urandom > $outDir/v/$seg.ts
+
+    # en: relative cue times
+    {
+        echo "WEBVTT"
+        echo "X-TIMESTAMP-MAP=MPEGTS:$mpegts,LOCAL:00:00:00.000"
+        echo ""
+        echo "NOTE segment $i"
+        echo ""
+        echo "$(vttTime 1000) --> $(vttTime 3500) align:center line:90%"
+        echo "<v Narrator>Line $i</v>"
+        echo "<i>second</i> line &amp; more"
+    } > $outDir/en/$seg.vtt
+
+    {
+        echo "$((i + 1))"
+        echo "$(srtTime $((start + 1000))) --> $(srtTime $((start + 3500)))"
+        echo "Line $i"
+        echo "<i>second</i> line & more"
+        echo ""
+    } >> $outDir/expected-en.srt
+
+    # de: absolute cue times, the cue at the end continues in the next segment
+    {
+        echo "WEBVTT"
+        echo "X-TIMESTAMP-MAP=MPEGTS:900000,LOCAL:00:00:00.000"
+        echo ""
+        if [ $i -gt 0 ]; then
+            echo "cue-$((i - 1))-b"
+            echo "$(vttTime $((start - 1000))) --> $(vttTime $((start + 1000)))"
+            echo "<c.yellow>Zeile $((i - 1)) b</c>"
+            echo ""
+        fi
+        echo "cue-$i-a"
+        echo "$(vttTime $((start + 1500))) --> $(vttTime $((start + 4000)))"
+        echo "Zeile $i a &lt;3"
+        echo ""
+        echo "cue-$i-b"
+        echo "$(vttTime $((start + 5000))) --> $(vttTime $((start + 7000)))"
+        echo "<c.yellow>Zeile $i b</c>"
+    } > $outDir/de/$seg.vtt
+
+    {
+        echo "$((2 * i + 1))"
+        echo "$(srtTime $((start + 1500))) --> $(srtTime $((start + 4000)))"
+        echo "Zeile $i a <3"
+        echo ""
+        echo "$((2 * i + 2))"
+        echo "$(srtTime $((start + 5000))) --> $(srtTime $((start + 7000)))"
+        echo "Zeile $i b"
+        echo ""
+    } >> $outDir/expected-de.srt
+
+    for lang in v en de; do
+        echo "#EXTINF:$segDuration.000," >> $outDir/$lang/index.m3u8
+    done
+
+    echo "$seg.ts" >> $outDir/v/index.m3u8
+    echo "$seg.vtt" >> $outDir/en/index.m3u8
+    echo "$seg.vtt" >> $outDir/de/index.m3u8
+done
+
+for playlist in $outDir/v/index.m3u8 $outDir/en/index.m3u8 $outDir/de/index.m3u8; do
+    echo "#EXT-X-ENDLIST" >> $playlist
+done
+
+echo "generated $count segments in $outDir"
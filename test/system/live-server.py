@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+
+# author        Oliver Blaser
+# date          18.10.2026
+# copyright     GNU GPLv3 - Copyright (c) 2026 Oliver Blaser
+
+# Stand-in for a live HLS server, appends a segment to the video and audio playlist every target duration and ends the stream (EXT-X-ENDLIST)
+# after COUNT segments. Blocking playlist reload (_HLS_msn) and playlist delta updates (_HLS_skip) are supported.
+#
+# Usage:
+# ./live-server.py [--port=PORT] [--count=COUNT] [--duration=SEC] [--window=N] [--no-block] [--no-skip] [--no-audio]
+# ./live-server.py --expect=DIR [--count=COUNT]
+#
+#   --expect writes the expected merged segments (video.ts, audio.ts) to DIR and exits.
+#
+# Test:
+# ./live-server.py &
+# m3u-tool vstreamdl http://localhost:8080/master.m3u8 out live --download --live -v
+# ./live-server.py --expect=out/expect && cmp out/live.ts out/expect/video.ts && cmp out/live.audio-en.ts out/expect/audio.ts
+
+import http.server
+import os
+import sys
+import threading
+import time
+import urllib.parse
+
+port = 8080
+count = 30
+duration = 1.0
+window = 10
+block = True
+skip = True
+audio = True
+expectDir = None
+
+for arg in sys.argv[1:]:
+    if arg.startswith('--port='): port = int(arg[7:])
+    elif arg.startswith('--count='): count = int(arg[8:])
+    elif arg.startswith('--duration='): duration = float(arg[11:])
+    elif arg.startswith('--window='): window = int(arg[9:])
+    elif arg == '--no-block': block = False
+    elif arg == '--no-skip': skip = False
+    elif arg == '--no-audio': audio = False
+    elif arg.startswith('--expect='): expectDir = arg[9:]
+    else:
+        print('unknown argument: ' + arg, file=sys.stderr)
+        sys.exit(1)
+
+tracks = ['video', 'audio'] if audio else ['video']
+startTime = time.monotonic()
+canSkipUntil = duration * window / 2
+
+
+
+def segmentData(track, seq):
+    line = '{} segment {}\n'.format(track, seq).encode()
+    return line * (100 + (seq * 37) % 400)
+
+# number of segments which are available now
+def available():
+    return min(count, int((time.monotonic() - startTime) / duration) + 1)
+
+def playlist(track, skipRequested):
+    n = available()
+    first = max(0, n - window)
+
+    txt = '#EXTM3U\n'
+    txt += '#EXT-X-VERSION:9\n'
+    txt += '#EXT-X-TARGETDURATION:{}\n'.format(int(duration + 0.999))
+    txt += '#EXT-X-MEDIA-SEQUENCE:{}\n'.format(first)
+
+    sc = []
+    if block: sc.append('CAN-BLOCK-RELOAD=YES')
+    if skip: sc.append('CAN-SKIP-UNTIL={:.1f}'.format(canSkipUntil))
+    if sc: txt += '#EXT-X-SERVER-CONTROL:' + ','.join(sc) + '\n'
+
+    seq = first
+
+    if skip and skipRequested:
+        nSkip = max(0, (n - first) - int(canSkipUntil / duration))
+        if nSkip > 0:
+            txt += '#EXT-X-SKIP:SKIPPED-SEGMENTS={}\n'.format(nSkip)
+            seq += nSkip
+
+    while seq < n:
+        txt += '#EXTINF:{:.3f},\n'.format(duration)
+        txt += 'seg{}.ts\n'.format(seq)
+        seq += 1
+
+    if n >= count: txt += '#EXT-X-ENDLIST\n'
+
+    return txt
+
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    def log_message(self, format, *args):
+        pass
+
+    def send(self, code, data, contentType):
+        self.send_response(code)
+        self.send_header('Content-Type', contentType)
+        self.send_header('Content-Length', str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+
+    def do_GET(self):
+        url = urllib.parse.urlsplit(self.path)
+        query = urllib.parse.parse_qs(url.query)
+        parts = url.path.strip('/').split('/')
+
+        if parts == ['master.m3u8']:
+            txt = '#EXTM3U\n'
+            if audio:
+                txt += '#EXT-X-MEDIA:TYPE=AUDIO,GROUP-ID="aud",NAME="English",LANGUAGE="en",URI="audio/index.m3u8"\n'
+                txt += '#EXT-X-STREAM-INF:BANDWIDTH=800000,RESOLUTION=1280x720,AUDIO="aud"\n'
+            else: txt += '#EXT-X-STREAM-INF:BANDWIDTH=800000,RESOLUTION=1280x720\n'
+            txt += 'video/index.m3u8\n'
+            self.send(200, txt.encode(), 'application/vnd.apple.mpegurl')
+
+        elif (len(parts) == 2) and (parts[0] in tracks) and (parts[1] == 'index.m3u8'):
+            if block and ('_HLS_msn' in query):
+                msn = int(query['_HLS_msn'][0])
+                if msn > available() + 1:
+                    self.send(400, b'_HLS_msn too far in the future\n', 'text/plain')
+                    return
+                while (available() <= msn) and (available() < count): time.sleep(0.01)
+
+            txt = playlist(parts[0], query.get('_HLS_skip', [''])[0] == 'YES')
+            self.send(200, txt.encode(), 'application/vnd.apple.mpegurl')
+
+        elif (len(parts) == 2) and (parts[0] in tracks) and parts[1].startswith('seg') and parts[1].endswith('.ts'):
+            seq = int(parts[1][3:-3])
+            if seq < available(): self.send(200, segmentData(parts[0], seq), 'video/mp2t')
+            else: self.send(404, b'not found\n', 'text/plain')
+
+        else: self.send(404, b'not found\n', 'text/plain')
+
+
+
+if expectDir is not None:
+    os.makedirs(expectDir, exist_ok=True)
+    for track in tracks:
+        with open(os.path.join(expectDir, track + '.ts'), 'wb') as f:
+            for seq in range(count): f.write(segmentData(track, seq))
+    sys.exit(0)
+
+server = http.server.ThreadingHTTPServer(('', port), Handler)
+server.daemon_threads = True
+
+print('live stream on http://localhost:{}/master.m3u8, {} segments of {}s'.format(port, count, duration))
+threading.Thread(target=server.serve_forever, daemon=True).start()
+
+# keep serving a moment after the end of the stream
+while available() < count: time.sleep(0.1)
+time.sleep(duration * 10)
+server.shutdown()